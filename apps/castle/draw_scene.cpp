@@ -6,27 +6,38 @@
 
 #include <libs/xdg/xdg.hpp>
 
-#include <libs/wlwnd/animation_window.hpp>
 #include <libs/wlwnd/event_loop.hpp>
 #include <libs/wlwnd/gui_shell.hpp>
-#include <libs/wlwnd/vsync_frames.hpp>
+#include <libs/wlwnd/render_loop.hpp>
 
 #include <apps/castle/prepare_instance.hpp>
 
 static_assert(renderer<renderer_iface>);
 
-animation_function make_vk_animation_function() {
-  return [](wl_display& display, wl_surface& surf, vsync_frames& frames,
-            value_update_channel<size>& resize_channel) {
-    auto render = make_vk_renderer(display, surf, resize_channel.get_current());
-    render->draw({});
-    for (auto ts : frames) {
-      if (const auto sz = resize_channel.get_update()) {
-        render->resize(sz.value());
-      }
-
-      render->draw(ts);
-    }
+namespace {
+
+class vk_window_renderer final : public window_renderer {
+public:
+  vk_window_renderer(const render_target& target, co::pool_executor pool_exec)
+      : render_{make_vk_renderer(
+            target.display, target.surface, target.size, pool_exec, target.resources.get<castle_font>()
+        )} {}
+
+  void resize(size sz) override { render_->resize(sz); }
+  bool draw(frames_clock::time_point frame_time) override {
+    render_->draw(frame_time);
+    return true;
+  }
+
+private:
+  std::unique_ptr<renderer_iface> render_;
+};
+
+} // namespace
+
+animation_function make_vk_animation_function(co::pool_executor pool_exec) {
+  return [pool_exec](const render_target& target) {
+    return std::make_unique<vk_window_renderer>(target, pool_exec);
   };
 }
 
@@ -35,10 +46,10 @@ draw_scene(co::io_executor io_exec, co::pool_executor pool_exec, const char* wl_
   event_loop eloop{wl_display};
   wl::gui_shell shell{eloop};
 
-  animation_window wnd{
-      eloop.make_queue(), pool_exec, co_await shell.create_maximized_window(eloop, io_exec),
-      make_vk_animation_function()
-  };
+  render_loop renderer{eloop, pool_exec};
+  auto wnd = renderer.add_window(
+      co_await shell.create_maximized_window(eloop, io_exec), make_vk_animation_function(pool_exec)
+  );
 
   co_await eloop.dispatch_while(io_exec, [&] {
     if (auto ec = shell.check()) {
@@ -31,6 +31,8 @@ struct opts {
 
 namespace co {
 
+// Besides the io context and the render loop threads textures are decoded
+// on the pool while the render thread waits for them.
 unsigned min_threads = 3;
 
 asio::awaitable<int> main(io_executor io_exec, pool_executor pool_exec, std::span<char*> args) {
@@ -2,7 +2,9 @@
 
 #include <algorithm>
 #include <optional>
+#include <ranges>
 #include <span>
+#include <vector>
 
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_raii.hpp>
@@ -13,6 +15,10 @@
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 
+#include <libs/img/atlas.hpp>
+#include <libs/img/batch.hpp>
+#include <libs/img/convert.hpp>
+#include <libs/img/ktx2.hpp>
 #include <libs/img/load.hpp>
 #include <libs/img/text.hpp>
 #include <libs/memtricks/member.hpp>
@@ -163,34 +169,231 @@ constexpr vk::Format to_vk_fmt(img::pixel_fmt fmt) noexcept {
   std::unreachable();
 }
 
-vlk::allocated_resource<vk::Image> create_texture(
-    img::reader& reader, const vlk::vma_allocator& alloc, vk::Queue transfer_queue, vk::CommandBuffer cmd
+// Block compressors write UNORM formats while castle textures are authored in
+// sRGB. Data layout is the same for both so only the format is adjusted.
+constexpr vk::Format as_srgb(vk::Format fmt) noexcept {
+  switch (fmt) {
+  case vk::Format::eBc1RgbaUnormBlock:
+    return vk::Format::eBc1RgbaSrgbBlock;
+  case vk::Format::eBc3UnormBlock:
+    return vk::Format::eBc3SrgbBlock;
+  case vk::Format::eBc7UnormBlock:
+    return vk::Format::eBc7SrgbBlock;
+  case vk::Format::eEtc2R8G8B8A8UnormBlock:
+    return vk::Format::eEtc2R8G8B8A8SrgbBlock;
+  case vk::Format::eAstc4x4UnormBlock:
+    return vk::Format::eAstc4x4SrgbBlock;
+  default:
+    return fmt;
+  }
+}
+
+struct texture {
+  vlk::allocated_resource<vk::Image> image;
+  vk::Format format = vk::Format::eR8G8B8A8Srgb;
+  vk::ComponentMapping swizzle = {};
+};
+
+texture create_texture(
+    const img::mip_chain& mips, const vlk::vma_allocator& alloc, vk::Queue transfer_queue,
+    vk::CommandBuffer cmd
+) {
+  auto staging = alloc.allocate_staging_buffer(mips.bytes().size());
+  std::ranges::copy(mips.bytes(), staging.mapping().data());
+  staging.flush();
+
+  std::vector<vk::BufferImageCopy> levels;
+  levels.reserve(mips.levels());
+  for (uint32_t level = 0; level < mips.levels(); ++level) {
+    levels.push_back(vk::BufferImageCopy{}
+                         .setBufferOffset(mips.level_offset(level))
+                         .setImageExtent(vk::Extent3D{as_extent(mips.level_size(level)), 1})
+                         .setImageSubresource(vk::ImageSubresourceLayers{}
+                                                  .setMipLevel(level)
+                                                  .setLayerCount(1)
+                                                  .setAspectMask(vk::ImageAspectFlagBits::eColor)));
+  }
+
+  auto res =
+      alloc.allocate_image(to_vk_fmt(img::pixel_fmt::rgba), as_extent(mips.level_size(0)), mips.levels());
+  vlk::copy(transfer_queue, cmd, staging.resource(), res.resource(), levels);
+  return {.image = std::move(res), .format = to_vk_fmt(img::pixel_fmt::rgba)};
+}
+
+texture create_texture(
+    const img::ktx2::texture& tex, vk::Format fmt, const vlk::vma_allocator& alloc, vk::Queue transfer_queue,
+    vk::CommandBuffer cmd
 ) {
-  auto staging = alloc.allocate_staging_buffer(reader.pixels_size());
-  reader.read_pixels(staging.mapping());
+  // Buffer offsets of copy regions must be multiple of the texel block size
+  constexpr vk::DeviceSize level_alignment = 16;
+  const auto aligned = [](vk::DeviceSize offset) {
+    return (offset + level_alignment - 1) & ~(level_alignment - 1);
+  };
+
+  vk::DeviceSize staging_size = 0;
+  for (uint32_t level = 0; level < tex.levels(); ++level)
+    staging_size = aligned(staging_size) + tex.level(level).size();
+  auto staging = alloc.allocate_staging_buffer(staging_size);
+
+  std::vector<vk::BufferImageCopy> levels;
+  levels.reserve(tex.levels());
+  vk::DeviceSize offset = 0;
+  for (uint32_t level = 0; level < tex.levels(); ++level) {
+    offset = aligned(offset);
+    std::ranges::copy(tex.level(level), staging.mapping().data() + offset);
+    levels.push_back(vk::BufferImageCopy{}
+                         .setBufferOffset(offset)
+                         .setImageExtent(vk::Extent3D{as_extent(tex.level_size(level)), 1})
+                         .setImageSubresource(vk::ImageSubresourceLayers{}
+                                                  .setMipLevel(level)
+                                                  .setLayerCount(1)
+                                                  .setAspectMask(vk::ImageAspectFlagBits::eColor)));
+    offset += tex.level(level).size();
+  }
   staging.flush();
-  auto res = alloc.allocate_image(to_vk_fmt(reader.format()), as_extent(reader.size()));
-  vlk::copy(transfer_queue, cmd, staging.resource(), res.resource(), as_extent(reader.size()));
+
+  auto res = alloc.allocate_image(fmt, as_extent(tex.size()), tex.levels());
+  vlk::copy(transfer_queue, cmd, staging.resource(), res.resource(), levels);
+  return {.image = std::move(res), .format = fmt};
+}
+
+constexpr size_t upload_band_size = 256 * 1024;
+
+vlk::allocated_resource<vk::Image> create_image(
+    img::reader& reader, vk::Format fmt, const vlk::vma_allocator& alloc, vk::Queue transfer_queue,
+    vk::CommandBuffer cmd
+) {
+  auto res = alloc.allocate_image(fmt, as_extent(reader.size()));
+  if (reader.rows_left() == 0 || reader.row_size() == 0)
+    return res;
+
+  // Image is read by bands into two halves of the staging buffer so that the
+  // next band is decoded while the previous one is transferred to the GPU.
+  const size_t band_rows = std::clamp<size_t>(upload_band_size / reader.row_size(), 1, reader.rows_left());
+  const size_t band_size = band_rows * reader.row_size();
+  auto staging = alloc.allocate_staging_buffer(2 * band_size);
+
+  for (size_t half = 0; reader.rows_left() > 0; half = (half + 1) % 2) {
+    const uint32_t first_row = reader.rows_read();
+    const uint32_t rows = reader.read_rows(staging.mapping().subspan(half * band_size, band_size));
+    staging.flush();
+    transfer_queue.waitIdle();
+    vlk::submit_rows_copy(
+        transfer_queue, cmd, staging.resource(), half * band_size, res.resource(), as_extent(reader.size()),
+        first_row, rows
+    );
+  }
+  transfer_queue.waitIdle();
   return res;
 }
 
-vlk::allocated_resource<vk::Image> load_text_texture(
-    const vlk::vma_allocator& alloc, vk::Queue transfer_queue, vk::CommandBuffer cmd, std::string_view text
+// Text is rendered as a distance field so that it stays sharp at any scale.
+// Distance is the only thing stored in the single channel texture which is
+// sampled as white color with the distance in alpha and tinted in the shader.
+texture load_text_texture(
+    const vlk::vma_allocator& alloc, vk::Queue transfer_queue, vk::CommandBuffer cmd, img::font& font,
+    std::string_view text
 ) {
-  auto resources = sfx::archive::open_self();
-  auto& fd = resources.open("fonts/RuthlessSketch.ttf");
-  auto font = img::font::load(fd);
-  auto reader = font.text_image_reader(text);
-  return create_texture(reader, alloc, transfer_queue, cmd);
+  auto reader = font.text_image_reader(text, img::pixel_fmt::grayscale);
+  // Distance is linear data unlike sRGB encoded colors
+  constexpr vk::Format fmt = vk::Format::eR8Unorm;
+  using enum vk::ComponentSwizzle;
+  return {
+      .image = create_image(reader, fmt, alloc, transfer_queue, cmd),
+      .format = fmt,
+      .swizzle = {eOne, eOne, eOne, eR}
+  };
+}
+
+// Catapult parts share a single texture so that all of them are bound with
+// one descriptor.
+struct sprites_atlas {
+  texture tex;
+  std::vector<basic_rect<float>> uv_rects;
+};
+
+sprites_atlas load_sprites_atlas(
+    const vlk::gpu& gpu, vk::Queue transfer_queue, vk::CommandBuffer cmd, co::pool_executor pool_exec,
+    std::vector<std::future<img::any_image>> decoding
+) {
+  std::vector<img::any_image> sprites;
+  sprites.reserve(decoding.size());
+  for (auto& sprite : decoding)
+    sprites.push_back(sprite.get());
+
+  auto atlas = img::atlas::build(sprites);
+  img::generate_mips(pool_exec, atlas.texture());
+
+  sprites_atlas res{
+      .tex = create_texture(atlas.texture(), gpu.allocator(), transfer_queue, cmd), .uv_rects = {}
+  };
+  for (size_t idx = 0; idx < atlas.sprites_count(); ++idx)
+    res.uv_rects.push_back(atlas.uv_rect(idx));
+  return res;
 }
 
-vlk::allocated_resource<vk::Image> load_sfx_texture(
-    const vlk::vma_allocator& alloc, vk::Queue transfer_queue, vk::CommandBuffer cmd, const fs::path& sfx_path
+// Castle is taken from the block compressed KTX2 container if the build has
+// produced one and GPU can sample its format. Otherwise the image is decoded
+// from the QOI copy of the original PNG.
+struct texture_source {
+  co::pool_executor pool_exec;
+  fs::path image;
+  fs::path ktx2;
+  std::future<img::mip_chain> decoding;
+};
+
+texture load_sfx_texture(
+    const vlk::gpu& gpu, vk::Queue transfer_queue, vk::CommandBuffer cmd, sfx::archive& resources,
+    texture_source&& src
 ) {
+  if (!src.ktx2.empty()) {
+    const auto tex = img::ktx2::texture::parse(resources.map(src.ktx2));
+    const auto fmt = as_srgb(static_cast<vk::Format>(tex.vk_format()));
+    if (gpu.supports_sampling(fmt))
+      return create_texture(tex, fmt, gpu.allocator(), transfer_queue, cmd);
+
+    spdlog::warn("GPU can't sample {} textures, decoding {} instead", vk::to_string(fmt), src.image.string());
+    src.decoding = img::async_load_mips(src.pool_exec, resources.open_detached(src.image));
+  }
+  return create_texture(src.decoding.get(), gpu.allocator(), transfer_queue, cmd);
+}
+
+struct scene_textures {
+  co::pool_executor pool_exec;
+  // Opened once and mapped on the first KTX2 texture load
+  sfx::archive resources;
+  std::array<texture_source, 4> castle;
+  // Front wheel, rear wheel, platform and arm
+  std::vector<std::future<img::any_image>> catapult;
+};
+
+scene_textures start_textures_decoding(co::pool_executor pool_exec) {
   auto resources = sfx::archive::open_self();
-  auto& fd = resources.open(sfx_path);
-  auto reader = img::load_reader(fd);
-  return create_texture(reader, alloc, transfer_queue, cmd);
+  auto source = [&](fs::path image) -> texture_source {
+    auto ktx2 = fs::path{image}.replace_extension(".ktx2");
+    if (resources.entries().contains(ktx2))
+      return {.pool_exec = pool_exec, .image = std::move(image), .ktx2 = std::move(ktx2), .decoding = {}};
+    auto decoding = img::async_load_mips(pool_exec, resources.open_detached(image));
+    return {.pool_exec = pool_exec, .image = std::move(image), .ktx2 = {}, .decoding = std::move(decoding)};
+  };
+  const std::array<fs::path, 4> sprites{
+      "textures/catapult-front-wheel.qoi", "textures/catapult-rear-wheel.qoi",
+      "textures/catapult-platform.qoi", "textures/catapult-arm.qoi"
+  };
+
+  std::array<texture_source, 4> castle{
+      source("textures/castle-0hit.qoi"), source("textures/castle-1hit.qoi"),
+      source("textures/castle-2hit.qoi"), source("textures/castle-3hit.qoi")
+  };
+  auto catapult = img::async_load_all(pool_exec, sprites | std::views::transform([&](const fs::path& qoi) {
+                                                   return resources.open_detached(qoi);
+                                                 }));
+  return {
+      .pool_exec = pool_exec,
+      .resources = std::move(resources),
+      .castle = std::move(castle),
+      .catapult = std::move(catapult),
+  };
 }
 
 static vk::raii::Sampler make_sampler(const vk::raii::Device& dev, const vk::PhysicalDeviceLimits& limits) {
@@ -202,85 +405,76 @@ static vk::raii::Sampler make_sampler(const vk::raii::Device& dev, const vk::Phy
                                .setAddressModeV(vk::SamplerAddressMode::eClampToBorder)
                                .setAddressModeW(vk::SamplerAddressMode::eClampToBorder)
                                .setAnisotropyEnable(true)
-                               .setMaxAnisotropy(limits.maxSamplerAnisotropy));
+                               .setMaxAnisotropy(limits.maxSamplerAnisotropy)
+                               .setMaxLod(VK_LOD_CLAMP_NONE));
 }
 
-static vk::raii::ImageView make_view(const vk::raii::Device& dev, vk::Image img) {
+static vk::raii::ImageView make_view(const vk::raii::Device& dev, const texture& tex) {
   return dev.createImageView(vk::ImageViewCreateInfo{}
-                                 .setImage(img)
+                                 .setImage(tex.image.resource())
                                  .setViewType(vk::ImageViewType::e2D)
-                                 .setFormat(vk::Format::eR8G8B8A8Srgb)
+                                 .setFormat(tex.format)
+                                 .setComponents(tex.swizzle)
                                  .setSubresourceRange(vk::ImageSubresourceRange{}
                                                           .setAspectMask(vk::ImageAspectFlagBits::eColor)
-                                                          .setLevelCount(1)
+                                                          .setLevelCount(VK_REMAINING_MIP_LEVELS)
                                                           .setLayerCount(1)));
 }
 
-std::tuple<vlk::allocated_resource<vk::Image>, vk::raii::ImageView>
-make_image_view(const vk::raii::Device& dev, vlk::allocated_resource<vk::Image>&& img) {
-  auto view = make_view(dev, img.resource());
-  return std::tuple{std::move(img), std::move(view)};
-}
-
 struct uniform_objects {
   uniform_objects(
       const vk::raii::Device& dev, const vk::PhysicalDeviceLimits& limits,
-      std::array<vlk::allocated_resource<vk::Image>, 4> img, vlk::allocated_resource<vk::Image> fwheel,
-      vlk::allocated_resource<vk::Image> rwheel, vlk::allocated_resource<vk::Image> platform,
-      vlk::allocated_resource<vk::Image> arm, vlk::allocated_resource<vk::Image> word_img
+      std::array<texture, 4> img, sprites_atlas sprites, texture text
   )
       : sampler{make_sampler(dev, limits)}, castle_textures{std::move(img)},
-        castle_texture_view{make_view(dev, castle_textures[0].resource())},
-        catapult{
-            make_image_view(dev, std::move(fwheel)), make_image_view(dev, std::move(rwheel)),
-            make_image_view(dev, std::move(platform)), make_image_view(dev, std::move(arm))
-        },
-        word{std::move(word_img)}, word_view{make_view(dev, word.resource())} {}
+        castle_texture_view{make_view(dev, castle_textures[0])}, atlas{std::move(sprites)},
+        atlas_view{make_view(dev, atlas.tex)}, text{std::move(text)}, text_view{make_view(dev, this->text)} {}
 
   vlk::ubo::unique_ptr<scene::world_transformations> world;
   vlk::ubo::unique_ptr<scene::light_source> light;
   vlk::ubo::unique_ptr<scene::texture_transform> transformations;
 
   vk::raii::Sampler sampler;
-  std::array<vlk::allocated_resource<vk::Image>, 4> castle_textures;
+  std::array<texture, 4> castle_textures;
   vk::raii::ImageView castle_texture_view;
 
-  std::array<std::tuple<vlk::allocated_resource<vk::Image>, vk::raii::ImageView>, 4> catapult;
-  vlk::allocated_resource<vk::Image> word;
-  vk::raii::ImageView word_view;
+  sprites_atlas atlas;
+  vk::raii::ImageView atlas_view;
+
+  texture text;
+  vk::raii::ImageView text_view;
 
   void switch_castle_image(const vk::raii::Device& dev, size_t n) {
-    castle_texture_view = make_view(dev, castle_textures[n].resource());
+    castle_texture_view = make_view(dev, castle_textures[n]);
   }
 
   void bind(vlk::ubo_builder& bldr) {
-    std::array<vk::ImageView, 6> sprites{*castle_texture_view,      *std::get<1>(catapult[0]),
-                                         *std::get<1>(catapult[1]), *std::get<1>(catapult[2]),
-                                         *std::get<1>(catapult[3]), *word_view};
+    std::array<vk::ImageView, 3> sprites{*castle_texture_view, *atlas_view, *text_view};
 
     world = bldr.create<vlk::graphics_uniform<scene::world_transformations>>(0);
     light = bldr.create<vlk::fragment_uniform<scene::light_source>>(1);
     bldr.bind<vlk::fragment_uniform<vk::Sampler>>(2, *sampler);
     transformations = bldr.create<vlk::fragment_uniform<scene::texture_transform>>(3);
-    bldr.bind<vlk::fragment_uniform<vk::ImageView[6]>>(4, sprites);
+    bldr.bind<vlk::fragment_uniform<vk::ImageView[3]>>(4, sprites);
   }
 
   void rebind(vlk::ubo_builder& bldr) {
-    std::array<vk::ImageView, 6> sprites{*castle_texture_view,      *std::get<1>(catapult[0]),
-                                         *std::get<1>(catapult[1]), *std::get<1>(catapult[2]),
-                                         *std::get<1>(catapult[3]), *word_view};
+    std::array<vk::ImageView, 3> sprites{*castle_texture_view, *atlas_view, *text_view};
 
     bldr.bind<vlk::graphics_uniform<scene::world_transformations>>(0, *world);
     bldr.bind<vlk::fragment_uniform<scene::light_source>>(1, *light);
     bldr.bind<vlk::fragment_uniform<vk::Sampler>>(2, *sampler);
     bldr.bind<vlk::fragment_uniform<scene::texture_transform>>(3, *transformations);
-    bldr.bind<vlk::fragment_uniform<vk::ImageView[6]>>(4, sprites);
+    bldr.bind<vlk::fragment_uniform<vk::ImageView[3]>>(4, sprites);
   }
 };
 
 class render_environment : public renderer_iface {
 public:
-  render_environment(vlk::gpu gpu, vk::raii::SurfaceKHR surf, vk::SwapchainCreateInfoKHR swapchain_info)
+  render_environment(
+      vlk::gpu gpu, vk::raii::SurfaceKHR surf, vk::SwapchainCreateInfoKHR swapchain_info,
+      scene_textures textures, castle_font& font
+  )
       : gpu_{std::move(gpu)},
         uniform_pools_{
             gpu_.dev(), gpu_.memory_properties(), gpu_.limits(),
@@ -288,7 +482,7 @@ public:
                 .add_binding<
                     vlk::graphics_uniform<scene::world_transformations>,
                     vlk::fragment_uniform<scene::light_source>, vlk::fragment_uniform<vk::Sampler>,
-                    vlk::fragment_uniform<scene::texture_transform>, vlk::fragment_uniform<vk::ImageView[6]>>(
+                    vlk::fragment_uniform<scene::texture_transform>, vlk::fragment_uniform<vk::ImageView[3]>>(
                     1
                 )
                 .build(gpu_.dev(), 1),
@@ -310,35 +504,32 @@ public:
             gpu_.dev(),
             gpu_.limits(),
             {load_sfx_texture(
-                 gpu_.allocator(), cmd_buffs_.queue(), cmd_buffs_.front(), "textures/castle-0hit.png"
+                 gpu_, cmd_buffs_.queue(), cmd_buffs_.front(), textures.resources,
+                 std::move(textures.castle[0])
              ),
              load_sfx_texture(
-                 gpu_.allocator(), cmd_buffs_.queue(), cmd_buffs_.front(), "textures/castle-1hit.png"
+                 gpu_, cmd_buffs_.queue(), cmd_buffs_.front(), textures.resources,
+                 std::move(textures.castle[1])
              ),
              load_sfx_texture(
-                 gpu_.allocator(), cmd_buffs_.queue(), cmd_buffs_.front(), "textures/castle-2hit.png"
+                 gpu_, cmd_buffs_.queue(), cmd_buffs_.front(), textures.resources,
+                 std::move(textures.castle[2])
              ),
              load_sfx_texture(
-                 gpu_.allocator(), cmd_buffs_.queue(), cmd_buffs_.front(), "textures/castle-3hit.png"
+                 gpu_, cmd_buffs_.queue(), cmd_buffs_.front(), textures.resources,
+                 std::move(textures.castle[3])
              )},
-            load_sfx_texture(
-                gpu_.allocator(), cmd_buffs_.queue(), cmd_buffs_.front(), "textures/catapult-front-wheel.png"
+            load_sprites_atlas(
+                gpu_, cmd_buffs_.queue(), cmd_buffs_.front(), textures.pool_exec, std::move(textures.catapult)
             ),
-            load_sfx_texture(
-                gpu_.allocator(), cmd_buffs_.queue(), cmd_buffs_.front(), "textures/catapult-rear-wheel.png"
-            ),
-            load_sfx_texture(
-                gpu_.allocator(), cmd_buffs_.queue(), cmd_buffs_.front(), "textures/catapult-platform.png"
-            ),
-            load_sfx_texture(
-                gpu_.allocator(), cmd_buffs_.queue(), cmd_buffs_.front(), "textures/catapult-arm.png"
-            ),
-            load_text_texture(gpu_.allocator(), cmd_buffs_.queue(), cmd_buffs_.front(), "привет")
+            load_text_texture(
+                gpu_.allocator(), cmd_buffs_.queue(), cmd_buffs_.front(), font.font, "привет"
+            )
         },
         descriptor_bindings_{uniform_pools_.make_pipeline_bindings<
             uniform_objects, 1, vlk::graphics_uniform<scene::world_transformations>,
             vlk::fragment_uniform<scene::light_source>, vlk::fragment_uniform<vk::Sampler>,
-            vlk::fragment_uniform<scene::texture_transform>, vlk::fragment_uniform<vk::ImageView[6]>>(
+            vlk::fragment_uniform<scene::texture_transform>, vlk::fragment_uniform<vk::ImageView[3]>>(
             gpu_.dev(), gpu_.limits(), std::span<uniform_objects, 1>{&uniforms_, 1}
         )},
         pipelines_{
@@ -355,6 +546,17 @@ public:
     uniforms_.transformations->models[0] =
         glm::translate(glm::scale(glm::mat4{1.}, {1. / 6., 1. / 6., 1. / 6.}), {0, -12, 0});
     uniforms_.transformations->models[5] = glm::translate(glm::mat4{1.}, {-1, -2, 0});
+    uniforms_.transformations->uv_rects[0] = {0, 0, 1, 1};
+    for (size_t idx = 0; idx < uniforms_.atlas.uv_rects.size(); ++idx) {
+      const auto uv = uniforms_.atlas.uv_rects[idx];
+      uniforms_.transformations->uv_rects[idx + 1] = {uv.x, uv.y, uv.width, uv.height};
+    }
+    std::ranges::fill(uniforms_.transformations->tints, glm::vec4{1, 1, 1, 1});
+    // Text is the last sprite which has a texture of its own colored with the
+    // same gray it used to have in RGBA
+    uniforms_.transformations->uv_rects[5] = {0, 0, 1, 1};
+    uniforms_.transformations->tints[5] = {0.195, 0.195, 0.195, 1};
+    uniforms_.transformations->distance_field_sprites = 1u << 5;
     *uniforms_.light = {.pos = {2., 5., 15.}, .intense = 0.8, .ambient = 0.4, .attenuation = 0.01};
   }
 
@@ -478,7 +680,7 @@ private:
   vlk::pipeline_bindings<
       1, vlk::graphics_uniform<scene::world_transformations>, vlk::fragment_uniform<scene::light_source>,
       vlk::fragment_uniform<vk::Sampler>, vlk::fragment_uniform<scene::texture_transform>,
-      vlk::fragment_uniform<vk::ImageView[6]>>
+      vlk::fragment_uniform<vk::ImageView[3]>>
       descriptor_bindings_;
   vlk::pipelines_storage<1> pipelines_;
   mesh mesh_;
@@ -490,7 +692,17 @@ private:
 
 } // namespace
 
-std::unique_ptr<renderer_iface> make_vk_renderer(wl_display& display, wl_surface& surf, size sz) {
+castle_font::castle_font()
+    : resources{sfx::archive::open_self()},
+      font{img::font::load(
+          resources.map("fonts/RuthlessSketch.ttf"), img::glyph_rendering::distance_field
+      )} {}
+
+std::unique_ptr<renderer_iface> make_vk_renderer(
+    wl_display& display, wl_surface& surf, size sz, co::pool_executor pool_exec, castle_font& font
+) {
+  auto textures = start_textures_decoding(pool_exec);
+
   vk::raii::Instance inst = create_instance();
   vk::raii::SurfaceKHR vk_surf{
       inst, vk::WaylandSurfaceCreateInfoKHR{}.setDisplay(&display).setSurface(&surf)
@@ -500,5 +712,7 @@ std::unique_ptr<renderer_iface> make_vk_renderer(wl_display& display, wl_surface
   const auto swapchain_info =
       gpu.make_swapchain_info(*vk_surf, *gpu.find_compatible_format_for(*vk_surf), as_extent(sz));
 
-  return std::make_unique<render_environment>(std::move(gpu), std::move(vk_surf), swapchain_info);
+  return std::make_unique<render_environment>(
+      std::move(gpu), std::move(vk_surf), swapchain_info, std::move(textures), font
+  );
 }
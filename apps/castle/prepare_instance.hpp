@@ -3,7 +3,10 @@
 #include <memory>
 
 #include <libs/anime/clock.hpp>
+#include <libs/corort/executors.hpp>
 #include <libs/geom/geom.hpp>
+#include <libs/img/text.hpp>
+#include <libs/sfx/sfx.hpp>
 
 struct wl_display;
 struct wl_surface;
@@ -14,4 +17,15 @@ struct renderer_iface {
   virtual ~renderer_iface() noexcept = default;
 };
 
-std::unique_ptr<renderer_iface> make_vk_renderer(wl_display& display, wl_surface& surf, size sz);
+/// Font of the scene text along with the archive mapping it is loaded from.
+/// It is shared by renderers of all windows so the font file is parsed once.
+struct castle_font {
+  castle_font();
+
+  sfx::archive resources;
+  img::font font;
+};
+
+std::unique_ptr<renderer_iface> make_vk_renderer(
+    wl_display& display, wl_surface& surf, size sz, co::pool_executor pool_exec, castle_font& font
+);
@@ -5,6 +5,7 @@
 #include <glm/mat4x4.hpp>
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
 
 #include <libs/anime/clock.hpp>
 #include <libs/memtricks/member.hpp>
@@ -50,6 +51,12 @@ struct world_transformations {
 
 struct texture_transform {
   glm::mat4 models[6];
+  // Sprite area in its texture: origin in xy and size in zw
+  glm::vec4 uv_rects[6];
+  // Multiplied with the sampled sprite color
+  glm::vec4 tints[6];
+  // Bit mask of sprites storing distance to the outline in alpha
+  uint32_t distance_field_sprites;
 };
 
 struct light_source {
@@ -18,9 +18,18 @@ layout(binding = 2) uniform sampler sprite_smp;
 #define SPRITES_COUNT 6
 layout(binding = 3) uniform sprites_transform {
   mat4 models[SPRITES_COUNT];
+  vec4 uv_rects[SPRITES_COUNT];
+  vec4 tints[SPRITES_COUNT];
+  uint distance_field_sprites;
 } sprites_tr;
 
-layout(binding = 4) uniform texture2D sprites[SPRITES_COUNT];
+// Castle texture is the first one, catapult sprites are packed into the atlas
+// bound second and the last sprite is the single channel text texture.
+layout(binding = 4) uniform texture2D sprite_textures[3];
+
+int sprite_texture(int sprite) {
+  return sprite == 0 ? 0 : (sprite == SPRITES_COUNT - 1 ? 2 : 1);
+}
 
 layout(location = 0) in vec3 frag_normal;
 layout(location = 1) in vec3 frag_pos;
@@ -45,11 +54,21 @@ void main() {
   vec3 color = vec3(grayfactor, grayfactor, bluefactor);
 
   for (int i = 0; i < SPRITES_COUNT; i++) {
+    vec2 uv = (sprites_tr.models[i]*vec4(frag_uv, 0, 1)).xy;
+    vec4 rect = sprites_tr.uv_rects[i];
     vec4 sprite_color = texture(
-      sampler2D(sprites[i], sprite_smp),
-      (sprites_tr.models[i]*vec4(frag_uv, 0, 1)).xy
+      sampler2D(sprite_textures[sprite_texture(i)], sprite_smp),
+      rect.xy + clamp(uv, 0.0, 1.0)*rect.zw
     );
-    color = mix(color, sprite_color.rgb, sprite_color.a);
+    // Distance fields are turned into coverage antialiased over a screen pixel
+    float edge = max(fwidth(sprite_color.a), 1e-3);
+    float alpha = (sprites_tr.distance_field_sprites & (1u << i)) != 0u
+      ? smoothstep(0.5 - edge, 0.5 + edge, sprite_color.a)
+      : sprite_color.a;
+    // Atlas neighbours must not show up out of the sprite area
+    vec2 inside = step(vec2(0.0), uv)*step(uv, vec2(1.0));
+    vec4 tint = sprites_tr.tints[i];
+    color = mix(color, sprite_color.rgb*tint.rgb, tint.a*alpha*inside.x*inside.y);
   }
 
   out_color = vec4(
@@ -74,6 +74,24 @@ memory memory::allocate(
 }
 
 void copy(vk::Queue transfer_queue, vk::CommandBuffer cmd, vk::Buffer src, vk::Image dst, vk::Extent2D sz) {
+  const auto copy_region =
+      vk::BufferImageCopy{}
+          .setImageExtent(vk::Extent3D{sz, 1})
+          .setImageSubresource(
+              vk::ImageSubresourceLayers{}.setLayerCount(1).setAspectMask(vk::ImageAspectFlagBits::eColor)
+          );
+  copy(transfer_queue, cmd, src, dst, std::span{&copy_region, 1});
+}
+
+void copy(
+    vk::Queue transfer_queue, vk::CommandBuffer cmd, vk::Buffer src, vk::Image dst,
+    std::span<const vk::BufferImageCopy> levels
+) {
+  const auto subresource_range = vk::ImageSubresourceRange{}
+                                     .setAspectMask(vk::ImageAspectFlagBits::eColor)
+                                     .setLevelCount(static_cast<uint32_t>(levels.size()))
+                                     .setLayerCount(1);
+
   cmd.begin(vk::CommandBufferBeginInfo{});
 
   const auto img_dst_barrier = vk::ImageMemoryBarrier{}
@@ -84,35 +102,22 @@ void copy(vk::Queue transfer_queue, vk::CommandBuffer cmd, vk::Buffer src, vk::I
                                    .setSrcQueueFamilyIndex(vk::QueueFamilyIgnored)
                                    .setDstQueueFamilyIndex(vk::QueueFamilyIgnored)
                                    .setImage(dst)
-                                   .setSubresourceRange(vk::ImageSubresourceRange{}
-                                                            .setAspectMask(vk::ImageAspectFlagBits::eColor)
-                                                            .setLevelCount(1)
-                                                            .setLayerCount(1));
+                                   .setSubresourceRange(subresource_range);
   cmd.pipelineBarrier(
       vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, {}, {}, {}, img_dst_barrier
   );
 
-  auto copy_region =
-      vk::BufferImageCopy{}
-          .setImageExtent(vk::Extent3D{sz, 1})
-          .setImageSubresource(
-              vk::ImageSubresourceLayers{}.setLayerCount(1).setAspectMask(vk::ImageAspectFlagBits::eColor)
-          );
-  cmd.copyBufferToImage(src, dst, vk::ImageLayout::eTransferDstOptimal, copy_region);
-
-  const auto img_sampler_barrier =
-      vk::ImageMemoryBarrier{}
-          .setSrcAccessMask(vk::AccessFlagBits::eTransferWrite)
-          .setDstAccessMask(vk::AccessFlagBits::eShaderRead)
-          .setOldLayout(vk::ImageLayout::eTransferDstOptimal)
-          .setNewLayout(vk::ImageLayout::eShaderReadOnlyOptimal)
-          .setSrcQueueFamilyIndex(vk::QueueFamilyIgnored)
-          .setDstQueueFamilyIndex(vk::QueueFamilyIgnored)
-          .setImage(dst)
-          .setSubresourceRange(vk::ImageSubresourceRange{}
-                                   .setAspectMask(vk::ImageAspectFlagBits::eColor)
-                                   .setLevelCount(1)
-                                   .setLayerCount(1));
+  cmd.copyBufferToImage(src, dst, vk::ImageLayout::eTransferDstOptimal, levels);
+
+  const auto img_sampler_barrier = vk::ImageMemoryBarrier{}
+                                       .setSrcAccessMask(vk::AccessFlagBits::eTransferWrite)
+                                       .setDstAccessMask(vk::AccessFlagBits::eShaderRead)
+                                       .setOldLayout(vk::ImageLayout::eTransferDstOptimal)
+                                       .setNewLayout(vk::ImageLayout::eShaderReadOnlyOptimal)
+                                       .setSrcQueueFamilyIndex(vk::QueueFamilyIgnored)
+                                       .setDstQueueFamilyIndex(vk::QueueFamilyIgnored)
+                                       .setImage(dst)
+                                       .setSubresourceRange(subresource_range);
   cmd.pipelineBarrier(
       vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader, {}, {}, {},
       img_sampler_barrier
@@ -133,4 +138,63 @@ void copy(vk::Queue transfer_queue, vk::CommandBuffer cmd, vk::Buffer src, vk::B
   transfer_queue.waitIdle();
 }
 
+void submit_rows_copy(
+    vk::Queue transfer_queue, vk::CommandBuffer cmd, vk::Buffer src, vk::DeviceSize src_offset, vk::Image dst,
+    vk::Extent2D sz, uint32_t first_row, uint32_t rows
+) {
+  const auto subresource_range = vk::ImageSubresourceRange{}
+                                     .setAspectMask(vk::ImageAspectFlagBits::eColor)
+                                     .setLevelCount(1)
+                                     .setLayerCount(1);
+
+  cmd.reset();
+  cmd.begin(vk::CommandBufferBeginInfo{}.setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+
+  if (first_row == 0) {
+    const auto img_dst_barrier = vk::ImageMemoryBarrier{}
+                                     .setSrcAccessMask(vk::AccessFlagBits::eNone)
+                                     .setDstAccessMask(vk::AccessFlagBits::eTransferWrite)
+                                     .setOldLayout(vk::ImageLayout::eUndefined)
+                                     .setNewLayout(vk::ImageLayout::eTransferDstOptimal)
+                                     .setSrcQueueFamilyIndex(vk::QueueFamilyIgnored)
+                                     .setDstQueueFamilyIndex(vk::QueueFamilyIgnored)
+                                     .setImage(dst)
+                                     .setSubresourceRange(subresource_range);
+    cmd.pipelineBarrier(
+        vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, {}, {}, {},
+        img_dst_barrier
+    );
+  }
+
+  const auto copy_region =
+      vk::BufferImageCopy{}
+          .setBufferOffset(src_offset)
+          .setImageOffset(vk::Offset3D{0, static_cast<int32_t>(first_row), 0})
+          .setImageExtent(vk::Extent3D{sz.width, rows, 1})
+          .setImageSubresource(
+              vk::ImageSubresourceLayers{}.setLayerCount(1).setAspectMask(vk::ImageAspectFlagBits::eColor)
+          );
+  cmd.copyBufferToImage(src, dst, vk::ImageLayout::eTransferDstOptimal, copy_region);
+
+  if (first_row + rows == sz.height) {
+    const auto img_sampler_barrier = vk::ImageMemoryBarrier{}
+                                         .setSrcAccessMask(vk::AccessFlagBits::eTransferWrite)
+                                         .setDstAccessMask(vk::AccessFlagBits::eShaderRead)
+                                         .setOldLayout(vk::ImageLayout::eTransferDstOptimal)
+                                         .setNewLayout(vk::ImageLayout::eShaderReadOnlyOptimal)
+                                         .setSrcQueueFamilyIndex(vk::QueueFamilyIgnored)
+                                         .setDstQueueFamilyIndex(vk::QueueFamilyIgnored)
+                                         .setImage(dst)
+                                         .setSubresourceRange(subresource_range);
+    cmd.pipelineBarrier(
+        vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader, {}, {}, {},
+        img_sampler_barrier
+    );
+  }
+
+  cmd.end();
+
+  transfer_queue.submit(vk::SubmitInfo{}.setCommandBuffers(cmd));
+}
+
 } // namespace vlk
@@ -110,6 +110,21 @@ private:
 
 void copy(vk::Queue transfer_queue, vk::CommandBuffer cmd, vk::Buffer src, vk::Image dst, vk::Extent2D sz);
 
+/// Copies `levels` regions each of them filling the mip level it refers to.
+/// All levels of `dst` transition to the shader read layout.
+void copy(
+    vk::Queue transfer_queue, vk::CommandBuffer cmd, vk::Buffer src, vk::Image dst,
+    std::span<const vk::BufferImageCopy> levels
+);
+
 void copy(vk::Queue transfer_queue, vk::CommandBuffer cmd, vk::Buffer src, vk::Buffer dst, size_t count);
 
+/// Submits copy of `rows` image rows starting from `first_row` without waiting
+/// for completion. Caller must wait for the transfer queue to become idle
+/// before reusing `cmd` or the `src` region.
+void submit_rows_copy(
+    vk::Queue transfer_queue, vk::CommandBuffer cmd, vk::Buffer src, vk::DeviceSize src_offset, vk::Image dst,
+    vk::Extent2D sz, uint32_t first_row, uint32_t rows
+);
+
 } // namespace vlk
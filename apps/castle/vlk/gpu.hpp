@@ -32,6 +32,12 @@ public:
 
   vk::SampleCountFlagBits find_max_usable_samples() const noexcept;
 
+  bool supports_sampling(vk::Format fmt) const noexcept {
+    return static_cast<bool>(
+        phydev_.getFormatProperties(fmt).optimalTilingFeatures & vk::FormatFeatureFlagBits::eSampledImage
+    );
+  }
+
   std::optional<vk::Format> find_compatible_format_for(vk::SurfaceKHR surf) const;
 
   vk::SwapchainCreateInfoKHR
@@ -114,7 +114,8 @@ vma_allocator::allocate_buffer(vk::BufferUsageFlags usage, size_t count) const {
   return {get(), buf, mem};
 }
 
-allocated_resource<vk::Image> vma_allocator::allocate_image(vk::Format fmt, vk::Extent2D sz) const {
+allocated_resource<vk::Image>
+vma_allocator::allocate_image(vk::Format fmt, vk::Extent2D sz, uint32_t mip_levels) const {
   VmaAllocationCreateInfo alloc_info{};
   alloc_info.usage = VMA_MEMORY_USAGE_AUTO;
 
@@ -123,7 +124,7 @@ allocated_resource<vk::Image> vma_allocator::allocate_image(vk::Format fmt, vk::
           .setImageType(vk::ImageType::e2D)
           .setFormat(fmt)
           .setExtent(vk::Extent3D{sz, 1})
-          .setMipLevels(1)
+          .setMipLevels(mip_levels)
           .setArrayLayers(1)
           .setUsage(vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled);
 
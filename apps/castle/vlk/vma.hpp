@@ -81,7 +81,8 @@ struct vma_allocator : detail::vma_allocator_ptr {
 
   staging_buf allocate_staging_buffer(size_t size) const;
   allocated_resource<vk::Buffer> allocate_buffer(vk::BufferUsageFlags usage, size_t count) const;
-  allocated_resource<vk::Image> allocate_image(vk::Format fmt, vk::Extent2D sz) const;
+  allocated_resource<vk::Image>
+  allocate_image(vk::Format fmt, vk::Extent2D sz, uint32_t mip_levels = 1) const;
 };
 
 } // namespace vlk
@@ -6,25 +6,31 @@
 
 #include <libs/eglctx/gles_context.hpp>
 #include <libs/img/load.hpp>
+#include <libs/swrast/animation.hpp>
 #include <libs/xdg/xdg.hpp>
 
 #include <apps/colorcube/renderer.hpp>
+#include <apps/colorcube/soft_renderer.hpp>
 
-#include <libs/wlwnd/animation_window.hpp>
 #include <libs/wlwnd/event_loop.hpp>
 #include <libs/wlwnd/gui_shell.hpp>
+#include <libs/wlwnd/render_loop.hpp>
 
 asio::awaitable<void> draw_scene(
     co::io_executor io_exec, co::pool_executor pool_exec, const scene::controller& controller,
-    const char* wl_display
+    const char* wl_display, bool software
 ) {
   event_loop eloop{wl_display};
   wl::gui_shell shell{eloop};
 
-  animation_window wnd{
-      eloop.make_queue(), pool_exec, co_await shell.create_maximized_window(eloop, io_exec),
-      make_gles_animation_function<scene_renderer>(std::cref(controller))
-  };
+  render_loop renderer{eloop, pool_exec};
+  auto wnd = renderer.add_window(
+      co_await shell.create_maximized_window(eloop, io_exec),
+      software ? make_swrast_animation_function<soft_scene_renderer>(
+                     *shell.get_shm(), pool_exec, std::cref(controller)
+                 )
+               : make_gles_animation_function<scene_renderer>(std::cref(controller))
+  );
 
   co_await eloop.dispatch_while(io_exec, [&] {
     if (auto ec = shell.check()) {
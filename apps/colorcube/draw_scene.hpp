@@ -10,5 +10,5 @@
 
 asio::awaitable<void> draw_scene(
     co::io_executor io_exec, co::pool_executor pool_exec, const scene::controller& controller,
-    const char* wl_display
+    const char* wl_display, bool software
 );
@@ -27,13 +27,17 @@ struct opts {
           "Specify wayland display. Current session default is used if nothing is specified."
       }
           .default_value(nullptr);
+  // For machines without GPU
+  bool software = args::flag{"--software", "Draw the scene on the CPU instead of OpenGL ES."};
 };
 
 } // namespace
 
 namespace co {
 
-unsigned min_threads = 3;
+// One thread runs the io context and another one the render loop of all
+// windows. Row bands are drawn on the render thread if no other is free.
+unsigned min_threads = 2;
 
 asio::awaitable<int> main(io_executor io_exec, pool_executor pool_exec, std::span<char*> args) {
   if (get_flag(args, "-h")) {
@@ -45,7 +49,9 @@ asio::awaitable<int> main(io_executor io_exec, pool_executor pool_exec, std::spa
   const auto opt = args::parse<opts>(args);
 
   scene::controller controller;
-  co_await (draw_scene(io_exec, pool_exec, controller, opt.display) || listen_gamepad(io_exec, controller));
+  co_await (
+      draw_scene(io_exec, pool_exec, controller, opt.display, opt.software) || listen_gamepad(io_exec, controller)
+  );
 
   co_return EXIT_SUCCESS;
 }
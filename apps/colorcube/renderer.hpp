@@ -11,6 +11,7 @@
 #include <libs/anime/anime.hpp>
 #include <libs/anime/clock.hpp>
 
+#include <apps/colorcube/scene_geometry.hpp>
 #include <apps/colorcube/shader_pipeline.hpp>
 
 namespace scene {
@@ -36,5 +37,5 @@ private:
 
   linear_animation landscape_color_;
   linear_animation cube_color_;
-  clamped_integrator cube_pos_integrator_{{.min = {-0.5, -1.}, .max = {7.5, 7.}}, {}, {}};
+  clamped_integrator cube_pos_integrator_{scene::cube_area, {}, {}};
 };
@@ -0,0 +1,95 @@
+#include "scene_geometry.hpp"
+
+#include <cmath>
+
+#include <glm/ext.hpp>
+
+using namespace std::literals;
+
+namespace scene {
+
+namespace {
+
+// clang-format off
+const vertex cube_verts[] = {
+    {{-1., 1., -1.}, {0., 0., -1.}},
+    {{1., 1., -1.}, {0., 0., -1.}},
+    {{-1., -1., -1.}, {0., 0., -1.}},
+    {{1., -1., -1.}, {0., 0., -1.}},
+    
+    {{1., 1., -1.}, {1., 0., 0.}},
+    {{1., 1., 1.}, {1., 0., 0.}},
+    {{1., -1., -1.}, {1., 0., 0.}},
+    {{1., -1., 1.}, {1., 0., 0.}},
+    
+    {{-1., 1., -1.}, {-1., 0., 0.}},
+    {{-1., 1., 1.}, {-1., 0., 0.}},
+    {{-1., -1., -1.}, {-1., 0., 0.}},
+    {{-1., -1., 1.}, {-1., 0., 0.}},
+    
+    {{-1., 1., -1.}, {0., 1., 0.}},
+    {{1., 1., -1.}, {0., 1., 0.}},
+    {{1., 1., 1.}, {0., 1., 0.}},
+    {{-1., 1., 1.}, {0., 1., 0.}},
+    
+    {{-1., -1., -1.}, {0., -1., 0.}},
+    {{1., -1., -1.}, {0., -1., 0.}},
+    {{1., -1., 1.}, {0., -1., 0.}},
+    {{-1., -1., 1.}, {0., -1., 0.}},
+    
+    {{-1., 1., 1.}, {0., 0., 1.}},
+    {{1., 1., 1.}, {0., 0., 1.}},
+    {{-1., -1., 1.}, {0., 0., 1.}},
+    {{1., -1., 1.}, {0., 0., 1.}}
+};
+const unsigned cube_idxs[] = {
+    0, 1, 2, 1, 3, 2,
+    
+    4, 5, 6, 6, 5, 7,
+    
+    8, 9, 10, 10, 9, 11,
+    
+    12, 13, 14, 14, 12, 15,
+    
+    16, 17, 18, 18, 16, 19,
+    
+    20, 21, 22, 21, 23, 22
+};
+// clang-format on
+
+} // namespace
+
+std::span<const vertex> cube_vertices() noexcept { return cube_verts; }
+std::span<const unsigned> cube_indexes() noexcept { return cube_idxs; }
+
+hexagon_tiles<vertex> make_landscape() {
+  using namespace mp_units::si::unit_symbols;
+  return hexagon_tiles<vertex>::generate(5 * cm, 120, 80, [](glm::vec2 pt) {
+    return vertex{.position = {pt, 0.}, .normal = {0., 0., 1.}};
+  });
+}
+
+glm::mat4 camera_transform(size sz) noexcept {
+  constexpr auto camera_pos_ = glm::vec3{7., 12., 18.};
+  constexpr auto camera_look_at = glm::vec3{3., 2., 0.};
+  constexpr auto camera_up_direction_ = glm::vec3{0., 0., 1.};
+  return glm::perspectiveFov<float>(M_PI / 6., sz.width, sz.height, 10.f, 35.f) *
+         glm::lookAt(camera_pos_, camera_look_at, camera_up_direction_);
+}
+
+glm::mat4 animate_cube_pos(glm::vec2 planar_pos, frames_clock::time_point ts) noexcept {
+  constexpr auto period = 5s;
+  constexpr auto flyght_period = 7s;
+
+  const float spin_phase =
+      (ts.time_since_epoch() % period).count() / float(frames_clock::duration{period}.count());
+  const float flyght_phase = (ts.time_since_epoch() % flyght_period).count() /
+                             float(frames_clock::duration{flyght_period}.count());
+
+  const float angle = 2 * M_PI * spin_phase;
+
+  return glm::translate(glm::mat4{1.}, glm::vec3{planar_pos, 3. + 2. * std::cos(2 * M_PI * flyght_phase)}) *
+         glm::rotate(glm::mat4{1.}, angle, {.5, .3, .1}) * glm::scale(glm::mat4{1.}, {.5, .5, .5});
+}
+
+} // namespace scene
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <span>
+
+#include <glm/glm.hpp>
+
+#include <libs/anime/anime.hpp>
+#include <libs/anime/clock.hpp>
+#include <libs/geom/geom.hpp>
+#include <libs/geom/hexagon_tiles.hpp>
+
+#include <apps/colorcube/mesh_data.hpp>
+
+/// Scene description shared by the GLES and the software renderers.
+namespace scene {
+
+struct light_source {
+  glm::vec3 pos;
+  float intense;
+  float ambient;
+  float attenuation;
+};
+
+constexpr light_source light{.pos = {2., 5., 15.}, .intense = .8, .ambient = .4, .attenuation = .01};
+
+constexpr bounding_box cube_area{.min = {-0.5, -1.}, .max = {7.5, 7.}};
+
+std::span<const vertex> cube_vertices() noexcept;
+std::span<const unsigned> cube_indexes() noexcept;
+
+hexagon_tiles<vertex> make_landscape();
+
+glm::mat4 camera_transform(size sz) noexcept;
+glm::mat4 animate_cube_pos(glm::vec2 planar_pos, frames_clock::time_point ts) noexcept;
+
+} // namespace scene
@@ -1,6 +1,7 @@
 #include "shader_pipeline.hpp"
 
 #include <apps/colorcube/mesh_data.hpp>
+#include <apps/colorcube/scene_geometry.hpp>
 #include <apps/colorcube/shaders.hpp>
 
 namespace {
@@ -45,10 +46,10 @@ shader_pipeline::shader_pipeline()
   color_uniform_ = shader_prog_.get_uniform<glm::vec3>("color");
 
   shader_prog_.use();
-  shader_prog_.get_uniform<float>("light.intense").set_value(0.8);
-  shader_prog_.get_uniform<float>("light.ambient").set_value(0.4);
-  shader_prog_.get_uniform<float>("light.attenuation").set_value(0.01);
-  shader_prog_.get_uniform<glm::vec3>("light.pos").set_value({2., 5., 15.});
+  shader_prog_.get_uniform<float>("light.intense").set_value(scene::light.intense);
+  shader_prog_.get_uniform<float>("light.ambient").set_value(scene::light.ambient);
+  shader_prog_.get_uniform<float>("light.attenuation").set_value(scene::light.attenuation);
+  shader_prog_.get_uniform<glm::vec3>("light.pos").set_value(scene::light.pos);
 };
 
 void shader_pipeline::start_rendering(glm::mat4 camera) {
@@ -0,0 +1,62 @@
+#include "soft_renderer.hpp"
+
+#include <Tracy.hpp>
+
+#include <glm/ext.hpp>
+
+#include <apps/colorcube/controller.hpp>
+
+namespace {
+
+// Same as phong_reflect from the phong.frag shader
+glm::vec3 phong_reflect(
+    const scene::light_source& light, glm::vec3 surf_color, glm::vec3 world_pos, glm::vec3 world_normal
+) noexcept {
+  const glm::vec3 light_direction = glm::normalize(light.pos - world_pos);
+  const float brightnes = glm::clamp(light.intense * glm::dot(world_normal, light_direction), 0.f, 1.f);
+  const glm::vec3 diffuse = brightnes * surf_color;
+  const glm::vec3 ambient = light.intense * light.ambient * surf_color;
+  const float distance = glm::length(light.pos - world_pos);
+  const float attenuation = 1.f / (1.f + light.attenuation * distance * distance);
+  return ambient + attenuation * diffuse;
+}
+
+} // namespace
+
+soft_scene_renderer::soft_scene_renderer(swrast::rasterizer& rast, const scene::controller& contr)
+    : rast_{rast}, controller_{contr}, landscape_{scene::make_landscape()} {}
+
+void soft_scene_renderer::resize(size sz) { camera_ = scene::camera_transform(sz); }
+
+void soft_scene_renderer::draw(clock::time_point ts) {
+  FrameMark;
+  ZoneScopedN("render frame");
+  if (const auto cube_color = controller_.get_cube_color_update())
+    cube_color_.reset(ts, cube_color.value());
+  if (const auto landscape_color = controller_.get_landscape_color_update())
+    landscape_color_.reset(ts, landscape_color.value());
+  const auto cube_vel = controller_.current_cube_vel();
+
+  const glm::mat4 model = scene::animate_cube_pos(cube_pos_integrator_(cube_vel, ts), ts);
+
+  rast_.clear({0., 0., 0., .75});
+  draw_mesh(landscape_.verticies(), landscape_.indexes(), glm::mat4{1.}, landscape_color_.animate(ts));
+  draw_mesh(scene::cube_vertices(), scene::cube_indexes(), model, cube_color_.animate(ts));
+}
+
+void soft_scene_renderer::draw_mesh(
+    std::span<const vertex> verticies, std::span<const unsigned> indexes, glm::mat4 model, glm::vec3 color
+) {
+  ZoneScopedN("shade verticies");
+  const glm::mat4 transform = camera_ * model;
+  const glm::mat3 norm_rotation = glm::transpose(glm::inverse(glm::mat3(model)));
+  shaded_.clear();
+  for (const vertex& v : verticies) {
+    const glm::vec3 world_pos{model * glm::vec4{v.position, 1.}};
+    shaded_.push_back(
+        {.position = transform * glm::vec4{v.position, 1.},
+         .color = phong_reflect(scene::light, color, world_pos, glm::normalize(norm_rotation * v.normal))}
+    );
+  }
+  rast_.draw(shaded_, indexes);
+}
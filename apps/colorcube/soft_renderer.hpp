@@ -0,0 +1,48 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+
+#include <libs/anime/anime.hpp>
+#include <libs/anime/clock.hpp>
+#include <libs/geom/geom.hpp>
+#include <libs/geom/hexagon_tiles.hpp>
+#include <libs/swrast/rasterizer.hpp>
+
+#include <apps/colorcube/mesh_data.hpp>
+#include <apps/colorcube/scene_geometry.hpp>
+
+namespace scene {
+class controller;
+}
+
+/// Draws the same scene as scene_renderer on the CPU. Lighting is computed
+/// per vertex rather than per fragment.
+class soft_scene_renderer {
+  using clock = frames_clock;
+
+public:
+  soft_scene_renderer(swrast::rasterizer& rast, const scene::controller& controller);
+
+  void resize(size sz);
+  void draw(clock::time_point ts);
+
+private:
+  void draw_mesh(
+      std::span<const vertex> verticies, std::span<const unsigned> indexes, glm::mat4 model, glm::vec3 color
+  );
+
+private:
+  swrast::rasterizer& rast_;
+  const scene::controller& controller_;
+
+  hexagon_tiles<vertex> landscape_;
+  std::vector<swrast::vertex> shaded_;
+  glm::mat4 camera_;
+
+  linear_animation landscape_color_;
+  linear_animation cube_color_;
+  clamped_integrator cube_pos_integrator_{scene::cube_area, {}, {}};
+};
@@ -1,24 +1,44 @@
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cmath>
 #include <iostream>
+#include <memory>
 #include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 #include <asio/awaitable.hpp>
 
+#include <fmt/format.h>
+
 #include <spdlog/spdlog.h>
 
 #include <wayland-client.h>
 
 #include <thinsys/io/io.hpp>
-#include <thinsys/io/mmap.hpp>
 
+#include <libs/anime/clock.hpp>
 #include <libs/cli/struct_args.hpp>
 #include <libs/corort/executors.hpp>
+#include <libs/geom/damage.hpp>
+#include <libs/img/compose.hpp>
+#include <libs/img/convert.hpp>
 #include <libs/img/load.hpp>
+#include <libs/img/resample.hpp>
+#include <libs/img/text_surface.hpp>
 #include <libs/sfx/sfx.hpp>
 #include <libs/wlwnd/animation_window.hpp>
 #include <libs/wlwnd/event_loop.hpp>
 #include <libs/wlwnd/framebuf.hpp>
 #include <libs/wlwnd/gui_shell.hpp>
-#include <libs/wlwnd/vsync_frames.hpp>
+#include <libs/wlwnd/render_loop.hpp>
+
+using namespace std::literals;
 
 namespace {
 
@@ -29,27 +49,243 @@ struct opts {
           "Specify wayland display. Current session default is used if nothing is specified."
       }
           .default_value(nullptr);
+  std::string_view sprites =
+      args::option<std::string_view>{
+          "--sprites", "Number of sprites flying over the image. The image is shown still if it is zero."
+      }
+          .default_value("0");
+};
+
+size_t parse_count(std::string_view str) {
+  size_t res = 0;
+  const char* const str_end = str.data() + str.size();
+  if (const auto [end, ec] = std::from_chars(str.data(), str_end, res); ec != std::errc{} || end != str_end)
+    throw std::runtime_error{"Invalid sprites count: " + std::string{str}};
+  return res;
+}
+
+// Decodes image straight into the premultiplied BGRA layout expected by
+// WL_SHM_FORMAT_ARGB8888 buffers so that it is converted only once.
+img::image<img::pixel_fmt::rgba> load_shm_image(thinsys::io::file_descriptor& fd) {
+  auto reader = img::transform_rows(img::expand_to_rgba(img::load_reader(fd)), [](std::span<std::byte> rows) {
+    img::swap_red_blue(rows);
+    img::premultiply_alpha(rows);
+  });
+  std::unique_ptr<std::byte[]> pixels{new std::byte[reader.pixels_size()]};
+  reader.read_pixels({pixels.get(), reader.pixels_size()});
+  return {std::move(pixels), reader.size()};
+}
+
+// Image is scaled straight into the shm buffer
+void draw_image(
+    co::pool_executor pool_exec, const img::image<img::pixel_fmt::rgba>& img, size sz,
+    std::span<std::byte> dest
+) {
+  if (sz == img.size())
+    std::ranges::copy(img.bytes(), dest.begin());
+  else
+    img::resample(pool_exec, img::resampler{img.size(), sz}, img.bytes(), dest);
+}
+
+// Content changes only when the window is resized. Each buffer remembers the
+// content version it holds so that it is drawn once per change and nothing is
+// committed while the content stays the same.
+class image_renderer final : public window_renderer {
+public:
+  image_renderer(
+      const render_target& target, wl_shm& shm, co::pool_executor pool_exec,
+      img::image<img::pixel_fmt::rgba> img
+  )
+      : surf_{target.surface}, pool_exec_{pool_exec}, img_{std::move(img)},
+        fb_{shm, target.display, target.size} {}
+
+  void resize(size sz) override {
+    fb_.resize(sz);
+    buffer_versions_ = {};
+    ++content_version_;
+  }
+
+  bool draw(frames_clock::time_point) override {
+    if (committed_version_ == content_version_)
+      return false;
+    if (std::exchange(buffer_versions_[fb_.front_index()], content_version_) != content_version_)
+      draw_image(pool_exec_, img_, fb_.size(), fb_.front());
+    fb_.swap(surf_);
+    committed_version_ = content_version_;
+    return true;
+  }
+
+private:
+  wl_surface& surf_;
+  co::pool_executor pool_exec_;
+  img::image<img::pixel_fmt::rgba> img_;
+  wl::framebuf fb_;
+  uint64_t content_version_ = 1;
+  uint64_t committed_version_ = 0;
+  std::array<uint64_t, wl::framebuf::max_buffers> buffer_versions_{};
 };
 
-animation_function make_animation_function(wl_shm& shm, img::image<img::pixel_fmt::rgba> img) {
-  return [&shm, img = std::move(img)](
-             wl_display& display, wl_surface& surf, vsync_frames& frames,
-             value_update_channel<size>& resize_channel
-         ) {
-    const size sz = resize_channel.get_current();
+animation_function
+make_animation_function(wl_shm& shm, co::pool_executor pool_exec, img::image<img::pixel_fmt::rgba> img) {
+  return [&shm, pool_exec, img = std::move(img)](const render_target& target) mutable {
+    return std::make_unique<image_renderer>(target, shm, pool_exec, std::move(img));
+  };
+}
 
-    wl::framebuf fb{shm, sz};
-    std::ranges::copy(img.bytes(), fb.front().data());
-    fb.swap(surf);
+// Sprites are copies of the image reduced to the sixth of the window height
+// moving along Lissajous curves with distinct phases while spinning and
+// fading in and out. Curves have no common period, so the time is counted
+// from the animation start to keep float seconds precise.
+void place_sprites(
+    const img::image<img::pixel_fmt::rgba>& img, size sz, frames_clock::duration elapsed,
+    std::span<img::layer> sprites
+) {
+  const float time = std::chrono::duration_cast<float_time::seconds>(elapsed).count();
+  const float scale = sz.height / (6.f * img.size().height);
+  for (size_t i = 0; i < sprites.size(); ++i) {
+    const float phase = 2.399f * i + time;
+    const float x = sz.width * (.5f + .45f * std::sin(.31f * phase + i));
+    const float y = sz.height * (.5f + .45f * std::sin(.43f * phase));
+    sprites[i] = img::layer{
+        .pixels = img.bytes(),
+        .size = img.size(),
+        .transform = img::affine_transform::place(img.size(), x, y, scale, .7f * phase),
+        .opacity = .6f + .4f * std::sin(phase)
+    };
+  }
+}
 
-    for (auto ts [[maybe_unused]] : frames) {
-      if (const auto sz = resize_channel.get_update()) {
-        fb = wl::framebuf{shm, sz.value()};
+// Frame rate shown as white text in the top left corner. Only glyphs changed
+// since the last update are converted to the premultiplied layer pixels.
+class fps_label {
+public:
+  explicit fps_label(img::font& font)
+      : text_{font, 5 * (font.ascender() + font.descender())},
+        pixels_(4 * text_.size().width * text_.size().height) {}
+
+  void count_frame(frames_clock::time_point frame_time) {
+    ++frames_;
+    const auto elapsed = frame_time - start_;
+    if (elapsed < 1s)
+      return;
+    if (start_ != frames_clock::time_point{})
+      text_.update(fmt::format("{:.0f} fps", frames_ / float_time::seconds{elapsed}.count()));
+    start_ = frame_time;
+    frames_ = 0;
+  }
+
+  // Label height is the twelfth of the canvas height
+  img::layer layer(size canvas) {
+    const size sz = text_.size();
+    const size_t stride = sz.width;
+    for (const rect& r : text_.take_dirty()) {
+      for (int32_t y = r.y; y < r.y + r.height; ++y) {
+        for (int32_t x = r.x; x < r.x + r.width; ++x)
+          std::fill_n(pixels_.begin() + 4 * (y * stride + x), 4, text_.pixels()[y * stride + x]);
       }
+    }
+    const float scale = canvas.height / (12.f * sz.height);
+    const float margin = canvas.height / 48.f;
+    return {
+        .pixels = pixels_,
+        .size = sz,
+        .transform = img::affine_transform::place(
+            sz, margin + scale * sz.width / 2, margin + scale * sz.height / 2, scale
+        )
+    };
+  }
+
+private:
+  img::text_surface text_;
+  std::vector<std::byte> pixels_;
+  frames_clock::time_point start_;
+  unsigned frames_ = 0;
+};
+
+// The scaled image is kept aside and copied to each frame before sprites are
+// blended over it. Only the areas covered by sprites and the frame rate label
+// in the previous or the current frame are redrawn and reported as damaged,
+// the framebuf keeps the rest from the previous frame.
+class sprites_renderer final : public window_renderer {
+public:
+  sprites_renderer(
+      const render_target& target, wl_shm& shm, co::pool_executor pool_exec,
+      img::image<img::pixel_fmt::rgba> img, size_t count, img::font& font
+  )
+      : surf_{target.surface}, pool_exec_{pool_exec}, img_{std::move(img)},
+        fb_{shm, target.display, target.size}, sprites_(count + 1), fps_{font} {
+    draw_background();
+  }
+
+  void resize(size sz) override {
+    fb_.resize(sz);
+    draw_background();
+  }
 
-      std::ranges::copy(img.bytes(), fb.front().data());
-      fb.swap(surf);
+  bool draw(frames_clock::time_point frame_time) override {
+    const size sz = fb_.size();
+    if (start_ == frames_clock::time_point{})
+      start_ = frame_time;
+    place_sprites(img_, sz, frame_time - start_, std::span{sprites_}.first(sprites_.size() - 1));
+    fps_.count_frame(frame_time);
+    sprites_.back() = fps_.layer(sz);
+    damage_region damage;
+    for (const rect& r : bounds_)
+      damage.add(r);
+    const rect canvas_rect{.width = sz.width, .height = sz.height};
+    for (size_t i = 0; i < sprites_.size(); ++i) {
+      bounds_[i] = intersection(img::bounds(sprites_[i]), canvas_rect);
+      damage.add(bounds_[i]);
     }
+    damage.simplify(wl::framebuf::max_damage_rects);
+
+    const auto canvas = fb_.front();
+    if (std::exchange(full_redraw_, false)) {
+      std::ranges::copy(background_, canvas.begin());
+    } else {
+      const size_t stride = 4 * sz.width;
+      for (const rect& r : damage.rects()) {
+        for (int32_t y = r.y; y < r.y + r.height; ++y) {
+          const size_t pos = y * stride + 4 * r.x;
+          std::copy_n(background_.begin() + pos, 4 * r.width, canvas.begin() + pos);
+        }
+        fb_.damage(r);
+      }
+    }
+    img::compose(pool_exec_, sprites_, canvas, sz);
+    fb_.swap(surf_);
+    return true;
+  }
+
+private:
+  void draw_background() {
+    background_.resize(4 * fb_.size().width * fb_.size().height);
+    draw_image(pool_exec_, img_, fb_.size(), background_);
+    std::ranges::fill(bounds_, rect{});
+    full_redraw_ = true;
+  }
+
+private:
+  wl_surface& surf_;
+  co::pool_executor pool_exec_;
+  img::image<img::pixel_fmt::rgba> img_;
+  wl::framebuf fb_;
+  std::vector<std::byte> background_;
+  frames_clock::time_point start_;
+  // Sprites followed by the frame rate label
+  std::vector<img::layer> sprites_;
+  fps_label fps_;
+  // Areas covered by sprites in the last frame
+  std::vector<rect> bounds_ = std::vector<rect>(sprites_.size());
+  bool full_redraw_ = true;
+};
+
+animation_function make_sprites_animation_function(
+    wl_shm& shm, co::pool_executor pool_exec, img::image<img::pixel_fmt::rgba> img, size_t count,
+    img::font& font
+) {
+  return [&shm, pool_exec, img = std::move(img), count, &font](const render_target& target) mutable {
+    return std::make_unique<sprites_renderer>(target, shm, pool_exec, std::move(img), count, font);
   };
 }
 
@@ -57,7 +293,9 @@ animation_function make_animation_function(wl_shm& shm, img::image<img::pixel_fm
 
 namespace co {
 
-unsigned min_threads = 3;
+// One thread runs the io context and another one the render loop of all
+// windows. Row bands are drawn on the render thread if no other is free.
+unsigned min_threads = 2;
 
 asio::awaitable<int> main(io_executor io_exec, pool_executor pool_exec, std::span<char*> args) {
   if (get_flag(args, "-h")) {
@@ -72,14 +310,21 @@ asio::awaitable<int> main(io_executor io_exec, pool_executor pool_exec, std::spa
   wl::gui_shell shell{eloop};
 
   auto res = sfx::archive::open_self();
-  auto& fd = res.open("images/head.png");
-  auto img = img::load<img::pixel_fmt::rgba>(fd);
+  // QOI copy is produced at build time since it decodes much faster than PNG
+  auto& fd = res.open("images/head.qoi");
+  auto img = load_shm_image(fd);
   const size sz = img.size();
+  const size_t sprites = parse_count(opt.sprites);
+  // Fonts loaded from memory keep referencing it, the archive stays mapped
+  auto font = img::font::load(res.map("fonts/RuthlessSketch.ttf"));
 
-  animation_window wnd{
-      eloop.make_queue(), pool_exec, shell.create_window(eloop, sz),
-      make_animation_function(*shell.get_shm(), std::move(img))
-  };
+  render_loop renderer{eloop, pool_exec};
+  auto wnd = renderer.add_window(
+      shell.create_window(eloop, sz),
+      sprites == 0
+          ? make_animation_function(*shell.get_shm(), pool_exec, std::move(img))
+          : make_sprites_animation_function(*shell.get_shm(), pool_exec, std::move(img), sprites, font)
+  );
 
   co_await eloop.dispatch_while(io_exec, [&] {
     if (auto ec = shell.check()) {
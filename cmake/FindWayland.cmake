@@ -17,6 +17,26 @@ mark_as_advanced(
   WAYLAND_CLIENT_LIBRARY
 )
 
+# wayland-server is an optional component needed by the test compositor only
+pkg_check_modules(PC_WAYLAND_SERVER QUIET wayland-server)
+find_path(WAYLAND_SERVER_INCLUDE_DIR
+  NAMES wayland-server.h
+  PATHS
+    ${PC_WAYLAND_SERVER_INCLUDE_DIRS}
+  PATH_SUFFIXES wayland
+)
+find_library(WAYLAND_SERVER_LIBRARY
+  NAMES wayland-server
+  PATHS ${PC_WAYLAND_SERVER_LIBRARY_DIRS}
+)
+mark_as_advanced(
+  WAYLAND_SERVER_INCLUDE_DIR
+  WAYLAND_SERVER_LIBRARY
+)
+if (WAYLAND_SERVER_INCLUDE_DIR AND WAYLAND_SERVER_LIBRARY)
+  set(Wayland_server_FOUND TRUE)
+endif()
+
 # wayland-egl
 pkg_check_modules(PC_WAYLAND_EGL QUIET wayland-egl)
 find_path(WAYLAND_EGL_INCLUDE_DIR
@@ -51,6 +71,7 @@ find_package_handle_standard_args(Wayland
     WAYLAND_EGL_INCLUDE_DIR WAYLAND_EGL_LIBRARY
     WAYLAND_SCANNER
   VERSION_VAR WAYLAND_VERSION
+  HANDLE_COMPONENTS
 )
 
 # imported targets
@@ -67,6 +88,15 @@ if (NOT TARGET Wayland::client)
   )
 endif()
 
+if (Wayland_server_FOUND AND NOT TARGET Wayland::server)
+  add_library(Wayland::server UNKNOWN IMPORTED)
+  set_target_properties(Wayland::server PROPERTIES
+    IMPORTED_LOCATION "${WAYLAND_SERVER_LIBRARY}"
+    INTERFACE_INCLUDE_DIRECTORIES "${WAYLAND_SERVER_INCLUDE_DIR}"
+    INTERFACE_COMPILE_OPTIONS "${PC_WAYLAND_SERVER_CFLAGS_OTHER}"
+  )
+endif()
+
 if (NOT TARGET Wayland::egl)
   add_library(Wayland::egl UNKNOWN IMPORTED)
   set_target_properties(Wayland::egl PROPERTIES
@@ -0,0 +1,34 @@
+find_program(COMPRESSONATORCLI NAMES compressonatorcli compressonatorcli-bin)
+
+# Converts PNG textures into KTX2 containers with block compressed mip chains
+# placed into the current binary dir under the same relative paths with .ktx2
+# extension. The list of produced files is stored into OUTPUT_VAR which is
+# left empty if no converter is available so that only PNG textures are used.
+#
+# ktx2_textures(Tgt FORMAT BC7 OUTPUT_VAR Var SOURCES textures/a.png ...)
+function(ktx2_textures Tgt)
+  cmake_parse_arguments(KTX2 "" "FORMAT;OUTPUT_VAR" "SOURCES" ${ARGN})
+  set(${KTX2_OUTPUT_VAR} "" PARENT_SCOPE)
+  if (NOT COMPRESSONATORCLI)
+    message(STATUS "compressonatorcli is not found: ${Tgt} textures are not block compressed")
+    return()
+  endif()
+
+  foreach(Src ${KTX2_SOURCES})
+    string(REGEX REPLACE "\\.png$" ".ktx2" Out ${Src})
+    get_filename_component(OutDir ${CMAKE_CURRENT_BINARY_DIR}/${Out} DIRECTORY)
+    add_custom_command(
+      OUTPUT ${CMAKE_CURRENT_BINARY_DIR}/${Out}
+      COMMAND ${CMAKE_COMMAND} -E make_directory ${OutDir}
+      COMMAND ${COMPRESSONATORCLI} -fd ${KTX2_FORMAT} -mipsize 4 -EncodeWith CPU
+        ${CMAKE_CURRENT_SOURCE_DIR}/${Src} ${CMAKE_CURRENT_BINARY_DIR}/${Out}
+      DEPENDS ${CMAKE_CURRENT_SOURCE_DIR}/${Src}
+    )
+    list(APPEND Outputs ${Out})
+    list(APPEND OutputPaths ${CMAKE_CURRENT_BINARY_DIR}/${Out})
+  endforeach()
+
+  add_custom_target(${Tgt}.ktx2 DEPENDS ${OutputPaths})
+  add_dependencies(${Tgt} ${Tgt}.ktx2)
+  set(${KTX2_OUTPUT_VAR} ${Outputs} PARENT_SCOPE)
+endfunction()
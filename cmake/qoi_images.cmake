@@ -0,0 +1,26 @@
+# Converts PNG images into QOI ones placed into the current binary dir under
+# the same relative paths with .qoi extension. QOI decoding is several times
+# faster than PNG one for the price of somewhat larger files. The list of
+# produced files is stored into OUTPUT_VAR.
+#
+# qoi_images(Tgt OUTPUT_VAR Var SOURCES images/a.png ...)
+function(qoi_images Tgt)
+  cmake_parse_arguments(QOI "" "OUTPUT_VAR" "SOURCES" ${ARGN})
+
+  foreach(Src ${QOI_SOURCES})
+    string(REGEX REPLACE "\\.png$" ".qoi" Out ${Src})
+    get_filename_component(OutDir ${CMAKE_CURRENT_BINARY_DIR}/${Out} DIRECTORY)
+    add_custom_command(
+      OUTPUT ${CMAKE_CURRENT_BINARY_DIR}/${Out}
+      COMMAND ${CMAKE_COMMAND} -E make_directory ${OutDir}
+      COMMAND tools::png2qoi -i ${CMAKE_CURRENT_SOURCE_DIR}/${Src} -o ${CMAKE_CURRENT_BINARY_DIR}/${Out}
+      DEPENDS ${CMAKE_CURRENT_SOURCE_DIR}/${Src} tools::png2qoi
+    )
+    list(APPEND Outputs ${Out})
+    list(APPEND OutputPaths ${CMAKE_CURRENT_BINARY_DIR}/${Out})
+  endforeach()
+
+  add_custom_target(${Tgt}.qoi DEPENDS ${OutputPaths})
+  add_dependencies(${Tgt} ${Tgt}.qoi)
+  set(${QOI_OUTPUT_VAR} ${Outputs} PARENT_SCOPE)
+endfunction()
@@ -1,7 +1,7 @@
 find_package(Wayland REQUIRED)
 
 function(target_wl_protocol Tgt)
-  set(opts "")
+  set(opts SERVER)
   set(oneval_args NAME URL SHA256)
   set(multyval_args "")
   cmake_parse_arguments(WL_PROTOCOL
@@ -14,6 +14,10 @@ function(target_wl_protocol Tgt)
   set(_OUT_XML ${CMAKE_CURRENT_BINARY_DIR}/${WL_PROTOCOL_NAME}.xml)
   set(_OUT_HDR ${CMAKE_CURRENT_BINARY_DIR}/${WL_PROTOCOL_NAME}.h)
   set(_OUT_SRC ${CMAKE_CURRENT_BINARY_DIR}/${WL_PROTOCOL_NAME}.c)
+  set(_OUT_SERVER_HDR ${CMAKE_CURRENT_BINARY_DIR}/${WL_PROTOCOL_NAME}-server.h)
+  if (NOT WL_PROTOCOL_SHA256)
+    message(FATAL_ERROR "SHA256 of ${WL_PROTOCOL_NAME} protocol is required")
+  endif()
   file(DOWNLOAD
     ${WL_PROTOCOL_URL} ${_OUT_XML}
     EXPECTED_HASH SHA256=${WL_PROTOCOL_SHA256}
@@ -33,5 +37,13 @@ function(target_wl_protocol Tgt)
     ${_OUT_SRC}
     ${_OUT_HDR}
   )
+  if (WL_PROTOCOL_SERVER)
+    add_custom_command(OUTPUT ${_OUT_SERVER_HDR}
+      COMMAND Wayland::scanner server-header ${_OUT_XML} ${_OUT_SERVER_HDR}
+      DEPENDS ${_OUT_XML}
+    )
+    set_source_files_properties(${_OUT_SERVER_HDR} PROPERTIES GENERATED ON)
+    target_sources(${Tgt} PRIVATE ${_OUT_SERVER_HDR})
+  endif()
   target_include_directories(${Tgt} PUBLIC ${CMAKE_CURRENT_BINARY_DIR})
 endfunction()
@@ -1,13 +1,28 @@
 find_program(ZIP NAMES zip REQUIRED)
 
+# Appends files to the target binary as zip archive. Files are given relative
+# to the current source dir except those listed after GENERATED which are
+# taken relative to the current binary dir.
 function(zip_sfx Tgt)
+    cmake_parse_arguments(SFX "" "" "GENERATED" ${ARGN})
+    set(Sources ${SFX_UNPARSED_ARGUMENTS})
+    if (Sources)
+      set(ZipSources COMMAND ${ZIP} -0 "${CMAKE_CURRENT_BINARY_DIR}/tmp.zip" ${Sources})
+    endif()
+    if (SFX_GENERATED)
+      set(ZipGenerated
+        COMMAND ${CMAKE_COMMAND} -E chdir "${CMAKE_CURRENT_BINARY_DIR}"
+          ${ZIP} -0 "${CMAKE_CURRENT_BINARY_DIR}/tmp.zip" ${SFX_GENERATED}
+      )
+    endif()
     add_custom_command(TARGET ${Tgt} POST_BUILD
       COMMAND ${CMAKE_COMMAND} -E rm -f "${CMAKE_CURRENT_BINARY_DIR}/tmp.zip"
-      COMMAND ${ZIP} -0 "${CMAKE_CURRENT_BINARY_DIR}/tmp.zip" ${ARGN}
+      ${ZipSources}
+      ${ZipGenerated}
       COMMAND ${CMAKE_COMMAND} -E cat "${CMAKE_CURRENT_BINARY_DIR}/tmp.zip" >> "$<TARGET_FILE:${Tgt}>"
       COMMAND ${ZIP} -A "$<TARGET_FILE:${Tgt}>"
       WORKING_DIRECTORY ${CMAKE_CURRENT_SOURCE_DIR}
     )
-target_sources(${Tgt} PRIVATE ${ARGN})
-set_property(SOURCE ${ARGN} PROPERTY HEADER_FILE_ONLY On)
+target_sources(${Tgt} PRIVATE ${Sources})
+set_property(SOURCE ${Sources} PROPERTY HEADER_FILE_ONLY On)
 endfunction()
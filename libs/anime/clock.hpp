@@ -2,8 +2,9 @@
 
 #include <chrono>
 
+// Epoch is unspecified and depends on the source of frame timestamps
 struct frames_clock {
-  using duration = std::chrono::milliseconds;
+  using duration = std::chrono::nanoseconds;
   using rep = duration::rep;
   using period = duration::period;
   using time_point = std::chrono::time_point<frames_clock, duration>;
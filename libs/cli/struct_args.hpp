@@ -21,6 +21,7 @@ struct option_info {
 struct parser_iface {
   virtual const char* get_option(const option_info& opt) = 0;
   virtual const char* get_required_option(const option_info& opt) = 0;
+  virtual bool get_flag(const option_info& opt) = 0;
 };
 
 parser_iface* current_parser = nullptr;
@@ -45,6 +46,12 @@ public:
     return val;
   }
 
+  bool get_flag(const option_info& opt) override {
+    const bool long_found = ::get_flag(args_, opt.long_name);
+    const bool short_found = !opt.short_name.empty() && ::get_flag(args_, opt.short_name);
+    return long_found || short_found;
+  }
+
 private:
   std::span<char*> args_;
   std::vector<std::string_view> missing_opts_;
@@ -62,6 +69,12 @@ public:
 
   const char* get_required_option(const option_info& opt) override { return get_option(opt); }
 
+  bool get_flag(const option_info& opt) override {
+    out_ << '\t' << opt.long_name << (opt.short_name.empty() ? "" : ", ") << opt.short_name << '\t'
+         << opt.description << '\n';
+    return false;
+  }
+
 private:
   std::ostream& out_;
 };
@@ -78,6 +91,10 @@ public:
     out_ << ' ' << (opt.short_name.empty() ? opt.long_name : opt.short_name) << " VAL";
     return nullptr;
   }
+  bool get_flag(const option_info& opt) override {
+    out_ << " [" << (opt.short_name.empty() ? opt.long_name : opt.short_name) << ']';
+    return false;
+  }
 
 private:
   std::ostream& out_;
@@ -122,6 +139,18 @@ private:
   std::optional<T> default_;
 };
 
+/// Option without value which is either present or not.
+class flag : private detail::option_info {
+public:
+  flag(const char* long_name, const char* description)
+      : detail::option_info{.long_name = long_name, .short_name = {}, .description = description} {}
+
+  flag(const char* short_name, const char* long_name, const char* description)
+      : detail::option_info{.long_name = long_name, .short_name = short_name, .description = description} {}
+
+  operator bool() const { return detail::current_parser->get_flag(*this); }
+};
+
 template <typename T>
 T parse(std::span<char*> args) {
   detail::arguments_parser p{args};
@@ -39,6 +39,7 @@ SCENARIO("parse CLI options") {
           args::option<std::string_view>{"-j", "--threads", "Number of threads to use"}.default_value("8");
       std::vector<std::string_view> incdirs =
           args::option<std::vector<std::string_view>>("-I", "--include", "include directories");
+      bool verbose = args::flag{"-v", "--verbose", "Print more details"};
     };
 
     WHEN("args with all required options are parsed") {
@@ -50,6 +51,24 @@ SCENARIO("parse CLI options") {
       THEN("threads is set to default value") { REQUIRE(opt.threads == "8"); }
 
       THEN("include dirs list is empty") { REQUIRE_THAT(opt.incdirs, IsEmpty()); }
+
+      THEN("flag is not set") { REQUIRE(!opt.verbose); }
+    }
+
+    WHEN("flag is passed among other options") {
+      cli_args argv{{"--name", "Vasja", "--verbose", "-j", "32"}};
+      auto opt = args::parse<opts>(argv);
+
+      THEN("flag is set") { REQUIRE(opt.verbose); }
+
+      THEN("options after the flag are parsed") { REQUIRE(opt.threads == "32"); }
+    }
+
+    WHEN("flag is passed with its short name") {
+      cli_args argv{{"-v", "--name", "Vasja"}};
+      auto opt = args::parse<opts>(argv);
+
+      THEN("flag is set") { REQUIRE(opt.verbose); }
     }
 
     WHEN("optional arg is passed") {
@@ -86,6 +105,7 @@ SCENARIO("parse CLI options") {
             out.str() == "\t--name VAL\tUser name\n"
                          "\t--threads, -j VAL\tNumber of threads to use\n"
                          "\t--include, -I VAL\tinclude directories\n"
+                         "\t--verbose, -v\tPrint more details\n"
         );
       }
     }
@@ -95,7 +115,7 @@ SCENARIO("parse CLI options") {
       args::usage<opts>("prog_name", out);
 
       THEN("all members are listed") {
-        REQUIRE(out.str() == "Usage: prog_name --name VAL [-j VAL] [-I VAL]\n");
+        REQUIRE(out.str() == "Usage: prog_name --name VAL [-j VAL] [-I VAL] [-v]\n");
       }
     }
   }
@@ -99,25 +99,30 @@ private:
   EGLContext ctx_ = EGL_NO_CONTEXT;
 };
 
+/// Window surface drawn with the context it is created from. The context is
+/// not owned and may be shared by several surfaces.
 class surface {
 public:
   surface() noexcept = default;
   surface(const surface&) = delete;
-  surface& operator=(const display&) = delete;
+  surface& operator=(const surface&) = delete;
 
-  surface(context ctx) : ctx_{std::move(ctx)} {}
+  explicit surface(const context& ctx)
+      : disp_{ctx.get_display()}, cfg_{ctx.get_config()}, ctx_{ctx.native_handle()} {}
   ~surface() {
     if (surf_ != EGL_NO_SURFACE)
-      eglDestroySurface(ctx_.get_display(), surf_);
+      eglDestroySurface(disp_, surf_);
   }
 
   surface(surface&& rhs) noexcept
-      : ctx_(std::move(rhs.ctx_)), surf_(std::exchange(rhs.surf_, EGL_NO_SURFACE)) {}
+      : disp_{rhs.disp_}, cfg_{rhs.cfg_}, ctx_{rhs.ctx_}, surf_(std::exchange(rhs.surf_, EGL_NO_SURFACE)) {}
 
   surface& operator=(surface&& rhs) noexcept {
     if (surf_ != EGL_NO_SURFACE)
-      eglDestroySurface(ctx_.get_display(), surf_);
-    ctx_ = std::move(rhs.ctx_);
+      eglDestroySurface(disp_, surf_);
+    disp_ = rhs.disp_;
+    cfg_ = rhs.cfg_;
+    ctx_ = rhs.ctx_;
     surf_ = std::exchange(rhs.surf_, EGL_NO_SURFACE);
     return *this;
   }
@@ -129,30 +134,41 @@ public:
 
   void set_window(wl_egl_window& wnd) {
     if (surf_ != EGL_NO_SURFACE)
-      eglDestroySurface(ctx_.get_display(), surf_);
-    surf_ = eglCreateWindowSurface(ctx_.get_display(), ctx_.get_config(), &wnd, nullptr);
+      eglDestroySurface(disp_, surf_);
+    surf_ = eglCreateWindowSurface(disp_, cfg_, &wnd, nullptr);
     if (surf_ == EGL_NO_SURFACE)
       throw std::system_error{eglGetError(), category(), "eglCreateWindowSurface"};
   }
 
   void make_current() {
-    if (eglMakeCurrent(ctx_.get_display(), surf_, surf_, ctx_.native_handle()) == EGL_FALSE)
+    if (eglMakeCurrent(disp_, surf_, surf_, ctx_) == EGL_FALSE)
       throw std::system_error{eglGetError(), category(), "eglMakeCurrent"};
   }
 
-  void release_thread() {
-    if (eglReleaseThread() == EGL_FALSE)
-      throw std::system_error{eglGetError(), category(), "eglReleaseThread"};
+  /// Number of retraces eglSwapBuffers waits for. Applies to the current
+  /// surface so it must be called after `make_current`.
+  void set_swap_interval(EGLint interval) {
+    if (eglSwapInterval(disp_, interval) == EGL_FALSE)
+      throw std::system_error{eglGetError(), category(), "eglSwapInterval"};
   }
 
   void swap_buffers() {
-    if (eglSwapBuffers(ctx_.get_display(), surf_) == EGL_FALSE)
+    if (eglSwapBuffers(disp_, surf_) == EGL_FALSE)
       throw std::system_error{eglGetError(), category(), "eglSwapBuffers"};
   }
 
 private:
-  context ctx_;
+  EGLDisplay disp_ = EGL_NO_DISPLAY;
+  EGLConfig cfg_ = nullptr;
+  EGLContext ctx_ = EGL_NO_CONTEXT;
   EGLSurface surf_ = EGL_NO_SURFACE;
 };
 
+/// Releases the context current on the calling thread along with all the
+/// per thread EGL state.
+inline void release_thread() {
+  if (eglReleaseThread() == EGL_FALSE)
+    throw std::system_error{eglGetError(), category(), "eglReleaseThread"};
+}
+
 } // namespace egl
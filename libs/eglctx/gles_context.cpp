@@ -24,20 +24,24 @@ egl::context make_egl_context(wl_display& display) {
   if (eglChooseConfig(egl_display.native_handle(), cfg_attr, &cfg, 1, &count) == EGL_FALSE)
     throw std::system_error{eglGetError(), egl::category(), "eglChooseConfig"};
 
-  eglSwapInterval(egl_display.native_handle(), 0);
   return egl::context{std::move(egl_display), cfg};
 }
 
 } // namespace
 
-gles_context::gles_context(wl_display& display, wl_surface& surf, size sz)
-    : egl_surface_(make_egl_context(display)), egl_wnd_{wl_egl_window_create(&surf, sz.width, sz.height)} {
+gles_device::gles_device(wl_display& display) : ctx_{make_egl_context(display)} {}
+
+gles_device::~gles_device() noexcept { egl::release_thread(); }
+
+gles_context::gles_context(const gles_device& device, wl_surface& surf, size sz)
+    : egl_surface_{device.context()}, egl_wnd_{wl_egl_window_create(&surf, sz.width, sz.height)} {
   egl_surface_.set_window(*egl_wnd_);
   egl_surface_.make_current();
+  // Frames are paced by the frame callbacks and the scheduler, the driver
+  // must not block swaps until the next retrace
+  egl_surface_.set_swap_interval(0);
 }
 
-gles_context::~gles_context() noexcept { egl_surface_.release_thread(); }
-
 [[nodiscard]] size gles_context::get_size() const noexcept {
   size sz;
   wl_egl_window_get_attached_size(egl_wnd_.get(), &sz.width, &sz.height);
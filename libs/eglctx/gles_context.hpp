@@ -1,18 +1,33 @@
 #pragma once
 
+#include <memory>
+#include <optional>
+
 #include <spdlog/spdlog.h>
 
 #include <libs/eglctx/egl.hpp>
-#include <libs/sync/channel.hpp>
 
 #include <libs/wlwnd/renderer.hpp>
-#include <libs/wlwnd/vsync_frames.hpp>
 #include <libs/wlwnd/wlutil.hpp>
 
+/// EGL context shared by all the windows drawn on the same render thread.
+class gles_device {
+public:
+  explicit gles_device(wl_display& display);
+  ~gles_device() noexcept;
+
+  gles_device(const gles_device&) = delete;
+  gles_device& operator=(const gles_device&) = delete;
+
+  const egl::context& context() const noexcept { return ctx_; }
+
+private:
+  egl::context ctx_;
+};
+
 class gles_context {
 public:
-  gles_context(wl_display& display, wl_surface& surf, size sz);
-  ~gles_context() noexcept;
+  gles_context(const gles_device& device, wl_surface& surf, size sz);
 
   gles_context(const gles_context&) = delete;
   gles_context& operator=(const gles_context&) = delete;
@@ -28,28 +43,43 @@ private:
   wl::unique_ptr<wl_egl_window> egl_wnd_;
 };
 
+/// Draws a window with the device context shared with other windows. The
+/// context is made current with the window surface before each frame.
+template <renderer Renderer>
+class gles_window_renderer final : public window_renderer {
+public:
+  template <typename... A>
+  gles_window_renderer(const render_target& target, A&&... a)
+      : ctx_{target.resources.get<gles_device>(target.display), target.surface, target.size} {
+    spdlog::debug("OpenGL ES2 surface created");
+    // Show the window before the renderer is ready
+    ctx_.egl_surface().swap_buffers();
+    render_.emplace(std::forward<A>(a)...);
+    render_->resize(ctx_.get_size());
+  }
+
+  void resize(size sz) override {
+    ctx_.egl_surface().make_current();
+    ctx_.resize(sz);
+    render_->resize(sz);
+  }
+
+  bool draw(frames_clock::time_point frame_time) override {
+    ctx_.egl_surface().make_current();
+    render_->draw(frame_time);
+    ctx_.egl_surface().swap_buffers();
+    return true;
+  }
+
+private:
+  gles_context ctx_;
+  std::optional<Renderer> render_;
+};
+
 template <renderer Renderer, typename... A>
   requires std::constructible_from<Renderer, A...>
 animation_function make_gles_animation_function(A&&... a) {
-  return [... args = std::forward<A>(a
-          )](wl_display& display, wl_surface& surf, vsync_frames& frames,
-             value_update_channel<size>& resize_channel) mutable {
-    gles_context ctx(display, surf, resize_channel.get_current());
-    spdlog::debug("OpenGL ES2 context created");
-
-    ctx.egl_surface().swap_buffers();
-    Renderer render{std::move(args)...};
-    render.resize(ctx.get_size());
-
-    for (auto frame_time : frames) {
-      if (const auto sz = resize_channel.get_update()) {
-        ctx.resize(sz.value());
-        render.resize(sz.value());
-      }
-
-      render.draw(frame_time);
-      ctx.egl_surface().swap_buffers();
-    }
-    spdlog::debug("rendering finished");
+  return [... args = std::forward<A>(a)](const render_target& target) mutable {
+    return std::make_unique<gles_window_renderer<Renderer>>(target, std::move(args)...);
   };
 }
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <span>
+#include <vector>
+
+#include <libs/geom/geom.hpp>
+
+/// Set of rectangles changed since some point in time. Rectangles may overlap
+/// so the region only guarantees that every added pixel is covered.
+class damage_region {
+public:
+  void add(const rect& r) {
+    if (!::empty(r))
+      rects_.push_back(r);
+  }
+
+  void add(const damage_region& other) {
+    rects_.insert(rects_.end(), other.rects_.begin(), other.rects_.end());
+  }
+
+  /// Removes pixels of `r` from the region splitting rectangles partially
+  /// covered by it into up to four pieces.
+  void subtract(const rect& r) {
+    std::vector<rect> res;
+    res.reserve(rects_.size());
+    for (const rect& cur : rects_) {
+      const rect common = intersection(cur, r);
+      if (::empty(common)) {
+        res.push_back(cur);
+        continue;
+      }
+      const int32_t cur_bottom = cur.y + cur.height;
+      const int32_t common_bottom = common.y + common.height;
+      const int32_t common_right = common.x + common.width;
+      const int32_t cur_right = cur.x + cur.width;
+      const rect pieces[] = {
+          {.x = cur.x, .y = cur.y, .width = cur.width, .height = common.y - cur.y},
+          {.x = cur.x, .y = common.y, .width = common.x - cur.x, .height = common.height},
+          {.x = common_right, .y = common.y, .width = cur_right - common_right, .height = common.height},
+          {.x = cur.x, .y = common_bottom, .width = cur.width, .height = cur_bottom - common_bottom},
+      };
+      std::ranges::copy_if(pieces, std::back_inserter(res), [](const rect& piece) {
+        return !::empty(piece);
+      });
+    }
+    rects_ = std::move(res);
+  }
+
+  /// Replaces the region with its bounding box once it consists of more than
+  /// `max_rects` rectangles. Keeps the list sent to the compositor short at
+  /// the cost of covering some unchanged pixels.
+  void simplify(size_t max_rects) {
+    if (rects_.size() <= max_rects)
+      return;
+    rect box;
+    for (const rect& r : rects_)
+      box = bounding_box(box, r);
+    rects_.assign(1, box);
+  }
+
+  void clear() noexcept { rects_.clear(); }
+
+  bool empty() const noexcept { return rects_.empty(); }
+  std::span<const rect> rects() const noexcept { return rects_; }
+
+private:
+  std::vector<rect> rects_;
+};
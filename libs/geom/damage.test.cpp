@@ -0,0 +1,140 @@
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <libs/geom/damage.hpp>
+
+namespace {
+
+// Counts how many rectangles of the region cover each pixel of the area
+std::vector<int> coverage(const damage_region& region, size area) {
+  std::vector<int> res(area.width * area.height);
+  for (const rect& r : region.rects()) {
+    for (int32_t y = r.y; y < r.y + r.height; ++y) {
+      for (int32_t x = r.x; x < r.x + r.width; ++x)
+        ++res[y * area.width + x];
+    }
+  }
+  return res;
+}
+
+bool inside(const rect& r, int32_t x, int32_t y) {
+  return x >= r.x && x < r.x + r.width && y >= r.y && y < r.y + r.height;
+}
+
+} // namespace
+
+SCENARIO("Damage region manipulations") {
+  constexpr size area{.width = 16, .height = 12};
+
+  GIVEN("empty region") {
+    damage_region region;
+
+    WHEN("empty rectangles are added") {
+      region.add(rect{.x = 3, .y = 4, .width = 0, .height = 5});
+      region.add(rect{.x = 3, .y = 4, .width = 5, .height = -1});
+
+      THEN("region stays empty") { CHECK(region.empty()); }
+    }
+  }
+
+  GIVEN("region of a single rectangle") {
+    damage_region region;
+    const rect damaged{.x = 2, .y = 3, .width = 10, .height = 6};
+    region.add(damaged);
+
+    WHEN("rectangle inside of it is subtracted") {
+      const rect hole{.x = 4, .y = 5, .width = 3, .height = 2};
+      region.subtract(hole);
+
+      THEN("remaining pixels are covered exactly once") {
+        const auto cover = coverage(region, area);
+        for (int32_t y = 0; y < area.height; ++y) {
+          for (int32_t x = 0; x < area.width; ++x)
+            CHECK(cover[y * area.width + x] == (inside(damaged, x, y) && !inside(hole, x, y) ? 1 : 0));
+        }
+      }
+    }
+
+    WHEN("rectangle overlapping its corner is subtracted") {
+      const rect cut{.x = 8, .y = 0, .width = 8, .height = 5};
+      region.subtract(cut);
+
+      THEN("remaining pixels are covered exactly once") {
+        const auto cover = coverage(region, area);
+        for (int32_t y = 0; y < area.height; ++y) {
+          for (int32_t x = 0; x < area.width; ++x)
+            CHECK(cover[y * area.width + x] == (inside(damaged, x, y) && !inside(cut, x, y) ? 1 : 0));
+        }
+      }
+    }
+
+    WHEN("rectangle covering it is subtracted") {
+      region.subtract(rect{.x = 0, .y = 0, .width = area.width, .height = area.height});
+
+      THEN("region becomes empty") { CHECK(region.empty()); }
+    }
+
+    WHEN("distant rectangle is subtracted") {
+      region.subtract(rect{.x = 13, .y = 0, .width = 3, .height = 3});
+
+      THEN("region is left intact") {
+        REQUIRE(region.rects().size() == 1);
+        CHECK(region.rects()[0] == damaged);
+      }
+    }
+  }
+
+  GIVEN("region of several rectangles") {
+    damage_region region;
+    region.add(rect{.x = 1, .y = 1, .width = 2, .height = 2});
+    region.add(rect{.x = 10, .y = 4, .width = 3, .height = 1});
+    region.add(rect{.x = 5, .y = 8, .width = 1, .height = 3});
+
+    WHEN("it is simplified to fewer rectangles") {
+      region.simplify(2);
+
+      THEN("it is replaced with the bounding box") {
+        REQUIRE(region.rects().size() == 1);
+        CHECK(region.rects()[0] == rect{.x = 1, .y = 1, .width = 12, .height = 10});
+      }
+    }
+
+    WHEN("it is simplified to the same number of rectangles") {
+      region.simplify(3);
+
+      THEN("it is left intact") { CHECK(region.rects().size() == 3); }
+    }
+  }
+}
+
+SCENARIO("Rectangle helpers") {
+  GIVEN("two overlapping rectangles") {
+    constexpr rect lhs{.x = 0, .y = 0, .width = 4, .height = 4};
+    constexpr rect rhs{.x = 2, .y = 1, .width = 4, .height = 4};
+
+    THEN("intersection is their common part") {
+      CHECK(intersection(lhs, rhs) == rect{.x = 2, .y = 1, .width = 2, .height = 3});
+    }
+    THEN("bounding box covers both") {
+      CHECK(bounding_box(lhs, rhs) == rect{.x = 0, .y = 0, .width = 6, .height = 5});
+    }
+  }
+
+  GIVEN("two rectangles touching each other") {
+    constexpr rect lhs{.x = 0, .y = 0, .width = 4, .height = 4};
+    constexpr rect rhs{.x = 4, .y = 0, .width = 4, .height = 4};
+
+    THEN("their intersection is empty") { CHECK(empty(intersection(lhs, rhs))); }
+  }
+
+  GIVEN("empty rectangle far away from a non empty one") {
+    constexpr rect lhs{.x = 100, .y = 100, .width = 0, .height = 7};
+    constexpr rect rhs{.x = 1, .y = 2, .width = 3, .height = 4};
+
+    THEN("it doesn't extend the bounding box") {
+      CHECK(bounding_box(lhs, rhs) == rhs);
+      CHECK(bounding_box(rhs, lhs) == rhs);
+    }
+  }
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
 
 template <typename T>
@@ -14,3 +15,51 @@ constexpr bool operator==(basic_size<T> lhs, basic_size<T> rhs) noexcept {
 }
 
 using size = basic_size<int32_t>;
+
+template <typename T>
+struct basic_rect {
+  T x = {};
+  T y = {};
+  T width = {};
+  T height = {};
+};
+
+template <typename T>
+constexpr bool operator==(const basic_rect<T>& lhs, const basic_rect<T>& rhs) noexcept {
+  return lhs.x == rhs.x && lhs.y == rhs.y && lhs.width == rhs.width && lhs.height == rhs.height;
+}
+
+/// Rectangles of zero or negative size hold no points wherever they are.
+template <typename T>
+constexpr bool empty(const basic_rect<T>& r) noexcept {
+  return r.width <= 0 || r.height <= 0;
+}
+
+/// Common part of two rectangles. Rectangles which only touch each other or
+/// do not overlap at all give an empty value initialized rectangle.
+template <typename T>
+constexpr basic_rect<T> intersection(const basic_rect<T>& lhs, const basic_rect<T>& rhs) noexcept {
+  const T x = std::max(lhs.x, rhs.x);
+  const T y = std::max(lhs.y, rhs.y);
+  const T right = std::min(lhs.x + lhs.width, rhs.x + rhs.width);
+  const T bottom = std::min(lhs.y + lhs.height, rhs.y + rhs.height);
+  if (right <= x || bottom <= y)
+    return {};
+  return {.x = x, .y = y, .width = right - x, .height = bottom - y};
+}
+
+/// Smallest rectangle covering both. Empty rectangles are ignored.
+template <typename T>
+constexpr basic_rect<T> bounding_box(const basic_rect<T>& lhs, const basic_rect<T>& rhs) noexcept {
+  if (empty(lhs))
+    return rhs;
+  if (empty(rhs))
+    return lhs;
+  const T x = std::min(lhs.x, rhs.x);
+  const T y = std::min(lhs.y, rhs.y);
+  const T right = std::max(lhs.x + lhs.width, rhs.x + rhs.width);
+  const T bottom = std::max(lhs.y + lhs.height, rhs.y + rhs.height);
+  return {.x = x, .y = y, .width = right - x, .height = bottom - y};
+}
+
+using rect = basic_rect<int32_t>;
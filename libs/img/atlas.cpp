@@ -0,0 +1,144 @@
+#include "atlas.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+
+#include <libs/img/convert.hpp>
+
+namespace img {
+
+namespace {
+
+constexpr size_t rgba_size = pixel_byte_size(pixel_fmt::rgba);
+
+// Copies sprite into its place in the atlas base level replicating edge
+// pixels into the padding around it.
+void blit_with_bleed(
+    const any_image& sprite, rect area, int32_t padding, std::span<std::byte> dest, ::size sz
+) {
+  const size_t dest_stride = rgba_size * sz.width;
+  const size_t src_stride = pixel_byte_size(sprite.format()) * area.width;
+  std::vector<std::byte> row(rgba_size * area.width);
+  for (int32_t y = 0; y < area.height; ++y) {
+    const auto src_row = sprite.bytes().subspan(y * src_stride, src_stride);
+    if (sprite.format() == pixel_fmt::rgba)
+      std::ranges::copy(src_row, row.begin());
+    else
+      rgb_to_rgba(src_row, row);
+
+    const int32_t first = y == 0 ? -padding : y;
+    const int32_t last = y == area.height - 1 ? y + padding : y;
+    for (int32_t dest_y = first; dest_y <= last; ++dest_y) {
+      std::byte* out = dest.data() + (area.y + dest_y) * dest_stride + (area.x - padding) * rgba_size;
+      for (int32_t i = 0; i < padding; ++i, out += rgba_size)
+        std::memcpy(out, row.data(), rgba_size);
+      out = std::ranges::copy(row, out).out;
+      for (int32_t i = 0; i < padding; ++i, out += rgba_size)
+        std::memcpy(out, row.data() + row.size() - rgba_size, rgba_size);
+    }
+  }
+}
+
+} // namespace
+
+skyline_packer::skyline_packer(int32_t width) : width_{width} {
+  skyline_.push_back({.x = 0, .y = 0, .width = width});
+}
+
+std::optional<rect> skyline_packer::pack(::size sz) {
+  if (sz.width <= 0 || sz.height <= 0 || sz.width > width_)
+    return std::nullopt;
+
+  size_t best = skyline_.size();
+  rect res{.x = 0, .y = 0, .width = sz.width, .height = sz.height};
+  for (size_t i = 0; i < skyline_.size() && skyline_[i].x + sz.width <= width_; ++i) {
+    // Rectangle lies on the highest of the segments it spans
+    int32_t y = 0;
+    for (size_t j = i; j < skyline_.size() && skyline_[j].x < skyline_[i].x + sz.width; ++j)
+      y = std::max(y, skyline_[j].y);
+    if (best == skyline_.size() || y < res.y) {
+      best = i;
+      res.x = skyline_[i].x;
+      res.y = y;
+    }
+  }
+
+  skyline_.insert(skyline_.begin() + best, {.x = res.x, .y = res.y + res.height, .width = res.width});
+  const int32_t right = res.x + res.width;
+  for (auto it = skyline_.begin() + best + 1; it != skyline_.end() && it->x < right;) {
+    const int32_t shadowed = std::min(right - it->x, it->width);
+    it->x += shadowed;
+    it->width -= shadowed;
+    it = it->width == 0 ? skyline_.erase(it) : std::next(it);
+  }
+  for (auto it = skyline_.begin(); std::next(it) != skyline_.end();) {
+    if (it->y == std::next(it)->y) {
+      it->width += std::next(it)->width;
+      skyline_.erase(std::next(it));
+    } else
+      ++it;
+  }
+
+  height_ = std::max(height_, res.y + res.height);
+  return res;
+}
+
+atlas atlas::build(std::span<const any_image> sprites, int32_t padding) {
+  if (sprites.empty())
+    throw std::runtime_error{"Can't build an empty atlas"};
+
+  int64_t area = 0;
+  int32_t widest = 0;
+  for (const auto& sprite : sprites) {
+    if (sprite.format() != pixel_fmt::rgb && sprite.format() != pixel_fmt::rgba)
+      throw std::runtime_error{"Only RGB and RGBA images can be packed into an atlas"};
+    const int64_t width = sprite.size().width + 2 * padding;
+    area += width * (sprite.size().height + 2 * padding);
+    widest = std::max<int32_t>(widest, width);
+  }
+  // Square-ish atlas limits both dimensions for the price of some unused space
+  const auto side = static_cast<int32_t>(std::bit_ceil(static_cast<uint64_t>(std::ceil(std::sqrt(area)))));
+  skyline_packer packer{std::max(widest, side)};
+
+  // Packing the tallest sprites first keeps the skyline flat
+  std::vector<size_t> order(sprites.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::ranges::stable_sort(order, std::greater<>{}, [&](size_t idx) { return sprites[idx].size().height; });
+
+  atlas res;
+  res.sprites_.resize(sprites.size());
+  for (size_t idx : order) {
+    const ::size sz = sprites[idx].size();
+    const auto pos = packer.pack({.width = sz.width + 2 * padding, .height = sz.height + 2 * padding});
+    if (!pos)
+      throw std::runtime_error{"Empty sprites without padding can't be packed into an atlas"};
+    res.sprites_[idx] = {
+        .x = pos->x + padding, .y = pos->y + padding, .width = sz.width, .height = sz.height
+    };
+  }
+
+  // Mip level N has padding shrunk 2^N times and should still separate sprites
+  const ::size sz{.width = packer.width(), .height = packer.height()};
+  res.texture_ = mip_chain{sz, static_cast<uint32_t>(std::bit_width(static_cast<unsigned>(padding)))};
+  std::ranges::fill(res.texture_.level(0), std::byte{0});
+  for (size_t idx = 0; idx < sprites.size(); ++idx)
+    blit_with_bleed(sprites[idx], res.sprites_[idx], padding, res.texture_.level(0), sz);
+  return res;
+}
+
+basic_rect<float> atlas::uv_rect(size_t idx) const noexcept {
+  const ::size sz = size();
+  const rect px = sprites_[idx];
+  return {
+      .x = static_cast<float>(px.x) / sz.width,
+      .y = static_cast<float>(px.y) / sz.height,
+      .width = static_cast<float>(px.width) / sz.width,
+      .height = static_cast<float>(px.height) / sz.height
+  };
+}
+
+} // namespace img
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <libs/geom/geom.hpp>
+#include <libs/img/load.hpp>
+#include <libs/img/mipmap.hpp>
+
+namespace img {
+
+/// Skyline bottom-left packer. Rectangles are placed into a bin of fixed
+/// width as low as possible keeping the bin height growing on demand.
+class skyline_packer {
+public:
+  explicit skyline_packer(int32_t width);
+
+  /// Returns position of the packed rectangle or nothing if it is wider than
+  /// the bin.
+  std::optional<rect> pack(::size sz);
+
+  int32_t width() const noexcept { return width_; }
+  int32_t height() const noexcept { return height_; }
+
+private:
+  struct segment {
+    int32_t x;
+    int32_t y;
+    int32_t width;
+  };
+
+private:
+  int32_t width_;
+  int32_t height_ = 0;
+  std::vector<segment> skyline_;
+};
+
+/// Many images packed into a single RGBA texture. Each sprite is surrounded
+/// with `padding` pixels repeating its edges so that filtering never picks up
+/// neighbour sprites. The padding also limits the number of mip levels which
+/// are kept separated.
+class atlas {
+public:
+  atlas() noexcept = default;
+
+  /// Packs RGB or RGBA images filling the base level of the texture. Call
+  /// `generate_mips` on `texture()` to fill other levels.
+  static atlas build(std::span<const any_image> sprites, int32_t padding = 8);
+
+  ::size size() const noexcept { return texture_.level_size(0); }
+  size_t sprites_count() const noexcept { return sprites_.size(); }
+
+  /// Sprite area in pixels of the base level excluding padding.
+  rect sprite(size_t idx) const noexcept { return sprites_[idx]; }
+  /// Sprite area in normalized texture coordinates.
+  basic_rect<float> uv_rect(size_t idx) const noexcept;
+
+  const mip_chain& texture() const noexcept { return texture_; }
+  mip_chain& texture() noexcept { return texture_; }
+
+private:
+  mip_chain texture_;
+  std::vector<rect> sprites_;
+};
+
+} // namespace img
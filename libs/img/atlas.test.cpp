@@ -0,0 +1,136 @@
+#include "atlas.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+
+bool overlap(rect lhs, rect rhs) noexcept {
+  return lhs.x < rhs.x + rhs.width && rhs.x < lhs.x + lhs.width && lhs.y < rhs.y + rhs.height &&
+         rhs.y < lhs.y + lhs.height;
+}
+
+img::any_image make_solid(size sz, img::pixel_fmt fmt, std::byte val) {
+  const size_t bytes = img::bytes_size(sz, fmt);
+  std::unique_ptr<std::byte[]> data{new std::byte[bytes]};
+  std::fill_n(data.get(), bytes, val);
+  return img::any_image{std::move(data), sz, fmt};
+}
+
+std::span<const std::byte> pixel(const img::atlas& atlas, int32_t x, int32_t y) {
+  return atlas.texture().level(0).subspan((y * atlas.size().width + x) * 4, 4);
+}
+
+} // namespace
+
+SCENARIO("Skyline packing") {
+  GIVEN("packer of fixed width") {
+    img::skyline_packer packer{64};
+
+    WHEN("rectangles of different sizes are packed") {
+      const size sizes[] = {{30, 20}, {34, 10}, {20, 20}, {40, 5}, {64, 3}, {10, 30}, {7, 7}, {7, 7}};
+      std::vector<rect> packed;
+      for (size sz : sizes)
+        packed.push_back(packer.pack(sz).value());
+
+      THEN("they are inside of the bin") {
+        for (rect r : packed) {
+          CHECK(r.x >= 0);
+          CHECK(r.y >= 0);
+          CHECK(r.x + r.width <= packer.width());
+          CHECK(r.y + r.height <= packer.height());
+        }
+      }
+
+      THEN("they do not overlap") {
+        for (size_t i = 0; i < packed.size(); ++i) {
+          for (size_t j = i + 1; j < packed.size(); ++j) {
+            INFO("rects " << i << " and " << j);
+            CHECK_FALSE(overlap(packed[i], packed[j]));
+          }
+        }
+      }
+
+      THEN("first rectangles share the bottom line") {
+        CHECK(packed[0] == rect{.x = 0, .y = 0, .width = 30, .height = 20});
+        CHECK(packed[1] == rect{.x = 30, .y = 0, .width = 34, .height = 10});
+      }
+    }
+
+    WHEN("too wide rectangle is packed") {
+      THEN("it is rejected") { CHECK_FALSE(packer.pack({65, 1}).has_value()); }
+    }
+  }
+}
+
+SCENARIO("Atlas building") {
+  GIVEN("few solid color sprites") {
+    std::vector<img::any_image> sprites;
+    sprites.push_back(make_solid({16, 8}, img::pixel_fmt::rgba, std::byte{10}));
+    sprites.push_back(make_solid({5, 12}, img::pixel_fmt::rgb, std::byte{20}));
+    sprites.push_back(make_solid({9, 9}, img::pixel_fmt::rgba, std::byte{30}));
+    constexpr int32_t padding = 4;
+
+    WHEN("atlas is built") {
+      const auto atlas = img::atlas::build(sprites, padding);
+
+      THEN("each sprite with its padding is kept separately") {
+        REQUIRE(atlas.sprites_count() == sprites.size());
+        for (size_t i = 0; i < sprites.size(); ++i) {
+          const rect r = atlas.sprite(i);
+          CHECK(r.width == sprites[i].size().width);
+          CHECK(r.height == sprites[i].size().height);
+          CHECK(r.x >= padding);
+          CHECK(r.y >= padding);
+          CHECK(r.x + r.width + padding <= atlas.size().width);
+          CHECK(r.y + r.height + padding <= atlas.size().height);
+          for (size_t j = i + 1; j < sprites.size(); ++j) {
+            const rect other = atlas.sprite(j);
+            CHECK_FALSE(overlap(
+                {r.x - padding, r.y - padding, r.width + 2 * padding, r.height + 2 * padding},
+                {other.x - padding, other.y - padding, other.width + 2 * padding, other.height + 2 * padding}
+            ));
+          }
+        }
+      }
+
+      THEN("padding repeats sprite edges") {
+        for (size_t i = 0; i < sprites.size(); ++i) {
+          const rect r = atlas.sprite(i);
+          const auto val = std::byte{static_cast<uint8_t>(10 * (i + 1))};
+          const auto corner = pixel(atlas, r.x - padding, r.y - padding);
+          CHECK(corner[0] == val);
+          const auto far_corner = pixel(atlas, r.x + r.width + padding - 1, r.y + r.height + padding - 1);
+          CHECK(far_corner[0] == val);
+        }
+      }
+
+      THEN("RGB sprites become opaque") {
+        const rect r = atlas.sprite(1);
+        CHECK(pixel(atlas, r.x, r.y)[3] == std::byte{0xff});
+      }
+
+      THEN("mip levels are limited by padding") { CHECK(atlas.texture().levels() == 3); }
+
+      THEN("UV rects are normalized sprite areas") {
+        const auto uv = atlas.uv_rect(0);
+        CHECK(uv.x * atlas.size().width == atlas.sprite(0).x);
+        CHECK(uv.width * atlas.size().width == atlas.sprite(0).width);
+      }
+    }
+  }
+
+  GIVEN("sprite of zero size") {
+    std::vector<img::any_image> sprites;
+    sprites.push_back(make_solid({16, 8}, img::pixel_fmt::rgba, std::byte{10}));
+    sprites.push_back(make_solid({0, 0}, img::pixel_fmt::rgba, std::byte{20}));
+
+    WHEN("atlas is built without padding") {
+      THEN("it is rejected") { CHECK_THROWS_AS(img::atlas::build(sprites, 0), std::runtime_error); }
+    }
+  }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <future>
+#include <ranges>
+#include <vector>
+
+#include <asio/post.hpp>
+
+#include <thinsys/io/io.hpp>
+
+#include <libs/img/load.hpp>
+#include <libs/img/mipmap.hpp>
+
+namespace img {
+
+/// Decodes image on the given executor. The stream is owned by the decoding
+/// task so it must not share file position with any other stream in use.
+template <typename Executor>
+std::future<any_image> async_load(const Executor& exec, thinsys::io::file_descriptor in) {
+  std::packaged_task<any_image()> task{[in = std::move(in)]() mutable { return load_any(in); }};
+  auto res = task.get_future();
+  asio::post(exec, std::move(task));
+  return res;
+}
+
+/// Decodes image and generates its mip chain on the given executor. Levels
+/// are additionally split into bands processed concurrently.
+template <typename Executor>
+std::future<mip_chain> async_load_mips(const Executor& exec, thinsys::io::file_descriptor in) {
+  std::packaged_task<mip_chain()> task{[exec, in = std::move(in)]() mutable {
+    auto res = mip_chain::decode(load_reader(in));
+    generate_mips(exec, res);
+    return res;
+  }};
+  auto res = task.get_future();
+  asio::post(exec, std::move(task));
+  return res;
+}
+
+/// Starts decoding of all images at once. Futures are returned in the order
+/// of sources while each of them becomes ready as soon as its own image is
+/// decoded.
+template <typename Executor, std::ranges::input_range R>
+  requires std::same_as<std::ranges::range_value_t<R>, thinsys::io::file_descriptor>
+std::vector<std::future<any_image>> async_load_all(const Executor& exec, R&& sources) {
+  std::vector<std::future<any_image>> res;
+  if constexpr (std::ranges::sized_range<R>)
+    res.reserve(std::ranges::size(sources));
+  for (auto&& in : sources)
+    res.push_back(async_load(exec, std::move(in)));
+  return res;
+}
+
+} // namespace img
@@ -0,0 +1,391 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <optional>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include <libs/img/compose.hpp>
+
+namespace img {
+
+namespace {
+
+using kernels = detail::compose_kernels;
+
+namespace scalar {
+
+void blend(const std::byte* src, std::byte* dest, size_t count, uint32_t opacity) noexcept {
+  for (size_t i = 0; i < 4 * count; i += 4) {
+    uint32_t color[4];
+    for (size_t c = 0; c < 4; ++c)
+      color[c] = (std::to_integer<uint32_t>(src[i + c]) * opacity) >> 8;
+    const uint32_t inv_alpha = 255 - color[3];
+    for (size_t c = 0; c < 4; ++c) {
+      // Rounded division by 255
+      const uint32_t prod = std::to_integer<uint32_t>(dest[i + c]) * inv_alpha + 128;
+      dest[i + c] = static_cast<std::byte>(std::min<uint32_t>(color[c] + ((prod + (prod >> 8)) >> 8), 255));
+    }
+  }
+}
+
+void sample(
+    const std::byte* pixels, ::size sz, int32_t u, int32_t v, int32_t du, int32_t dv, size_t count,
+    std::byte* out
+) noexcept {
+  const int32_t max_u = (sz.width - 1) << 16;
+  const int32_t max_v = (sz.height - 1) << 16;
+  for (size_t i = 0; i < count; ++i, u += du, v += dv, out += 4) {
+    const int32_t cu = std::clamp(u, 0, max_u);
+    const int32_t cv = std::clamp(v, 0, max_v);
+    const int32_t x0 = cu >> 16;
+    const int32_t y0 = cv >> 16;
+    const int32_t x1 = std::min(x0 + 1, sz.width - 1);
+    const int32_t y1 = std::min(y0 + 1, sz.height - 1);
+    const uint32_t wx = (cu >> 8) & 0xff;
+    const uint32_t wy = (cv >> 8) & 0xff;
+    const std::byte* p00 = pixels + 4 * (y0 * sz.width + x0);
+    const std::byte* p01 = pixels + 4 * (y0 * sz.width + x1);
+    const std::byte* p10 = pixels + 4 * (y1 * sz.width + x0);
+    const std::byte* p11 = pixels + 4 * (y1 * sz.width + x1);
+    for (size_t c = 0; c < 4; ++c) {
+      const uint32_t top =
+          std::to_integer<uint32_t>(p00[c]) * (256 - wx) + std::to_integer<uint32_t>(p01[c]) * wx;
+      const uint32_t bottom =
+          std::to_integer<uint32_t>(p10[c]) * (256 - wx) + std::to_integer<uint32_t>(p11[c]) * wx;
+      out[c] = static_cast<std::byte>((top * (256 - wy) + bottom * wy + (1 << 15)) >> 16);
+    }
+  }
+}
+
+constexpr kernels table{.isa = "scalar", .blend = blend, .sample = sample};
+
+} // namespace scalar
+
+#if defined(__x86_64__) || defined(__i386__)
+
+namespace ssse3 {
+
+[[gnu::target("ssse3")]] inline __m128i
+blend_half(__m128i src, __m128i dest, __m128i opacity, __m128i alpha_shuffle) noexcept {
+  src = _mm_srli_epi16(_mm_mullo_epi16(src, opacity), 8);
+  const __m128i inv_alpha = _mm_sub_epi16(_mm_set1_epi16(255), _mm_shuffle_epi8(src, alpha_shuffle));
+  __m128i res = _mm_add_epi16(_mm_mullo_epi16(dest, inv_alpha), _mm_set1_epi16(128));
+  res = _mm_add_epi16(res, _mm_srli_epi16(res, 8));
+  return _mm_add_epi16(src, _mm_srli_epi16(res, 8));
+}
+
+[[gnu::target("ssse3")]] void
+blend(const std::byte* src, std::byte* dest, size_t count, uint32_t opacity) noexcept {
+  // Broadcasts alpha word of each of two unpacked pixels over all its words
+  const __m128i alpha_shuffle = _mm_setr_epi8(6, 7, 6, 7, 6, 7, 6, 7, 14, 15, 14, 15, 14, 15, 14, 15);
+  const __m128i factor = _mm_set1_epi16(static_cast<int16_t>(opacity));
+  const __m128i zero = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4 * i));
+    auto* ptr = reinterpret_cast<__m128i*>(dest + 4 * i);
+    const __m128i d = _mm_loadu_si128(ptr);
+    const __m128i lo =
+        blend_half(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero), factor, alpha_shuffle);
+    const __m128i hi =
+        blend_half(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero), factor, alpha_shuffle);
+    _mm_storeu_si128(ptr, _mm_packus_epi16(lo, hi));
+  }
+  scalar::blend(src + 4 * i, dest + 4 * i, count - i, opacity);
+}
+
+// Vertical interpolation needs 32 bit multiplication missing in SSSE3
+constexpr kernels table{.isa = "ssse3", .blend = blend, .sample = scalar::sample};
+
+} // namespace ssse3
+
+namespace avx2 {
+
+[[gnu::target("avx2")]] inline __m256i
+blend_half(__m256i src, __m256i dest, __m256i opacity, __m256i alpha_shuffle) noexcept {
+  src = _mm256_srli_epi16(_mm256_mullo_epi16(src, opacity), 8);
+  const __m256i inv_alpha = _mm256_sub_epi16(_mm256_set1_epi16(255), _mm256_shuffle_epi8(src, alpha_shuffle));
+  __m256i res = _mm256_add_epi16(_mm256_mullo_epi16(dest, inv_alpha), _mm256_set1_epi16(128));
+  res = _mm256_add_epi16(res, _mm256_srli_epi16(res, 8));
+  return _mm256_add_epi16(src, _mm256_srli_epi16(res, 8));
+}
+
+[[gnu::target("avx2")]] void
+blend(const std::byte* src, std::byte* dest, size_t count, uint32_t opacity) noexcept {
+  // Unpacking and packing work within 128 bit lanes so pixels keep their
+  // order
+  const __m256i alpha_shuffle = _mm256_setr_epi8(
+      6, 7, 6, 7, 6, 7, 6, 7, 14, 15, 14, 15, 14, 15, 14, 15, //
+      6, 7, 6, 7, 6, 7, 6, 7, 14, 15, 14, 15, 14, 15, 14, 15
+  );
+  const __m256i factor = _mm256_set1_epi16(static_cast<int16_t>(opacity));
+  const __m256i zero = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 4 * i));
+    auto* ptr = reinterpret_cast<__m256i*>(dest + 4 * i);
+    const __m256i d = _mm256_loadu_si256(ptr);
+    const __m256i lo =
+        blend_half(_mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(d, zero), factor, alpha_shuffle);
+    const __m256i hi =
+        blend_half(_mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(d, zero), factor, alpha_shuffle);
+    _mm256_storeu_si256(ptr, _mm256_packus_epi16(lo, hi));
+  }
+  ssse3::blend(src + 4 * i, dest + 4 * i, count - i, opacity);
+}
+
+[[gnu::target("avx2")]] inline __m128i load_pair(const std::byte* first, const std::byte* second) noexcept {
+  int32_t lo;
+  int32_t hi;
+  std::memcpy(&lo, first, sizeof(lo));
+  std::memcpy(&hi, second, sizeof(hi));
+  return _mm_unpacklo_epi32(_mm_cvtsi32_si128(lo), _mm_cvtsi32_si128(hi));
+}
+
+[[gnu::target("avx2")]] void sample(
+    const std::byte* pixels, ::size sz, int32_t u, int32_t v, int32_t du, int32_t dv, size_t count,
+    std::byte* out
+) noexcept {
+  const int32_t max_u = (sz.width - 1) << 16;
+  const int32_t max_v = (sz.height - 1) << 16;
+  // Each 128 bit lane interpolates its own pixel. Channels of horizontal
+  // neighbours are interleaved so that madd weights both of them at once.
+  const __m256i pair_shuffle = _mm256_setr_epi8(
+      0, -1, 4, -1, 1, -1, 5, -1, 2, -1, 6, -1, 3, -1, 7, -1, //
+      0, -1, 4, -1, 1, -1, 5, -1, 2, -1, 6, -1, 3, -1, 7, -1
+  );
+  size_t i = 0;
+  for (; i + 2 <= count; i += 2) {
+    __m128i top[2];
+    __m128i bottom[2];
+    int32_t wx[2];
+    int32_t wy[2];
+    for (size_t k = 0; k < 2; ++k, u += du, v += dv) {
+      const int32_t cu = std::clamp(u, 0, max_u);
+      const int32_t cv = std::clamp(v, 0, max_v);
+      const int32_t x0 = cu >> 16;
+      const int32_t y0 = cv >> 16;
+      const int32_t x1 = std::min(x0 + 1, sz.width - 1);
+      const int32_t y1 = std::min(y0 + 1, sz.height - 1);
+      const std::byte* row0 = pixels + 4 * y0 * sz.width;
+      const std::byte* row1 = pixels + 4 * y1 * sz.width;
+      top[k] = load_pair(row0 + 4 * x0, row0 + 4 * x1);
+      bottom[k] = load_pair(row1 + 4 * x0, row1 + 4 * x1);
+      const int32_t w = (cu >> 8) & 0xff;
+      wx[k] = (256 - w) | w << 16;
+      wy[k] = (cv >> 8) & 0xff;
+    }
+    const __m256i weights_x = _mm256_set_m128i(_mm_set1_epi32(wx[1]), _mm_set1_epi32(wx[0]));
+    const __m256i weights_y = _mm256_set_m128i(_mm_set1_epi32(wy[1]), _mm_set1_epi32(wy[0]));
+    const __m256i t = _mm256_madd_epi16(
+        _mm256_shuffle_epi8(_mm256_set_m128i(top[1], top[0]), pair_shuffle), weights_x
+    );
+    const __m256i b = _mm256_madd_epi16(
+        _mm256_shuffle_epi8(_mm256_set_m128i(bottom[1], bottom[0]), pair_shuffle), weights_x
+    );
+    __m256i res = _mm256_add_epi32(
+        _mm256_mullo_epi32(t, _mm256_sub_epi32(_mm256_set1_epi32(256), weights_y)),
+        _mm256_mullo_epi32(b, weights_y)
+    );
+    res = _mm256_srli_epi32(_mm256_add_epi32(res, _mm256_set1_epi32(1 << 15)), 16);
+    res = _mm256_packus_epi16(_mm256_packus_epi32(res, res), res);
+    const int32_t first = _mm_cvtsi128_si32(_mm256_castsi256_si128(res));
+    const int32_t second = _mm_cvtsi128_si32(_mm256_extracti128_si256(res, 1));
+    std::memcpy(out + 4 * i, &first, sizeof(first));
+    std::memcpy(out + 4 * (i + 1), &second, sizeof(second));
+  }
+  scalar::sample(pixels, sz, u, v, du, dv, count - i, out + 4 * i);
+}
+
+constexpr kernels table{.isa = "avx2", .blend = blend, .sample = sample};
+
+} // namespace avx2
+
+#elif defined(__ARM_NEON)
+
+namespace neon {
+
+void blend(const std::byte* src, std::byte* dest, size_t count, uint32_t opacity) noexcept {
+  const auto factor = static_cast<uint16_t>(opacity);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const uint8x8x4_t s = vld4_u8(reinterpret_cast<const uint8_t*>(src + 4 * i));
+    auto* ptr = reinterpret_cast<uint8_t*>(dest + 4 * i);
+    uint8x8x4_t d = vld4_u8(ptr);
+    uint8x8_t color[4];
+    for (size_t c = 0; c < 4; ++c)
+      color[c] = vshrn_n_u16(vmulq_n_u16(vmovl_u8(s.val[c]), factor), 8);
+    const uint8x8_t inv_alpha = vmvn_u8(color[3]);
+    for (size_t c = 0; c < 4; ++c) {
+      const uint16x8_t prod = vmull_u8(d.val[c], inv_alpha);
+      d.val[c] = vqadd_u8(color[c], vraddhn_u16(prod, vrshrq_n_u16(prod, 8)));
+    }
+    vst4_u8(ptr, d);
+  }
+  scalar::blend(src + 4 * i, dest + 4 * i, count - i, opacity);
+}
+
+constexpr kernels table{.isa = "neon", .blend = blend, .sample = scalar::sample};
+
+} // namespace neon
+
+#endif
+
+std::vector<const kernels*> select_kernels() {
+  std::vector<const kernels*> res{&scalar::table};
+#if defined(__x86_64__) || defined(__i386__)
+  if (__builtin_cpu_supports("ssse3"))
+    res.push_back(&ssse3::table);
+  if (__builtin_cpu_supports("avx2"))
+    res.push_back(&avx2::table);
+#elif defined(__ARM_NEON)
+  res.push_back(&neon::table);
+#endif
+  return res;
+}
+
+const kernels& active_kernels() noexcept { return *detail::supported_compose_kernels().back(); }
+
+constexpr float fixed_one = 1 << 16;
+
+std::optional<affine_transform> invert(const affine_transform& t) noexcept {
+  const float det = t.xx * t.yy - t.xy * t.yx;
+  if (det == 0.f || !std::isfinite(det))
+    return std::nullopt;
+  affine_transform res{
+      .xx = t.yy / det, .xy = -t.xy / det, .yx = -t.yx / det, .yy = t.xx / det, .dx = 0, .dy = 0
+  };
+  res.dx = -(res.xx * t.dx + res.xy * t.dy);
+  res.dy = -(res.yx * t.dx + res.yy * t.dy);
+  return res;
+}
+
+bool is_blit(const affine_transform& t) noexcept {
+  return t.xx == 1.f && t.xy == 0.f && t.yx == 0.f && t.yy == 1.f && t.dx == std::floor(t.dx) &&
+         t.dy == std::floor(t.dy);
+}
+
+// Narrows [begin, end) to pixels x with base + step * (x + 0.5) in [0, limit)
+void clip_span(float base, float step, float limit, float& begin, float& end) noexcept {
+  if (step == 0.f) {
+    if (!(base >= 0.f && base < limit))
+      end = begin;
+    return;
+  }
+  float from = -base / step - .5f;
+  float to = (limit - base) / step - .5f;
+  if (step < 0.f)
+    std::swap(from, to);
+  begin = std::max(begin, std::ceil(from));
+  end = std::min(end, std::ceil(to));
+}
+
+// Samples `count` pixels starting from the point (u, v) of the sprite moving
+// by (du, dv) for each of them.
+void sample_row(
+    const kernels& kern, const layer& l, float u, float v, float du, float dv, size_t count, std::byte* out
+) noexcept {
+  const auto to_fixed = [](float val) { return static_cast<int32_t>(std::lround(val * fixed_one)); };
+  kern.sample(
+      l.pixels.data(), l.size, to_fixed(u - .5f), to_fixed(v - .5f), to_fixed(du), to_fixed(dv), count, out
+  );
+}
+
+} // namespace
+
+std::span<const detail::compose_kernels* const> detail::supported_compose_kernels() noexcept {
+  static const std::vector<const compose_kernels*> res = select_kernels();
+  return res;
+}
+
+std::string_view compose_isa() noexcept { return active_kernels().isa; }
+
+affine_transform affine_transform::place(::size sz, float x, float y, float scale, float angle) noexcept {
+  const float cos = scale * std::cos(angle);
+  const float sin = scale * std::sin(angle);
+  affine_transform res{.xx = cos, .xy = -sin, .yx = sin, .yy = cos, .dx = 0, .dy = 0};
+  res.dx = x - (res.xx * sz.width + res.xy * sz.height) / 2;
+  res.dy = y - (res.yx * sz.width + res.yy * sz.height) / 2;
+  return res;
+}
+
+rect bounds(const layer& l) noexcept {
+  const auto& t = l.transform;
+  const auto width = static_cast<float>(l.size.width);
+  const auto height = static_cast<float>(l.size.height);
+  const float xs[] = {t.dx, t.xx * width + t.dx, t.xy * height + t.dx, t.xx * width + t.xy * height + t.dx};
+  const float ys[] = {t.dy, t.yx * width + t.dy, t.yy * height + t.dy, t.yx * width + t.yy * height + t.dy};
+  const auto [min_x, max_x] = std::ranges::minmax(xs);
+  const auto [min_y, max_y] = std::ranges::minmax(ys);
+  const auto left = static_cast<int32_t>(std::floor(min_x));
+  const auto top = static_cast<int32_t>(std::floor(min_y));
+  return {
+      .x = left,
+      .y = top,
+      .width = static_cast<int32_t>(std::ceil(max_x)) - left,
+      .height = static_cast<int32_t>(std::ceil(max_y)) - top
+  };
+}
+
+void compose_rows(
+    std::span<const layer> layers, std::span<std::byte> dest, ::size dest_sz, size_t first_row, size_t rows
+) {
+  const auto& kern = active_kernels();
+  std::vector<std::byte> sampled;
+  for (const layer& l : layers) {
+    const auto opacity = static_cast<uint32_t>(std::lround(std::clamp(l.opacity, 0.f, 1.f) * 256));
+    if (l.size.width <= 0 || l.size.height <= 0 || opacity == 0)
+      continue;
+    const auto inv = invert(l.transform);
+    if (!inv)
+      continue;
+    const bool blit = is_blit(l.transform);
+
+    // Rows touched by the transformed sprite
+    const auto& t = l.transform;
+    const float ys[] = {
+        t.dy, t.yx * l.size.width + t.dy, t.yy * l.size.height + t.dy,
+        t.yx * l.size.width + t.yy * l.size.height + t.dy
+    };
+    const auto [min_y, max_y] = std::ranges::minmax(ys);
+    const auto row_begin = static_cast<int64_t>(std::max<float>(std::floor(min_y), first_row));
+    const auto row_end = static_cast<int64_t>(std::min<float>(std::ceil(max_y), first_row + rows));
+
+    for (int64_t y = row_begin; y < row_end; ++y) {
+      const float py = static_cast<float>(y) + .5f;
+      const float u_base = inv->xy * py + inv->dx;
+      const float v_base = inv->yy * py + inv->dy;
+      float begin = 0;
+      float end = static_cast<float>(dest_sz.width);
+      clip_span(u_base, inv->xx, static_cast<float>(l.size.width), begin, end);
+      clip_span(v_base, inv->yx, static_cast<float>(l.size.height), begin, end);
+      if (!(begin < end))
+        continue;
+
+      const auto x = static_cast<int64_t>(begin);
+      const auto count = static_cast<size_t>(end - begin);
+      const std::byte* src = nullptr;
+      if (blit) {
+        const auto sx = x - static_cast<int64_t>(t.dx);
+        const auto sy = y - static_cast<int64_t>(t.dy);
+        src = l.pixels.data() + 4 * (sy * l.size.width + sx);
+      } else {
+        sampled.resize(4 * dest_sz.width);
+        const float px = static_cast<float>(x) + .5f;
+        sample_row(
+            kern, l, inv->xx * px + u_base, inv->yx * px + v_base, inv->xx, inv->yx, count, sampled.data()
+        );
+        src = sampled.data();
+      }
+      kern.blend(src, dest.data() + 4 * (y * dest_sz.width + x), count, opacity);
+    }
+  }
+}
+
+} // namespace img
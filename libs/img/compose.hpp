@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#include <libs/geom/geom.hpp>
+#include <libs/img/parallel.hpp>
+
+namespace img {
+
+/// Name of the instruction set the blending kernels were selected for at
+/// startup: "avx2", "ssse3", "neon" or "scalar".
+std::string_view compose_isa() noexcept;
+
+namespace detail {
+
+struct compose_kernels {
+  std::string_view isa;
+  /// Blends `count` premultiplied pixels of `src` scaled by `opacity` in
+  /// [0, 256] over the `dest` ones.
+  void (*blend)(const std::byte* src, std::byte* dest, size_t count, uint32_t opacity) noexcept;
+  /// Samples `count` pixels of the `sz` image bilinearly starting from the
+  /// point (u, v) and moving by (du, dv) for each of them. Coordinates are
+  /// 16.16 fixed point ones relative to pixel centers and are clamped to
+  /// the image edges.
+  void (*sample)(
+      const std::byte* pixels, ::size sz, int32_t u, int32_t v, int32_t du, int32_t dv, size_t count,
+      std::byte* out
+  ) noexcept;
+};
+
+/// Kernels the current CPU is able to run starting from the scalar ones.
+/// The last of them are used for composition.
+std::span<const compose_kernels* const> supported_compose_kernels() noexcept;
+
+} // namespace detail
+
+/// Maps continuous sprite coordinates to canvas ones:
+///   x' = xx * x + xy * y + dx
+///   y' = yx * x + yy * y + dy
+/// Pixel (i, j) covers the [i, i + 1) x [j, j + 1) square in both spaces.
+struct affine_transform {
+  float xx = 1;
+  float xy = 0;
+  float yx = 0;
+  float yy = 1;
+  float dx = 0;
+  float dy = 0;
+
+  /// Scales the sprite of size `sz`, rotates it clockwise by `angle` radians
+  /// around its center and moves the center to (`x`, `y`).
+  static affine_transform place(::size sz, float x, float y, float scale = 1, float angle = 0) noexcept;
+};
+
+/// Sprite blended over the canvas. Pixels are 4 byte premultiplied ones in
+/// the channel order of the canvas with alpha in the last byte.
+struct layer {
+  std::span<const std::byte> pixels;
+  ::size size;
+  affine_transform transform;
+  float opacity = 1;
+};
+
+/// Canvas area the layer may cover. Transformed sprites touch pixels partially
+/// so the area is rounded outwards.
+rect bounds(const layer& l) noexcept;
+
+/// Blends `layers` in order over `rows` rows of the `dest` canvas of size
+/// `dest_sz` starting from `first_row`. Transformed sprites are sampled
+/// bilinearly while those placed at whole pixels without scaling or rotation
+/// are blended straight from their memory.
+void compose_rows(
+    std::span<const layer> layers, std::span<std::byte> dest, ::size dest_sz, size_t first_row, size_t rows
+);
+
+/// Blends `layers` over the whole `dest` canvas splitting it into bands of
+/// rows processed concurrently on the `exec`. Bands are small enough for
+/// their canvas pixels to stay in cache while all the layers are blended.
+template <typename Executor>
+void compose(
+    const Executor& exec, std::span<const layer> layers, std::span<std::byte> dest, ::size dest_sz
+) {
+  constexpr size_t band_bytes = 64 * 1024;
+  if (dest_sz.width <= 0 || dest_sz.height <= 0)
+    return;
+  parallel_rows(exec, dest_sz.height, band_bytes / (4 * dest_sz.width), [&](size_t first_row, size_t rows) {
+    compose_rows(layers, dest, dest_sz, first_row, rows);
+  });
+}
+
+} // namespace img
@@ -0,0 +1,221 @@
+#include "compose.hpp"
+
+#include <algorithm>
+#include <array>
+#include <numbers>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+namespace {
+
+constexpr size canvas_size{.width = 41, .height = 23};
+
+std::vector<std::byte> make_pattern(size sz) {
+  std::vector<std::byte> res(4 * sz.width * sz.height);
+  for (size_t i = 0; i < res.size(); i += 4) {
+    // Premultiplied pixels have color channels not exceeding alpha
+    const auto alpha = static_cast<uint32_t>((i * 7 + 100) % 256);
+    res[i + 3] = static_cast<std::byte>(alpha);
+    for (size_t c = 0; c < 3; ++c)
+      res[i + c] = static_cast<std::byte>((i * 13 + c * 29) % (alpha + 1));
+  }
+  return res;
+}
+
+std::vector<std::byte> fill(size sz, std::array<uint8_t, 4> px) {
+  std::vector<std::byte> res(4 * sz.width * sz.height);
+  for (size_t i = 0; i < res.size(); ++i)
+    res[i] = static_cast<std::byte>(px[i % 4]);
+  return res;
+}
+
+std::span<const std::byte> pixel(std::span<const std::byte> img, size sz, int32_t x, int32_t y) {
+  return img.subspan(4 * (y * sz.width + x), 4);
+}
+
+} // namespace
+
+SCENARIO("Layers composition") {
+  INFO("compose ISA: " << img::compose_isa());
+
+  GIVEN("opaque sprite placed at whole pixels") {
+    constexpr size sprite_size{.width = 19, .height = 7};
+    auto sprite = make_pattern(sprite_size);
+    for (size_t i = 3; i < sprite.size(); i += 4)
+      sprite[i] = std::byte{0xff};
+    const img::layer layer{
+        .pixels = sprite, .size = sprite_size, .transform = {.dx = 5, .dy = 3}, .opacity = 1
+    };
+
+    WHEN("it is composed over the canvas") {
+      const auto background = fill({1, 1}, {10, 20, 30, 40});
+      auto canvas = fill(canvas_size, {10, 20, 30, 40});
+      img::compose_rows({&layer, 1}, canvas, canvas_size, 0, canvas_size.height);
+
+      THEN("sprite pixels are copied and the rest is intact") {
+        for (int32_t y = 0; y < canvas_size.height; ++y) {
+          for (int32_t x = 0; x < canvas_size.width; ++x) {
+            const bool covered = x >= 5 && x < 5 + sprite_size.width && y >= 3 && y < 3 + sprite_size.height;
+            const auto expected =
+                covered ? pixel(sprite, sprite_size, x - 5, y - 3) : std::span<const std::byte>{background};
+            CHECK(std::ranges::equal(pixel(canvas, canvas_size, x, y), expected));
+          }
+        }
+      }
+    }
+  }
+
+  GIVEN("translucent sprite") {
+    constexpr size sprite_size{.width = 37, .height = 5};
+    const auto sprite = fill(sprite_size, {0, 64, 128, 128});
+    const img::layer layer{.pixels = sprite, .size = sprite_size, .transform = {.dx = 2, .dy = 1}};
+
+    WHEN("it is composed over opaque white") {
+      auto canvas = fill(canvas_size, {255, 255, 255, 255});
+      img::compose_rows({&layer, 1}, canvas, canvas_size, 0, canvas_size.height);
+
+      THEN("colors are blended with the source over operator") {
+        for (int32_t x = 2; x < 2 + sprite_size.width; ++x) {
+          const std::array<std::byte, 4> expected{
+              std::byte{127}, std::byte{191}, std::byte{255}, std::byte{255}
+          };
+          CHECK(std::ranges::equal(pixel(canvas, canvas_size, x, 3), expected));
+        }
+      }
+    }
+
+    WHEN("it is composed with zero opacity") {
+      auto canvas = make_pattern(canvas_size);
+      const auto orig = canvas;
+      img::layer hidden = layer;
+      hidden.opacity = 0;
+      img::compose_rows({&hidden, 1}, canvas, canvas_size, 0, canvas_size.height);
+
+      THEN("canvas is left intact") { CHECK(canvas == orig); }
+    }
+  }
+
+  GIVEN("several rotated, scaled and translucent sprites") {
+    constexpr size sprite_size{.width = 13, .height = 9};
+    const auto sprite = make_pattern(sprite_size);
+    const img::layer layers[] = {
+        {.pixels = sprite,
+         .size = sprite_size,
+         .transform = img::affine_transform::place(sprite_size, 10.3, 7.8, 1.7, .4)},
+        {.pixels = sprite,
+         .size = sprite_size,
+         .transform = img::affine_transform::place(sprite_size, 25, 15, .6, -2.1),
+         .opacity = .7},
+        {.pixels = sprite, .size = sprite_size, .transform = {.dx = -4, .dy = 17}},
+    };
+
+    WHEN("they are composed by bands of rows") {
+      auto canvas = make_pattern(canvas_size);
+      auto whole = canvas;
+      for (int32_t row = 0; row < canvas_size.height; row += 5)
+        img::compose_rows(layers, canvas, canvas_size, row, std::min(5, canvas_size.height - row));
+      img::compose_rows(layers, whole, canvas_size, 0, canvas_size.height);
+
+      THEN("result is the same as composing at once") { CHECK(canvas == whole); }
+    }
+
+    WHEN("each of them is composed over transparent canvas") {
+      THEN("only pixels within the layer bounds are changed") {
+        for (const auto& layer : layers) {
+          auto canvas = fill(canvas_size, {0, 0, 0, 0});
+          img::compose_rows({&layer, 1}, canvas, canvas_size, 0, canvas_size.height);
+          const rect area = img::bounds(layer);
+          for (int32_t y = 0; y < canvas_size.height; ++y) {
+            for (int32_t x = 0; x < canvas_size.width; ++x) {
+              const bool inside =
+                  x >= area.x && x < area.x + area.width && y >= area.y && y < area.y + area.height;
+              if (!inside)
+                CHECK(pixel(canvas, canvas_size, x, y)[3] == std::byte{0});
+            }
+          }
+        }
+      }
+    }
+  }
+
+  GIVEN("sprite rotated by the right angle around a pixel corner") {
+    constexpr size sprite_size{.width = 4, .height = 2};
+    const auto sprite = make_pattern(sprite_size);
+    const img::layer layer{
+        .pixels = sprite,
+        .size = sprite_size,
+        .transform = img::affine_transform::place(sprite_size, 10, 10, 1, std::numbers::pi_v<float> / 2)
+    };
+
+    WHEN("it is composed over transparent canvas") {
+      auto canvas = fill(canvas_size, {0, 0, 0, 0});
+      img::compose_rows({&layer, 1}, canvas, canvas_size, 0, canvas_size.height);
+
+      THEN("pixels are moved without interpolation") {
+        // Clockwise rotation turns the top row into the right column
+        for (int32_t x = 0; x < sprite_size.width; ++x) {
+          CHECK(std::ranges::equal(pixel(canvas, canvas_size, 10, 8 + x), pixel(sprite, sprite_size, x, 0)));
+          CHECK(std::ranges::equal(pixel(canvas, canvas_size, 9, 8 + x), pixel(sprite, sprite_size, x, 1)));
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("Composition kernels for different instruction sets") {
+  const auto supported = img::detail::supported_compose_kernels();
+  REQUIRE(supported.front()->isa == "scalar");
+  CHECK(supported.back()->isa == img::compose_isa());
+
+  GIVEN("rows of premultiplied pixels with odd length") {
+    constexpr size row_size{.width = 37, .height = 1};
+    const auto src = make_pattern(row_size);
+    const auto orig = fill(row_size, {200, 100, 50, 250});
+    const uint32_t opacity = GENERATE(256u, 179u, 1u);
+
+    WHEN("one is blended over another with each of the supported kernels") {
+      const auto blend = [&](const img::detail::compose_kernels& kern) {
+        auto dest = orig;
+        kern.blend(src.data(), dest.data(), row_size.width, opacity);
+        return dest;
+      };
+      const auto expected = blend(*supported.front());
+
+      THEN("all of them produce the same pixels as the scalar one") {
+        for (const auto* kern : supported) {
+          INFO("isa: " << kern->isa << ", opacity: " << opacity);
+          CHECK(blend(*kern) == expected);
+        }
+      }
+    }
+  }
+
+  GIVEN("sprite sampled along lines crossing its edges") {
+    constexpr size sprite_size{.width = 13, .height = 9};
+    const auto sprite = make_pattern(sprite_size);
+    // Start points and steps in 16.16 fixed point relative to pixel centers
+    const auto [u, v, du, dv] = GENERATE(
+        std::array{-70000, 3 << 16, 24000, 7000}, std::array{14 << 16, -5000, -85000, 31000},
+        std::array{6 << 16, 4 << 16, 0, 0}, std::array{100, 8 << 16, 65536, -65536}
+    );
+
+    WHEN("pixels are sampled with each of the supported kernels") {
+      constexpr size_t count = 33;
+      const auto sample = [&](const img::detail::compose_kernels& kern) {
+        std::vector<std::byte> res(4 * count);
+        kern.sample(sprite.data(), sprite_size, u, v, du, dv, count, res.data());
+        return res;
+      };
+      const auto expected = sample(*supported.front());
+
+      THEN("all of them produce the same pixels as the scalar one") {
+        for (const auto* kern : supported) {
+          INFO("isa: " << kern->isa << ", from: " << u << ", " << v << ", step: " << du << ", " << dv);
+          CHECK(sample(*kern) == expected);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,359 @@
+#include "convert.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace img {
+
+namespace {
+
+using kernels = detail::conversion_kernels;
+
+// Rounded `val / 255` exact for any `val` in [0, 255 * 255]
+constexpr uint8_t div255(unsigned val) noexcept {
+  val += 128;
+  return static_cast<uint8_t>((val + (val >> 8)) >> 8);
+}
+
+namespace scalar {
+
+void rgb_to_rgba(const std::byte* src, std::byte* dest, size_t pixels) noexcept {
+  for (size_t i = 0; i < pixels; ++i, src += 3, dest += 4) {
+    std::memcpy(dest, src, 3);
+    dest[3] = std::byte{0xff};
+  }
+}
+
+void swap_red_blue(std::byte* pixels, size_t count) noexcept {
+  for (size_t i = 0; i < count; ++i, pixels += 4)
+    std::swap(pixels[0], pixels[2]);
+}
+
+void premultiply_alpha(std::byte* pixels, size_t count) noexcept {
+  for (size_t i = 0; i < count; ++i, pixels += 4) {
+    const auto alpha = std::to_integer<unsigned>(pixels[3]);
+    for (size_t c = 0; c < 3; ++c)
+      pixels[c] = std::byte{div255(std::to_integer<unsigned>(pixels[c]) * alpha)};
+  }
+}
+
+constexpr kernels table{
+    .isa = "scalar",
+    .rgb_to_rgba = rgb_to_rgba,
+    .swap_red_blue = swap_red_blue,
+    .premultiply_alpha = premultiply_alpha
+};
+
+} // namespace scalar
+
+#if defined(__x86_64__) || defined(__i386__)
+
+namespace ssse3 {
+
+[[gnu::target("ssse3")]] void rgb_to_rgba(const std::byte* src, std::byte* dest, size_t pixels) noexcept {
+  const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+  const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xff000000u));
+  size_t i = 0;
+  // Each iteration loads 16 bytes while consuming only 12 of them
+  for (; i + 6 <= pixels; i += 4) {
+    const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 3 * i));
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i*>(dest + 4 * i), _mm_or_si128(_mm_shuffle_epi8(in, shuffle), alpha)
+    );
+  }
+  scalar::rgb_to_rgba(src + 3 * i, dest + 4 * i, pixels - i);
+}
+
+[[gnu::target("ssse3")]] void swap_red_blue(std::byte* pixels, size_t count) noexcept {
+  const __m128i shuffle = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    auto* ptr = reinterpret_cast<__m128i*>(pixels + 4 * i);
+    _mm_storeu_si128(ptr, _mm_shuffle_epi8(_mm_loadu_si128(ptr), shuffle));
+  }
+  scalar::swap_red_blue(pixels + 4 * i, count - i);
+}
+
+[[gnu::target("ssse3")]] inline __m128i
+premultiply_half(__m128i px, __m128i alpha_shuffle, __m128i alpha_lane) noexcept {
+  const __m128i alpha = _mm_or_si128(_mm_shuffle_epi8(px, alpha_shuffle), alpha_lane);
+  __m128i res = _mm_add_epi16(_mm_mullo_epi16(px, alpha), _mm_set1_epi16(128));
+  res = _mm_add_epi16(res, _mm_srli_epi16(res, 8));
+  return _mm_srli_epi16(res, 8);
+}
+
+[[gnu::target("ssse3")]] void premultiply_alpha(std::byte* pixels, size_t count) noexcept {
+  // Broadcasts alpha word of each of two unpacked pixels over its color words
+  const __m128i alpha_shuffle = _mm_setr_epi8(6, 7, 6, 7, 6, 7, -1, -1, 14, 15, 14, 15, 14, 15, -1, -1);
+  // Multiplying alpha by 255 keeps it intact
+  const __m128i alpha_lane = _mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255);
+  const __m128i zero = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    auto* ptr = reinterpret_cast<__m128i*>(pixels + 4 * i);
+    const __m128i px = _mm_loadu_si128(ptr);
+    const __m128i lo = premultiply_half(_mm_unpacklo_epi8(px, zero), alpha_shuffle, alpha_lane);
+    const __m128i hi = premultiply_half(_mm_unpackhi_epi8(px, zero), alpha_shuffle, alpha_lane);
+    _mm_storeu_si128(ptr, _mm_packus_epi16(lo, hi));
+  }
+  scalar::premultiply_alpha(pixels + 4 * i, count - i);
+}
+
+constexpr kernels table{
+    .isa = "ssse3",
+    .rgb_to_rgba = rgb_to_rgba,
+    .swap_red_blue = swap_red_blue,
+    .premultiply_alpha = premultiply_alpha
+};
+
+} // namespace ssse3
+
+namespace avx2 {
+
+[[gnu::target("avx2")]] void rgb_to_rgba(const std::byte* src, std::byte* dest, size_t pixels) noexcept {
+  const __m256i shuffle =
+      _mm256_broadcastsi128_si256(_mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1));
+  const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xff000000u));
+  size_t i = 0;
+  // Each lane gets 12 bytes worth of pixels out of its 16 bytes load
+  for (; i + 10 <= pixels; i += 8) {
+    const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 3 * i));
+    const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 3 * i + 12));
+    const __m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i*>(dest + 4 * i), _mm256_or_si256(_mm256_shuffle_epi8(in, shuffle), alpha)
+    );
+  }
+  ssse3::rgb_to_rgba(src + 3 * i, dest + 4 * i, pixels - i);
+}
+
+[[gnu::target("avx2")]] void swap_red_blue(std::byte* pixels, size_t count) noexcept {
+  const __m256i shuffle =
+      _mm256_broadcastsi128_si256(_mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15));
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    auto* ptr = reinterpret_cast<__m256i*>(pixels + 4 * i);
+    _mm256_storeu_si256(ptr, _mm256_shuffle_epi8(_mm256_loadu_si256(ptr), shuffle));
+  }
+  ssse3::swap_red_blue(pixels + 4 * i, count - i);
+}
+
+[[gnu::target("avx2")]] inline __m256i
+premultiply_half(__m256i px, __m256i alpha_shuffle, __m256i alpha_lane) noexcept {
+  const __m256i alpha = _mm256_or_si256(_mm256_shuffle_epi8(px, alpha_shuffle), alpha_lane);
+  __m256i res = _mm256_add_epi16(_mm256_mullo_epi16(px, alpha), _mm256_set1_epi16(128));
+  res = _mm256_add_epi16(res, _mm256_srli_epi16(res, 8));
+  return _mm256_srli_epi16(res, 8);
+}
+
+[[gnu::target("avx2")]] void premultiply_alpha(std::byte* pixels, size_t count) noexcept {
+  const __m256i alpha_shuffle =
+      _mm256_broadcastsi128_si256(_mm_setr_epi8(6, 7, 6, 7, 6, 7, -1, -1, 14, 15, 14, 15, 14, 15, -1, -1));
+  const __m256i alpha_lane = _mm256_broadcastsi128_si256(_mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255));
+  const __m256i zero = _mm256_setzero_si256();
+  size_t i = 0;
+  // Unpack and pack both work within 128 bit lanes so pixels order is preserved
+  for (; i + 8 <= count; i += 8) {
+    auto* ptr = reinterpret_cast<__m256i*>(pixels + 4 * i);
+    const __m256i px = _mm256_loadu_si256(ptr);
+    const __m256i lo = premultiply_half(_mm256_unpacklo_epi8(px, zero), alpha_shuffle, alpha_lane);
+    const __m256i hi = premultiply_half(_mm256_unpackhi_epi8(px, zero), alpha_shuffle, alpha_lane);
+    _mm256_storeu_si256(ptr, _mm256_packus_epi16(lo, hi));
+  }
+  ssse3::premultiply_alpha(pixels + 4 * i, count - i);
+}
+
+constexpr kernels table{
+    .isa = "avx2",
+    .rgb_to_rgba = rgb_to_rgba,
+    .swap_red_blue = swap_red_blue,
+    .premultiply_alpha = premultiply_alpha
+};
+
+} // namespace avx2
+
+#elif defined(__ARM_NEON)
+
+namespace neon {
+
+void rgb_to_rgba(const std::byte* src, std::byte* dest, size_t pixels) noexcept {
+  size_t i = 0;
+  for (; i + 16 <= pixels; i += 16) {
+    const uint8x16x3_t in = vld3q_u8(reinterpret_cast<const uint8_t*>(src + 3 * i));
+    const uint8x16x4_t out{in.val[0], in.val[1], in.val[2], vdupq_n_u8(0xff)};
+    vst4q_u8(reinterpret_cast<uint8_t*>(dest + 4 * i), out);
+  }
+  scalar::rgb_to_rgba(src + 3 * i, dest + 4 * i, pixels - i);
+}
+
+void swap_red_blue(std::byte* pixels, size_t count) noexcept {
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    auto* ptr = reinterpret_cast<uint8_t*>(pixels + 4 * i);
+    uint8x16x4_t px = vld4q_u8(ptr);
+    std::swap(px.val[0], px.val[2]);
+    vst4q_u8(ptr, px);
+  }
+  scalar::swap_red_blue(pixels + 4 * i, count - i);
+}
+
+inline uint8x8_t premultiply(uint8x8_t color, uint8x8_t alpha) noexcept {
+  const uint16x8_t prod = vmull_u8(color, alpha);
+  return vraddhn_u16(prod, vrshrq_n_u16(prod, 8));
+}
+
+void premultiply_alpha(std::byte* pixels, size_t count) noexcept {
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    auto* ptr = reinterpret_cast<uint8_t*>(pixels + 4 * i);
+    uint8x16x4_t px = vld4q_u8(ptr);
+    for (size_t c = 0; c < 3; ++c) {
+      px.val[c] = vcombine_u8(
+          premultiply(vget_low_u8(px.val[c]), vget_low_u8(px.val[3])),
+          premultiply(vget_high_u8(px.val[c]), vget_high_u8(px.val[3]))
+      );
+    }
+    vst4q_u8(ptr, px);
+  }
+  scalar::premultiply_alpha(pixels + 4 * i, count - i);
+}
+
+constexpr kernels table{
+    .isa = "neon",
+    .rgb_to_rgba = rgb_to_rgba,
+    .swap_red_blue = swap_red_blue,
+    .premultiply_alpha = premultiply_alpha
+};
+
+} // namespace neon
+
+#endif
+
+std::vector<const kernels*> select_kernels() {
+  std::vector<const kernels*> res{&scalar::table};
+#if defined(__x86_64__) || defined(__i386__)
+  if (__builtin_cpu_supports("ssse3"))
+    res.push_back(&ssse3::table);
+  if (__builtin_cpu_supports("avx2"))
+    res.push_back(&avx2::table);
+#elif defined(__ARM_NEON)
+  res.push_back(&neon::table);
+#endif
+  return res;
+}
+
+const kernels& active_kernels() noexcept { return *detail::supported_conversion_kernels().back(); }
+
+struct srgb_tables {
+  // Linear values are quantized to 12 bits for the reverse lookup which is
+  // still finer than the darkest sRGB step.
+  static constexpr unsigned linear_index_shift = 4;
+
+  srgb_tables() {
+    for (unsigned i = 0; i < to_linear.size(); ++i) {
+      const double val = i / 255.;
+      const double linear = val <= 0.04045 ? val / 12.92 : std::pow((val + 0.055) / 1.055, 2.4);
+      to_linear[i] = static_cast<uint16_t>(std::lround(linear * 65535.));
+    }
+    for (unsigned i = 0; i < to_srgb.size(); ++i) {
+      const double linear = ((i << linear_index_shift) + (1u << (linear_index_shift - 1))) / 65535.;
+      const double val =
+          linear <= 0.0031308 ? linear * 12.92 : 1.055 * std::pow(std::min(linear, 1.), 1. / 2.4) - 0.055;
+      to_srgb[i] = std::byte(std::lround(val * 255.));
+    }
+  }
+
+  std::array<uint16_t, 256> to_linear;
+  std::array<std::byte, (1 << (16 - linear_index_shift))> to_srgb;
+};
+
+const srgb_tables& srgb() noexcept {
+  static const srgb_tables res;
+  return res;
+}
+
+} // namespace
+
+std::span<const detail::conversion_kernels* const> detail::supported_conversion_kernels() noexcept {
+  static const std::vector<const conversion_kernels*> res = select_kernels();
+  return res;
+}
+
+std::string_view conversion_isa() noexcept { return active_kernels().isa; }
+
+void rgb_to_rgba(std::span<const std::byte> src, std::span<std::byte> dest) noexcept {
+  const size_t pixels = src.size() / 3;
+  assert(dest.size() >= pixels * 4);
+  active_kernels().rgb_to_rgba(src.data(), dest.data(), pixels);
+}
+
+void swap_red_blue(std::span<std::byte> pixels) noexcept {
+  active_kernels().swap_red_blue(pixels.data(), pixels.size() / 4);
+}
+
+void premultiply_alpha(std::span<std::byte> pixels) noexcept {
+  active_kernels().premultiply_alpha(pixels.data(), pixels.size() / 4);
+}
+
+uint16_t srgb_to_linear(std::byte val) noexcept { return srgb().to_linear[std::to_integer<size_t>(val)]; }
+
+std::byte linear_to_srgb(uint16_t val) noexcept {
+  return srgb().to_srgb[val >> srgb_tables::linear_index_shift];
+}
+
+void srgb_to_linear(std::span<const std::byte> src, std::span<uint16_t> dest) noexcept {
+  assert(dest.size() >= src.size());
+  const auto& lut = srgb().to_linear;
+  std::ranges::transform(src, dest.begin(), [&lut](std::byte val) {
+    return lut[std::to_integer<size_t>(val)];
+  });
+}
+
+void linear_to_srgb(std::span<const uint16_t> src, std::span<std::byte> dest) noexcept {
+  assert(dest.size() >= src.size());
+  const auto& lut = srgb().to_srgb;
+  std::ranges::transform(src, dest.begin(), [&lut](uint16_t val) {
+    return lut[val >> srgb_tables::linear_index_shift];
+  });
+}
+
+reader transform_rows(reader src, std::move_only_function<void(std::span<std::byte>)> transform) {
+  const auto sz = src.size();
+  const auto fmt = src.format();
+  auto read_rows = [src = std::move(src), transform = std::move(transform)](auto rows) mutable {
+    src.read_rows(rows);
+    transform(rows);
+  };
+  return {sz, fmt, std::move(read_rows)};
+}
+
+reader expand_to_rgba(reader src) {
+  switch (src.format()) {
+  case pixel_fmt::rgba:
+    return src;
+  case pixel_fmt::rgb:
+    break;
+  case pixel_fmt::grayscale:
+    throw std::runtime_error{"Grayscale images can't be expanded to RGBA"};
+  }
+
+  const auto sz = src.size();
+  auto read_rows = [src = std::move(src), band = std::vector<std::byte>{}](auto rows) mutable {
+    band.resize(rows.size() / pixel_byte_size(pixel_fmt::rgba) * pixel_byte_size(pixel_fmt::rgb));
+    src.read_rows(band);
+    rgb_to_rgba(band, rows);
+  };
+  return {sz, pixel_fmt::rgba, std::move(read_rows)};
+}
+
+} // namespace img
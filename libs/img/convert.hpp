@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#include <libs/img/reader.hpp>
+
+namespace img {
+
+/// Name of the instruction set the conversion kernels were selected for at
+/// startup: "avx2", "ssse3", "neon" or "scalar".
+std::string_view conversion_isa() noexcept;
+
+namespace detail {
+
+struct conversion_kernels {
+  std::string_view isa;
+  void (*rgb_to_rgba)(const std::byte* src, std::byte* dest, size_t pixels) noexcept;
+  void (*swap_red_blue)(std::byte* pixels, size_t count) noexcept;
+  void (*premultiply_alpha)(std::byte* pixels, size_t count) noexcept;
+};
+
+/// Kernels the current CPU is able to run starting from the scalar ones.
+/// The last of them are used for conversions.
+std::span<const conversion_kernels* const> supported_conversion_kernels() noexcept;
+
+} // namespace detail
+
+/// Expands RGB pixels to RGBA ones with opaque alpha. `dest` must have room
+/// for `src.size() / 3` pixels.
+void rgb_to_rgba(std::span<const std::byte> src, std::span<std::byte> dest) noexcept;
+
+/// Swaps red and blue channels of 4 byte pixels in place. Converts RGBA to
+/// BGRA which is the memory layout of WL_SHM_FORMAT_ARGB8888 and vice versa.
+void swap_red_blue(std::span<std::byte> pixels) noexcept;
+
+/// Multiplies color channels of 4 byte pixels with alpha in the last byte.
+void premultiply_alpha(std::span<std::byte> pixels) noexcept;
+
+/// sRGB encoded 8 bit values to linear 16 bit ones and back using lookup
+/// tables.
+uint16_t srgb_to_linear(std::byte val) noexcept;
+std::byte linear_to_srgb(uint16_t val) noexcept;
+void srgb_to_linear(std::span<const std::byte> src, std::span<uint16_t> dest) noexcept;
+void linear_to_srgb(std::span<const uint16_t> src, std::span<std::byte> dest) noexcept;
+
+/// Reader which applies `transform` in place to each band of rows right after
+/// it is decoded by the `src` reader.
+reader transform_rows(reader src, std::move_only_function<void(std::span<std::byte>)> transform);
+
+/// Reader producing RGBA pixels from RGB or RGBA source.
+reader expand_to_rgba(reader src);
+
+} // namespace img
@@ -0,0 +1,200 @@
+#include "convert.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+
+// Odd number of pixels makes every kernel go through its scalar tail
+constexpr size_t pixels_count = 67;
+
+std::vector<std::byte> make_pattern(size_t size) {
+  std::vector<std::byte> res(size);
+  std::ranges::generate(res, [n = 0u]() mutable { return static_cast<std::byte>((n++ * 37u + 11u) % 256u); });
+  return res;
+}
+
+} // namespace
+
+SCENARIO("Pixel format conversions") {
+  INFO("conversion ISA: " << img::conversion_isa());
+
+  GIVEN("RGB pixels") {
+    const auto rgb = make_pattern(pixels_count * 3);
+
+    WHEN("they are expanded to RGBA") {
+      std::vector<std::byte> rgba(pixels_count * 4);
+      img::rgb_to_rgba(rgb, rgba);
+
+      THEN("color channels are copied and alpha is opaque") {
+        std::vector<std::byte> expected;
+        for (size_t i = 0; i < pixels_count; ++i) {
+          expected.insert(expected.end(), rgb.begin() + 3 * i, rgb.begin() + 3 * i + 3);
+          expected.push_back(std::byte{0xff});
+        }
+        CHECK(rgba == expected);
+      }
+    }
+  }
+
+  GIVEN("RGBA pixels") {
+    const auto rgba = make_pattern(pixels_count * 4);
+
+    WHEN("red and blue channels are swapped") {
+      auto bgra = rgba;
+      img::swap_red_blue(bgra);
+
+      THEN("each pixel has its red and blue bytes exchanged") {
+        auto expected = rgba;
+        for (size_t i = 0; i < pixels_count; ++i)
+          std::swap(expected[4 * i], expected[4 * i + 2]);
+        CHECK(bgra == expected);
+      }
+    }
+
+    WHEN("alpha is premultiplied") {
+      auto premultiplied = rgba;
+      img::premultiply_alpha(premultiplied);
+
+      THEN("color channels are scaled by alpha with rounding") {
+        auto expected = rgba;
+        for (size_t i = 0; i < pixels_count; ++i) {
+          const auto alpha = std::to_integer<unsigned>(rgba[4 * i + 3]);
+          for (size_t c = 0; c < 3; ++c) {
+            const auto color = std::to_integer<unsigned>(rgba[4 * i + c]);
+            expected[4 * i + c] = static_cast<std::byte>((color * alpha * 2 + 255) / 510);
+          }
+        }
+        CHECK(premultiplied == expected);
+      }
+    }
+  }
+
+  GIVEN("all sRGB values") {
+    std::vector<std::byte> srgb(256);
+    std::ranges::generate(srgb, [n = 0u]() mutable { return static_cast<std::byte>(n++); });
+
+    WHEN("they are converted to linear values") {
+      std::vector<uint16_t> linear(srgb.size());
+      img::srgb_to_linear(srgb, linear);
+
+      THEN("linear values are monotonic and cover the whole range") {
+        CHECK(std::ranges::is_sorted(linear));
+        CHECK(linear.front() == 0);
+        CHECK(linear.back() == 0xffff);
+      }
+
+      AND_WHEN("converted back to sRGB") {
+        std::vector<std::byte> round_trip(srgb.size());
+        img::linear_to_srgb(linear, round_trip);
+
+        THEN("original values are restored") { CHECK(round_trip == srgb); }
+      }
+    }
+  }
+}
+
+SCENARIO("Conversion kernels for different instruction sets") {
+  const auto supported = img::detail::supported_conversion_kernels();
+  REQUIRE(supported.front()->isa == "scalar");
+  CHECK(supported.back()->isa == img::conversion_isa());
+  const auto& scalar = *supported.front();
+
+  GIVEN("pixels of every count up to several vector widths") {
+    const auto rgb = make_pattern(pixels_count * 3);
+    const auto rgba = make_pattern(pixels_count * 4);
+
+    WHEN("they are converted with each of the supported kernels") {
+      THEN("all of them produce the same pixels as the scalar ones") {
+        for (const auto* kern : supported) {
+          for (size_t count = 0; count <= pixels_count; ++count) {
+            INFO("isa: " << kern->isa << ", pixels: " << count);
+            std::vector<std::byte> expected(4 * count);
+            std::vector<std::byte> res(4 * count);
+            scalar.rgb_to_rgba(rgb.data(), expected.data(), count);
+            kern->rgb_to_rgba(rgb.data(), res.data(), count);
+            CHECK(res == expected);
+
+            expected.assign(rgba.begin(), rgba.begin() + 4 * count);
+            res = expected;
+            scalar.swap_red_blue(expected.data(), count);
+            kern->swap_red_blue(res.data(), count);
+            CHECK(res == expected);
+
+            expected.assign(rgba.begin(), rgba.begin() + 4 * count);
+            res = expected;
+            scalar.premultiply_alpha(expected.data(), count);
+            kern->premultiply_alpha(res.data(), count);
+            CHECK(res == expected);
+          }
+        }
+      }
+    }
+  }
+
+  GIVEN("pixels with every pair of color and alpha values") {
+    std::vector<std::byte> pixels(4 * 256 * 86);
+    for (size_t i = 0; i < pixels.size() / 4; ++i) {
+      for (size_t c = 0; c < 3; ++c)
+        pixels[4 * i + c] = static_cast<std::byte>((3 * (i / 256) + c) % 256);
+      pixels[4 * i + 3] = static_cast<std::byte>(i % 256);
+    }
+
+    WHEN("alpha is premultiplied with each of the supported kernels") {
+      auto expected = pixels;
+      scalar.premultiply_alpha(expected.data(), expected.size() / 4);
+
+      THEN("all of them round the same way as the scalar ones") {
+        for (const auto* kern : supported) {
+          INFO("isa: " << kern->isa);
+          auto res = pixels;
+          kern->premultiply_alpha(res.data(), res.size() / 4);
+          CHECK(res == expected);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("Converting readers") {
+  GIVEN("reader of 5x3 RGB image") {
+    const size sz{.width = 5, .height = 3};
+    const auto rgb = make_pattern(bytes_size(sz, img::pixel_fmt::rgb));
+    img::reader src{sz, img::pixel_fmt::rgb, [&rgb, offset = size_t{0}](std::span<std::byte> dest) mutable {
+                      std::memcpy(dest.data(), rgb.data() + offset, dest.size());
+                      offset += dest.size();
+                    }};
+
+    WHEN("it is expanded to RGBA and read by single rows") {
+      auto rgba_reader = img::expand_to_rgba(std::move(src));
+      std::vector<std::byte> rgba(rgba_reader.pixels_size());
+      for (int row = 0; row < sz.height; ++row)
+        rgba_reader.read_rows(std::span{rgba}.subspan(row * rgba_reader.row_size(), rgba_reader.row_size()));
+
+      THEN("RGBA image with the same colors is produced") {
+        CHECK(rgba_reader.format() == img::pixel_fmt::rgba);
+        std::vector<std::byte> expected(rgba.size());
+        img::rgb_to_rgba(rgb, expected);
+        CHECK(rgba == expected);
+      }
+    }
+
+    WHEN("transformation is applied while reading") {
+      std::vector<size_t> bands;
+      auto transformed = img::transform_rows(std::move(src), [&bands](std::span<std::byte> rows) {
+        bands.push_back(rows.size());
+        std::ranges::fill(rows, std::byte{0});
+      });
+      std::vector<std::byte> pixels(transformed.pixels_size(), std::byte{1});
+      transformed.read_pixels(pixels);
+
+      THEN("it sees every band decoded") {
+        CHECK(bands == std::vector<size_t>{pixels.size()});
+        CHECK(std::ranges::all_of(pixels, [](std::byte b) { return b == std::byte{0}; }));
+      }
+    }
+  }
+}
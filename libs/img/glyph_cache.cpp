@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+#include <libs/img/glyph_cache.hpp>
+
+namespace img {
+
+size_t glyph_cache::key_hash::operator()(const glyph_key& key) const noexcept {
+  size_t res = std::hash<const void*>{}(key.face);
+  res = res * 31 + key.pixel_size;
+  res = res * 31 + key.index;
+  return res * 2 + static_cast<size_t>(key.rendering);
+}
+
+glyph_cache::glyph_cache(::size cell_sz, ::size grid)
+    : cell_sz_{cell_sz}, columns_{grid.width}, rows_{grid.height} {
+  if (cell_sz.width <= 0 || cell_sz.height <= 0 || grid.width <= 0 || grid.height <= 0)
+    throw std::invalid_argument{"Bad glyph cache dimensions"};
+
+  const size_t pixels_count = static_cast<size_t>(size().width) * size().height;
+  pixels_.reset(new std::byte[pixels_count]{});
+  cells_.resize(static_cast<size_t>(columns_) * rows_);
+  for (size_t idx = 0; idx < cells_.size(); ++idx)
+    cells_[idx].lru_pos = lru_.insert(lru_.end(), idx);
+}
+
+std::span<const std::byte> glyph_cache::pixels() const noexcept {
+  return {pixels_.get(), static_cast<size_t>(size().width) * size().height};
+}
+
+const cached_glyph* glyph_cache::find(const glyph_key& key) noexcept {
+  const auto it = index_.find(key);
+  if (it == index_.end())
+    return nullptr;
+  auto& c = cells_[it->second];
+  touch(c);
+  return &c.glyph;
+}
+
+const cached_glyph& glyph_cache::insert(
+    const glyph_key& key, const glyph_metrics& metrics, std::span<const std::byte> bitmap, size_t pitch
+) {
+  if (metrics.bitmap.width > cell_sz_.width || metrics.bitmap.height > cell_sz_.height)
+    throw std::runtime_error{"Glyph doesn't fit into glyph cache cell"};
+
+  const size_t idx = lru_.back();
+  auto& c = cells_[idx];
+  if (c.key) {
+    if (c.epoch == epoch_)
+      throw std::runtime_error{"Glyph cache is too small to keep all glyphs of the text"};
+    index_.erase(*c.key);
+  }
+
+  const int32_t x = static_cast<int32_t>(idx % columns_) * cell_sz_.width;
+  const int32_t y = static_cast<int32_t>(idx / columns_) * cell_sz_.height;
+  const size_t stride = size().width;
+  for (int32_t row = 0; row < metrics.bitmap.height; ++row) {
+    const auto src = bitmap.subspan(row * pitch, metrics.bitmap.width);
+    std::ranges::copy(src, pixels_.get() + (y + row) * stride + x);
+  }
+
+  c.key = key;
+  c.glyph = {
+      .area = {.x = x, .y = y, .width = metrics.bitmap.width, .height = metrics.bitmap.height},
+      .metrics = metrics
+  };
+  index_[key] = idx;
+  touch(c);
+  return c.glyph;
+}
+
+void glyph_cache::touch(cell& c) noexcept {
+  c.epoch = epoch_;
+  lru_.splice(lru_.begin(), lru_, c.lru_pos);
+}
+
+} // namespace img
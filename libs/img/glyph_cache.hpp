@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include <libs/geom/geom.hpp>
+
+namespace img {
+
+enum class glyph_rendering : uint8_t {
+  /// Antialiased grayscale coverage of the glyph pixels.
+  coverage,
+  /// Signed distance to the glyph outline which is at 128.
+  distance_field
+};
+
+struct glyph_key {
+  const void* face = nullptr;
+  uint32_t pixel_size = 0;
+  uint32_t index = 0;
+  glyph_rendering rendering = glyph_rendering::coverage;
+
+  constexpr bool operator==(const glyph_key&) const noexcept = default;
+};
+
+struct glyph_metrics {
+  /// Bitmap offset from the pen position with Y axis pointing up.
+  int32_t left = 0;
+  int32_t top = 0;
+  int32_t advance = 0;
+  ::size bitmap;
+};
+
+struct cached_glyph {
+  /// Glyph bitmap location in the cache atlas.
+  rect area;
+  glyph_metrics metrics;
+};
+
+/// Grayscale atlas of rasterized glyphs split into a grid of equal cells.
+/// When all cells are occupied the least recently used glyph is evicted.
+///
+/// Glyphs used since the last `next_epoch` call are never evicted so that
+/// all glyphs of a text stay valid while it is laid out.
+class glyph_cache {
+public:
+  glyph_cache() noexcept = default;
+  glyph_cache(::size cell_sz, ::size grid);
+
+  const cached_glyph* find(const glyph_key& key) noexcept;
+  /// Copies glyph bitmap rows `pitch` bytes apart into a free or the least
+  /// recently used cell. Throws if the bitmap doesn't fit into a cell or all
+  /// cells are used in the current epoch.
+  const cached_glyph&
+  insert(const glyph_key& key, const glyph_metrics& metrics, std::span<const std::byte> bitmap, size_t pitch);
+
+  void next_epoch() noexcept { ++epoch_; }
+
+  ::size cell_size() const noexcept { return cell_sz_; }
+  ::size size() const noexcept {
+    return {.width = cell_sz_.width * columns_, .height = cell_sz_.height * rows_};
+  }
+  std::span<const std::byte> pixels() const noexcept;
+
+private:
+  struct key_hash {
+    size_t operator()(const glyph_key& key) const noexcept;
+  };
+
+  struct cell {
+    std::optional<glyph_key> key;
+    cached_glyph glyph;
+    uint64_t epoch = 0;
+    std::list<size_t>::iterator lru_pos;
+  };
+
+  void touch(cell& c) noexcept;
+
+private:
+  ::size cell_sz_;
+  int32_t columns_ = 0;
+  int32_t rows_ = 0;
+  uint64_t epoch_ = 1;
+  std::unique_ptr<std::byte[]> pixels_;
+  std::vector<cell> cells_;
+  // Cell indexes from the most to the least recently used one
+  std::list<size_t> lru_;
+  std::unordered_map<glyph_key, size_t, key_hash> index_;
+};
+
+} // namespace img
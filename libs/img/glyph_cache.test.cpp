@@ -0,0 +1,92 @@
+#include "glyph_cache.hpp"
+
+#include <stdexcept>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+
+int faces[2];
+
+img::glyph_key key(uint32_t index, int face = 0) {
+  return {.face = &faces[face], .pixel_size = 16, .index = index};
+}
+
+img::glyph_metrics metrics(size bitmap) {
+  return {.left = 1, .top = bitmap.height, .advance = 8, .bitmap = bitmap};
+}
+
+} // namespace
+
+SCENARIO("Glyph cache") {
+  GIVEN("cache with 2x2 grid of 4x5 cells") {
+    img::glyph_cache cache{{.width = 4, .height = 5}, {.width = 2, .height = 2}};
+    REQUIRE(cache.size() == size{.width = 8, .height = 10});
+
+    WHEN("glyph bitmap is inserted") {
+      const std::vector<std::byte> bitmap{
+          std::byte{1}, std::byte{2}, std::byte{3}, std::byte{0xff},
+          std::byte{4}, std::byte{5}, std::byte{6}, std::byte{0xff},
+      };
+      const auto& glyph = cache.insert(key(42), metrics({.width = 3, .height = 2}), bitmap, 4);
+
+      THEN("it is found by the same key") {
+        const auto* found = cache.find(key(42));
+        REQUIRE(found != nullptr);
+        CHECK(found->area == glyph.area);
+        CHECK(found->metrics.advance == 8);
+      }
+
+      THEN("it is not found for another face") { CHECK(cache.find(key(42, 1)) == nullptr); }
+
+      THEN("bitmap rows are copied into the atlas without pitch padding") {
+        const auto pixels = cache.pixels();
+        const size_t stride = cache.size().width;
+        const auto at = [&](int32_t x, int32_t y) {
+          return pixels[(glyph.area.y + y) * stride + glyph.area.x + x];
+        };
+        CHECK(at(0, 0) == std::byte{1});
+        CHECK(at(2, 0) == std::byte{3});
+        CHECK(at(3, 0) == std::byte{0});
+        CHECK(at(0, 1) == std::byte{4});
+        CHECK(at(2, 1) == std::byte{6});
+      }
+    }
+
+    WHEN("more glyphs than cells are inserted over several epochs") {
+      for (uint32_t idx = 0; idx < 4; ++idx)
+        cache.insert(key(idx), metrics({.width = 1, .height = 1}), std::vector{std::byte{1}}, 1);
+      cache.next_epoch();
+      cache.find(key(0));
+      cache.insert(key(4), metrics({.width = 1, .height = 1}), std::vector{std::byte{1}}, 1);
+
+      THEN("least recently used glyph is evicted") {
+        CHECK(cache.find(key(1)) == nullptr);
+        CHECK(cache.find(key(0)) != nullptr);
+        CHECK(cache.find(key(4)) != nullptr);
+      }
+    }
+
+    WHEN("more glyphs than cells are inserted within one epoch") {
+      for (uint32_t idx = 0; idx < 4; ++idx)
+        cache.insert(key(idx), metrics({.width = 1, .height = 1}), std::vector{std::byte{1}}, 1);
+
+      THEN("insertion fails instead of evicting glyph in use") {
+        CHECK_THROWS_AS(
+            cache.insert(key(4), metrics({.width = 1, .height = 1}), std::vector{std::byte{1}}, 1),
+            std::runtime_error
+        );
+      }
+    }
+
+    WHEN("glyph bigger than cell is inserted") {
+      THEN("insertion fails") {
+        const std::vector<std::byte> bitmap(30);
+        CHECK_THROWS_AS(
+            cache.insert(key(0), metrics({.width = 5, .height = 5}), bitmap, 5), std::runtime_error
+        );
+      }
+    }
+  }
+}
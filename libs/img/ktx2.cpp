@@ -0,0 +1,91 @@
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+#include <thinsys/io/span_io.hpp>
+
+#include <libs/img/ktx2.hpp>
+#include <libs/memtricks/object_bytes.hpp>
+
+namespace img::ktx2 {
+
+namespace {
+
+constexpr std::array<uint8_t, 12> identifier = {0xab, 0x4b, 0x54, 0x58, 0x20, 0x32,
+                                                0x30, 0xbb, 0x0d, 0x0a, 0x1a, 0x0a};
+
+struct header {
+  std::array<uint8_t, 12> identifier;
+  uint32_t vk_format;
+  uint32_t type_size;
+  uint32_t pixel_width;
+  uint32_t pixel_height;
+  uint32_t pixel_depth;
+  uint32_t layer_count;
+  uint32_t face_count;
+  uint32_t level_count;
+  uint32_t supercompression_scheme;
+
+  // Index
+  uint32_t dfd_byte_offset;
+  uint32_t dfd_byte_length;
+  uint32_t kvd_byte_offset;
+  uint32_t kvd_byte_length;
+  uint64_t sgd_byte_offset;
+  uint64_t sgd_byte_length;
+};
+static_assert(sizeof(header) == 80, "Paddings kills reading this struct");
+
+struct level_index {
+  uint64_t byte_offset;
+  uint64_t byte_length;
+  uint64_t uncompressed_byte_length;
+};
+static_assert(sizeof(level_index) == 24, "Paddings kills reading this struct");
+
+} // namespace
+
+bool is_ktx2(std::span<const std::byte> container) noexcept {
+  return container.size() >= identifier.size() &&
+         std::ranges::equal(container.first(identifier.size()), std::as_bytes(std::span{identifier}));
+}
+
+texture texture::parse(std::span<const std::byte> container) {
+  if (!is_ktx2(container))
+    throw std::runtime_error{"Not a KTX2 container"};
+
+  std::span<const std::byte> tail = container;
+  header hdr;
+  thinsys::io::read(tail, object_bytes(hdr));
+
+  if (hdr.vk_format == 0)
+    throw std::runtime_error{"KTX2 textures with VK_FORMAT_UNDEFINED are not supported"};
+  if (hdr.supercompression_scheme != 0)
+    throw std::runtime_error{"Supercompressed KTX2 textures are not supported"};
+  if (hdr.pixel_depth > 1 || hdr.layer_count > 1 || hdr.face_count != 1)
+    throw std::runtime_error{"Only 2D KTX2 textures are supported"};
+  if (hdr.pixel_width == 0 || hdr.pixel_height == 0)
+    throw std::runtime_error{"Bad KTX2 texture size"};
+
+  texture res;
+  res.vk_format_ = hdr.vk_format;
+  res.sz_ = {
+      .width = static_cast<int32_t>(hdr.pixel_width), .height = static_cast<int32_t>(hdr.pixel_height)
+  };
+
+  // Zero level count asks loader to generate mips. It still has base level
+  // data though.
+  const uint32_t levels = std::min(std::max(hdr.level_count, 1u), mip_levels(res.sz_));
+  res.levels_.reserve(levels);
+  for (uint32_t i = 0; i < levels; ++i) {
+    level_index idx;
+    thinsys::io::read(tail, object_bytes(idx));
+    if (idx.byte_offset > container.size() || idx.byte_length > container.size() - idx.byte_offset)
+      throw std::runtime_error{"KTX2 level data is out of container bounds"};
+    res.levels_.push_back(container.subspan(idx.byte_offset, idx.byte_length));
+  }
+
+  return res;
+}
+
+} // namespace img::ktx2
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <libs/geom/geom.hpp>
+#include <libs/img/mipmap.hpp>
+
+namespace img::ktx2 {
+
+/// 2D texture stored in KTX2 container:
+/// https://registry.khronos.org/KTX/specs/2.0/ktxspec.v2.html
+///
+/// Levels refer to the container bytes directly so the container must
+/// outlive the texture. Only single layer and single face textures without
+/// supercompression are supported which is enough to hand block compressed
+/// data to GPU as is.
+class texture {
+public:
+  texture() noexcept = default;
+
+  static texture parse(std::span<const std::byte> container);
+
+  /// VkFormat of the texture data.
+  uint32_t vk_format() const noexcept { return vk_format_; }
+  ::size size() const noexcept { return sz_; }
+
+  uint32_t levels() const noexcept { return static_cast<uint32_t>(levels_.size()); }
+  ::size level_size(uint32_t level) const noexcept { return mip_size(sz_, level); }
+  std::span<const std::byte> level(uint32_t level) const noexcept { return levels_[level]; }
+
+private:
+  uint32_t vk_format_ = 0;
+  ::size sz_;
+  std::vector<std::span<const std::byte>> levels_;
+};
+
+bool is_ktx2(std::span<const std::byte> container) noexcept;
+
+} // namespace img::ktx2
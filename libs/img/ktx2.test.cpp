@@ -0,0 +1,92 @@
+#include "ktx2.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+
+constexpr uint32_t vk_format_bc7_srgb_block = 146;
+
+void append(std::vector<std::byte>& buf, const auto& val) {
+  const auto* ptr = reinterpret_cast<const std::byte*>(&val);
+  buf.insert(buf.end(), ptr, ptr + sizeof(val));
+}
+
+// 8x4 BC7 texture with 4 levels taking 2, 1, 1 and 1 blocks of 16 bytes. Each
+// level is filled with its index.
+std::vector<std::byte> make_container(uint32_t supercompression = 0) {
+  const uint8_t identifier[] = {0xab, 0x4b, 0x54, 0x58, 0x20, 0x32, 0x30, 0xbb, 0x0d, 0x0a, 0x1a, 0x0a};
+  const uint64_t level_sizes[] = {32, 16, 16, 16};
+  constexpr uint64_t data_offset = 80 + 4 * 24;
+
+  std::vector<std::byte> res;
+  append(res, identifier);
+  for (uint32_t val : {vk_format_bc7_srgb_block, 1u, 8u, 4u, 0u, 0u, 1u, 4u, supercompression})
+    append(res, val);
+  for (uint32_t val : {0u, 0u, 0u, 0u})
+    append(res, val);
+  for (uint64_t val : {uint64_t{0}, uint64_t{0}})
+    append(res, val);
+
+  // Smaller levels are stored first
+  uint64_t level_end = data_offset + 32 + 3 * 16;
+  for (uint64_t level_size : level_sizes) {
+    level_end -= level_size;
+    for (uint64_t val : {level_end, level_size, level_size})
+      append(res, val);
+  }
+  for (uint8_t level = 4; level-- > 0;)
+    res.insert(res.end(), level_sizes[level], std::byte{level});
+  return res;
+}
+
+} // namespace
+
+SCENARIO("KTX2 container parsing") {
+  GIVEN("KTX2 container with block compressed mip chain") {
+    const auto container = make_container();
+
+    WHEN("it is parsed") {
+      const auto tex = img::ktx2::texture::parse(container);
+
+      THEN("texture properties are taken from the header") {
+        CHECK(tex.vk_format() == vk_format_bc7_srgb_block);
+        CHECK(tex.size() == size{.width = 8, .height = 4});
+        CHECK(tex.levels() == 4);
+      }
+
+      THEN("levels refer to the container data") {
+        for (uint32_t level = 0; level < tex.levels(); ++level) {
+          INFO("level: " << level);
+          CHECK(tex.level(level).data() >= container.data());
+          CHECK(tex.level(level).data() + tex.level(level).size() <= container.data() + container.size());
+          const auto is_level_index = [level](std::byte b) { return b == std::byte(level); };
+          CHECK(std::ranges::all_of(tex.level(level), is_level_index));
+        }
+        CHECK(tex.level(0).size() == 32);
+      }
+    }
+  }
+
+  GIVEN("truncated KTX2 container") {
+    auto container = make_container();
+    container.resize(container.size() - 1);
+
+    THEN("parsing fails") { CHECK_THROWS_AS(img::ktx2::texture::parse(container), std::runtime_error); }
+  }
+
+  GIVEN("supercompressed KTX2 container") {
+    const auto container = make_container(1);
+
+    THEN("parsing fails") { CHECK_THROWS_AS(img::ktx2::texture::parse(container), std::runtime_error); }
+  }
+
+  GIVEN("PNG signature") {
+    const uint8_t png[] = {0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0, 0, 0, 0};
+
+    THEN("it is not recognized as KTX2") { CHECK_FALSE(img::ktx2::is_ktx2(std::as_bytes(std::span{png}))); }
+  }
+}
@@ -5,6 +5,7 @@
 #include <png.h>
 
 #include <libs/geom/geom.hpp>
+#include <libs/img/qoi.hpp>
 
 namespace {
 namespace png {
@@ -38,7 +39,9 @@ reader load_reader(thinsys::io::file_descriptor& in) {
   std::array<std::byte, png::signature_size> sig;
   const auto read = thinsys::io::read(in, sig);
   if (read != sig.size())
-    throw std::runtime_error{"invalid png stream, premature end of file"};
+    throw std::runtime_error{"invalid image stream, premature end of file"};
+  if (qoi::is_qoi(sig))
+    return qoi::load_reader(in, sig);
   if (png_sig_cmp(reinterpret_cast<png_const_bytep>(sig.data()), 0, sig.size()) != 0)
     throw std::runtime_error{"invalid png stream, format signature verification failed"};
 
@@ -79,17 +82,16 @@ reader load_reader(thinsys::io::file_descriptor& in) {
 
   return {img_size, fmt, [png_struct = std::move(png_struct)](std::span<std::byte> dest) {
             const size_t row_sz = png_get_rowbytes(png_struct.get(), png_struct.get_deleter().info);
-            const uint32_t height = png_get_image_height(png_struct.get(), png_struct.get_deleter().info);
-            if (dest.size() < row_sz * height)
-              throw std::runtime_error{"Buffer too small"};
-
-            for (uint32_t row = 0; row < height; ++row) {
-              png_read_row(
-                  png_struct.get(), reinterpret_cast<png_bytep>(dest.data() + row * row_sz), nullptr
-              );
-            }
-            return height * row_sz;
+            for (size_t offset = 0; offset < dest.size(); offset += row_sz)
+              png_read_row(png_struct.get(), reinterpret_cast<png_bytep>(dest.data() + offset), nullptr);
           }};
 }
 
+any_image load_any(thinsys::io::file_descriptor& in) {
+  auto source = load_reader(in);
+  std::unique_ptr<std::byte[]> res{new std::byte[source.pixels_size()]};
+  source.read_pixels({res.get(), source.pixels_size()});
+  return any_image{std::move(res), source.size(), source.format()};
+}
+
 } // namespace img
@@ -11,6 +11,7 @@
 
 namespace img {
 
+/// Reads PNG or QOI image detecting the format by its signature.
 reader load_reader(thinsys::io::file_descriptor& in);
 
 template <pixel_fmt Fmt>
@@ -28,6 +29,25 @@ private:
   std::unique_ptr<std::byte[]> data_;
 };
 
+class any_image {
+public:
+  any_image() noexcept = default;
+  any_image(std::unique_ptr<std::byte[]> data, ::size sz, pixel_fmt fmt) noexcept
+      : sz_{sz}, fmt_{fmt}, data_{std::move(data)} {}
+
+  std::span<const std::byte> bytes() const noexcept { return {data_.get(), bytes_size(sz_, fmt_)}; }
+
+  ::size size() const noexcept { return sz_; }
+  pixel_fmt format() const noexcept { return fmt_; }
+
+private:
+  ::size sz_;
+  pixel_fmt fmt_ = pixel_fmt::rgba;
+  std::unique_ptr<std::byte[]> data_;
+};
+
+any_image load_any(thinsys::io::file_descriptor& in);
+
 template <pixel_fmt Fmt>
 image<Fmt> load(thinsys::io::file_descriptor& in) {
   auto source = load_reader(in);
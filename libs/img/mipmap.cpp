@@ -0,0 +1,190 @@
+#include <cassert>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include <libs/img/convert.hpp>
+#include <libs/img/mipmap.hpp>
+
+namespace img {
+
+namespace {
+
+constexpr size_t rgba_size = pixel_byte_size(pixel_fmt::rgba);
+
+using kernels = detail::downsample_kernels;
+
+namespace scalar {
+
+void box(const uint16_t* row0, const uint16_t* row1, uint16_t* dest, size_t width) noexcept {
+  for (size_t x = 0; x < width; ++x, row0 += 8, row1 += 8, dest += 4) {
+    uint32_t color[3] = {0, 0, 0};
+    uint32_t alpha = 0;
+    for (const uint16_t* texel : {row0, row0 + 4, row1, row1 + 4}) {
+      for (size_t c = 0; c < 3; ++c)
+        color[c] += uint32_t{texel[c]} * texel[3];
+      alpha += texel[3];
+    }
+    for (size_t c = 0; c < 3; ++c)
+      dest[c] = alpha == 0 ? 0 : static_cast<uint16_t>(color[c] / alpha);
+    dest[3] = static_cast<uint16_t>((alpha + 2) / 4);
+  }
+}
+
+constexpr kernels table{.isa = "scalar", .box = box};
+
+} // namespace scalar
+
+#if defined(__x86_64__) || defined(__i386__)
+
+namespace avx2 {
+
+// Sums of a pair of texels from each of the rows laid out as epi32 lanes with
+// color channels weighted by alpha and the alpha itself in all lanes.
+struct block_sums {
+  __m128i color;
+  __m128i alpha;
+};
+
+[[gnu::target("avx2")]] inline block_sums sum_block(const uint16_t* row0, const uint16_t* row1) noexcept {
+  const __m256i top = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row0)));
+  const __m256i bottom = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row1)));
+  const __m256i top_alpha = _mm256_shuffle_epi32(top, _MM_SHUFFLE(3, 3, 3, 3));
+  const __m256i bottom_alpha = _mm256_shuffle_epi32(bottom, _MM_SHUFFLE(3, 3, 3, 3));
+  const __m256i color =
+      _mm256_add_epi32(_mm256_mullo_epi32(top, top_alpha), _mm256_mullo_epi32(bottom, bottom_alpha));
+  const __m256i alpha = _mm256_add_epi32(top_alpha, bottom_alpha);
+  return {
+      .color = _mm_add_epi32(_mm256_castsi256_si128(color), _mm256_extracti128_si256(color, 1)),
+      .alpha = _mm_add_epi32(_mm256_castsi256_si128(alpha), _mm256_extracti128_si256(alpha, 1)),
+  };
+}
+
+// Sums fit into 26 bits so doubles hold them exactly and the truncated
+// quotient is the same as the one of integer division. Fully transparent
+// blocks divide zero by zero which converts to the negative integer
+// indefinite value saturated to zero when packed.
+[[gnu::target("avx2")]] inline __m128i average(block_sums sums) noexcept {
+  const __m128i quotient = _mm256_cvttpd_epi32(
+      _mm256_div_pd(_mm256_cvtepi32_pd(sums.color), _mm256_cvtepi32_pd(sums.alpha))
+  );
+  const __m128i alpha = _mm_srli_epi32(_mm_add_epi32(sums.alpha, _mm_set1_epi32(2)), 2);
+  return _mm_blend_epi32(quotient, alpha, 0b1000);
+}
+
+[[gnu::target("avx2")]] void
+box(const uint16_t* row0, const uint16_t* row1, uint16_t* dest, size_t width) noexcept {
+  size_t x = 0;
+  for (; x + 2 <= width; x += 2) {
+    const __m128i first = average(sum_block(row0 + 8 * x, row1 + 8 * x));
+    const __m128i second = average(sum_block(row0 + 8 * x + 8, row1 + 8 * x + 8));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 4 * x), _mm_packus_epi32(first, second));
+  }
+  scalar::box(row0 + 8 * x, row1 + 8 * x, dest + 4 * x, width - x);
+}
+
+constexpr kernels table{.isa = "avx2", .box = box};
+
+} // namespace avx2
+
+#endif
+
+// Integer division dominates the scalar filter. SSSE3 lacks 32 bit
+// multiplication and divides only pairs of doubles so only AVX2 gets a kernel.
+std::vector<const kernels*> select_kernels() {
+  std::vector<const kernels*> res{&scalar::table};
+#if defined(__x86_64__) || defined(__i386__)
+  if (__builtin_cpu_supports("avx2"))
+    res.push_back(&avx2::table);
+#endif
+  return res;
+}
+
+const kernels& active_kernels() noexcept { return *detail::supported_downsample_kernels().back(); }
+
+} // namespace
+
+mip_chain::mip_chain(::size base_sz) : mip_chain{base_sz, mip_levels(base_sz)} {}
+
+mip_chain::mip_chain(::size base_sz, uint32_t levels)
+    : sz_{base_sz}, levels_{std::clamp(levels, 1u, mip_levels(base_sz))} {
+  data_.reset(new std::byte[level_offset(levels_)]);
+}
+
+mip_chain mip_chain::decode(reader src) {
+  mip_chain res{src.size()};
+  expand_to_rgba(std::move(src)).read_pixels(res.level(0));
+  return res;
+}
+
+size_t mip_chain::level_offset(uint32_t level) const noexcept {
+  size_t res = 0;
+  for (uint32_t i = 0; i < level; ++i)
+    res += bytes_size(level_size(i), pixel_fmt::rgba);
+  return res;
+}
+
+std::span<std::byte> mip_chain::level(uint32_t level) noexcept {
+  assert(level < levels_);
+  return {data_.get() + level_offset(level), bytes_size(level_size(level), pixel_fmt::rgba)};
+}
+
+std::span<const std::byte> mip_chain::level(uint32_t level) const noexcept {
+  assert(level < levels_);
+  return {data_.get() + level_offset(level), bytes_size(level_size(level), pixel_fmt::rgba)};
+}
+
+std::span<const detail::downsample_kernels* const> detail::supported_downsample_kernels() noexcept {
+  static const std::vector<const downsample_kernels*> res = select_kernels();
+  return res;
+}
+
+std::string_view downsample_isa() noexcept { return active_kernels().isa; }
+
+void downsample_rows(
+    std::span<const std::byte> src, ::size src_sz, std::span<std::byte> dest, ::size dest_sz,
+    size_t first_row, size_t rows
+) {
+  downsample_rows(src, src_sz, dest, dest_sz, first_row, rows, active_kernels());
+}
+
+void downsample_rows(
+    std::span<const std::byte> src, ::size src_sz, std::span<std::byte> dest, ::size dest_sz,
+    size_t first_row, size_t rows, const detail::downsample_kernels& kern
+) {
+  const size_t src_stride = rgba_size * src_sz.width;
+  const size_t dest_stride = rgba_size * dest_sz.width;
+  assert(src.size() >= src_stride * src_sz.height);
+  assert(dest.size() >= dest_stride * (first_row + rows));
+
+  // Pairs of source rows are decoded to linear colors for the kernels to
+  // average. Odd trailing source row or column is dropped the same way GPU
+  // blits do while single row or column sources are sampled twice.
+  const auto width = static_cast<size_t>(dest_sz.width);
+  const size_t texels = std::min(2 * width, static_cast<size_t>(src_sz.width));
+  const size_t max_sy = src_sz.height - 1;
+  std::vector<uint16_t> linear[2] = {std::vector<uint16_t>(8 * width), std::vector<uint16_t>(8 * width)};
+  std::vector<uint16_t> averaged(4 * width);
+  for (size_t y = first_row; y < first_row + rows; ++y) {
+    for (size_t i = 0; i < 2; ++i) {
+      const std::byte* row = src.data() + std::min(2 * y + i, max_sy) * src_stride;
+      srgb_to_linear({row, rgba_size * texels}, linear[i]);
+      for (size_t x = 0; x < texels; ++x)
+        linear[i][rgba_size * x + 3] = std::to_integer<uint16_t>(row[rgba_size * x + 3]);
+      if (texels < 2 * width)
+        std::copy_n(linear[i].begin(), rgba_size, linear[i].begin() + rgba_size);
+    }
+
+    kern.box(linear[0].data(), linear[1].data(), averaged.data(), width);
+
+    // Colors of transparent texels are zero and stay such in sRGB
+    std::span<std::byte> out = dest.subspan(y * dest_stride, dest_stride);
+    linear_to_srgb(averaged, out);
+    for (size_t x = 0; x < width; ++x)
+      out[rgba_size * x + 3] = std::byte(averaged[rgba_size * x + 3]);
+  }
+}
+
+} // namespace img
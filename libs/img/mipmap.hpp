@@ -0,0 +1,101 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string_view>
+
+#include <libs/geom/geom.hpp>
+#include <libs/img/parallel.hpp>
+#include <libs/img/reader.hpp>
+
+namespace img {
+
+/// Number of levels in the full mip chain of an image down to 1x1 size.
+constexpr uint32_t mip_levels(size sz) noexcept {
+  return std::bit_width(static_cast<unsigned>(std::max({sz.width, sz.height, 1})));
+}
+
+constexpr size mip_size(size sz, uint32_t level) noexcept {
+  return {.width = std::max(sz.width >> level, 1), .height = std::max(sz.height >> level, 1)};
+}
+
+/// RGBA image with all its mip levels stored one after another in a single
+/// buffer ready to be uploaded to GPU at once.
+class mip_chain {
+public:
+  mip_chain() noexcept = default;
+  explicit mip_chain(::size base_sz);
+  /// Chain which is cut after `levels` levels if the full one is longer.
+  mip_chain(::size base_sz, uint32_t levels);
+
+  /// Reads the base level from `src` converting it to RGBA if needed. Other
+  /// levels are left uninitialized until `generate_mips` is called.
+  static mip_chain decode(reader src);
+
+  uint32_t levels() const noexcept { return levels_; }
+  ::size level_size(uint32_t level) const noexcept { return mip_size(sz_, level); }
+  size_t level_offset(uint32_t level) const noexcept;
+
+  std::span<std::byte> level(uint32_t level) noexcept;
+  std::span<const std::byte> level(uint32_t level) const noexcept;
+
+  std::span<const std::byte> bytes() const noexcept { return {data_.get(), level_offset(levels_)}; }
+
+private:
+  ::size sz_;
+  uint32_t levels_ = 0;
+  std::unique_ptr<std::byte[]> data_;
+};
+
+namespace detail {
+
+struct downsample_kernels {
+  std::string_view isa;
+  /// Averages 2x2 blocks of texels from a pair of rows into `width` texels.
+  /// Texels hold three linear 16 bit colors followed by the alpha. Colors
+  /// are weighted by alpha and the result alpha is rounded.
+  void (*box)(const uint16_t* row0, const uint16_t* row1, uint16_t* dest, size_t width) noexcept;
+};
+
+/// Kernels the current CPU is able to run starting from the scalar ones.
+/// The last of them are used for downsampling.
+std::span<const downsample_kernels* const> supported_downsample_kernels() noexcept;
+
+} // namespace detail
+
+/// Name of the instruction set the downsampling kernels were selected for at
+/// startup: "avx2" or "scalar".
+std::string_view downsample_isa() noexcept;
+
+/// Computes `rows` rows of RGBA `dest` level starting from `first_row` out of
+/// the previous `src` level with 2x2 box filter. Colors are averaged in linear
+/// space weighted by alpha so that transparent texels do not darken edges.
+void downsample_rows(
+    std::span<const std::byte> src, ::size src_sz, std::span<std::byte> dest, ::size dest_sz,
+    size_t first_row, size_t rows
+);
+/// Same as above with the given kernels instead of the selected ones.
+void downsample_rows(
+    std::span<const std::byte> src, ::size src_sz, std::span<std::byte> dest, ::size dest_sz,
+    size_t first_row, size_t rows, const detail::downsample_kernels& kern
+);
+
+/// Fills all levels of the chain but the base one. Each level is split into
+/// bands of rows processed concurrently on the `exec`.
+template <typename Executor>
+void generate_mips(const Executor& exec, mip_chain& chain) {
+  constexpr size_t band_bytes = 64 * 1024;
+  for (uint32_t level = 1; level < chain.levels(); ++level) {
+    const ::size src_sz = chain.level_size(level - 1);
+    const ::size dest_sz = chain.level_size(level);
+    const size_t band_rows = band_bytes / (4 * dest_sz.width);
+    parallel_rows(exec, dest_sz.height, band_rows, [&](size_t first_row, size_t rows) {
+      downsample_rows(chain.level(level - 1), src_sz, chain.level(level), dest_sz, first_row, rows);
+    });
+  }
+}
+
+} // namespace img
@@ -0,0 +1,165 @@
+#include "mipmap.hpp"
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <span>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+namespace {
+
+std::array<std::byte, 4> pixel(uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+  return {std::byte{r}, std::byte{g}, std::byte{b}, std::byte{a}};
+}
+
+std::vector<std::byte> fill(size sz, std::array<std::byte, 4> px) {
+  std::vector<std::byte> res;
+  for (int i = 0; i < sz.width * sz.height; ++i)
+    res.insert(res.end(), px.begin(), px.end());
+  return res;
+}
+
+std::vector<std::byte> downsample(
+    std::span<const std::byte> src, size src_sz, const img::detail::downsample_kernels& kern
+) {
+  const size dest_sz = img::mip_size(src_sz, 1);
+  std::vector<std::byte> res(4 * dest_sz.width * dest_sz.height);
+  img::downsample_rows(src, src_sz, res, dest_sz, 0, dest_sz.height, kern);
+  return res;
+}
+
+} // namespace
+
+SCENARIO("Mip chain layout") {
+  GIVEN("non square image size") {
+    const size sz{.width = 13, .height = 4};
+
+    THEN("chain goes down to 1x1 level") {
+      CHECK(img::mip_levels(sz) == 4);
+      CHECK(img::mip_size(sz, 1) == size{.width = 6, .height = 2});
+      CHECK(img::mip_size(sz, 3) == size{.width = 1, .height = 1});
+    }
+
+    WHEN("mip chain is allocated") {
+      img::mip_chain chain{sz};
+
+      THEN("levels are stored one after another") {
+        CHECK(chain.level_offset(1) == 13 * 4 * 4);
+        CHECK(chain.level(1).data() == chain.level(0).data() + chain.level(0).size());
+        CHECK(chain.bytes().size() == 4 * (13 * 4 + 6 * 2 + 3 * 1 + 1 * 1));
+      }
+    }
+  }
+}
+
+SCENARIO("Downsampling of mip levels") {
+  GIVEN("uniform half transparent image of odd size") {
+    const size src_sz{.width = 5, .height = 3};
+    const auto src = fill(src_sz, pixel(200, 100, 50, 128));
+
+    WHEN("the next level is computed") {
+      const size dest_sz = img::mip_size(src_sz, 1);
+      std::vector<std::byte> dest(4 * dest_sz.width * dest_sz.height);
+      img::downsample_rows(src, src_sz, dest, dest_sz, 0, dest_sz.height);
+
+      THEN("the color is preserved") { CHECK(dest == fill(dest_sz, pixel(200, 100, 50, 128))); }
+    }
+  }
+
+  GIVEN("image with opaque red and fully transparent black columns") {
+    const size src_sz{.width = 2, .height = 2};
+    std::vector<std::byte> src;
+    for (int row = 0; row < 2; ++row) {
+      std::ranges::copy(pixel(255, 0, 0, 255), std::back_inserter(src));
+      std::ranges::copy(pixel(0, 0, 0, 0), std::back_inserter(src));
+    }
+
+    WHEN("the next level is computed") {
+      std::vector<std::byte> dest(4);
+      img::downsample_rows(src, src_sz, dest, {.width = 1, .height = 1}, 0, 1);
+
+      THEN("transparent texels do not darken the color") {
+        CHECK(std::ranges::equal(dest, pixel(255, 0, 0, 128)));
+      }
+    }
+  }
+
+  GIVEN("image of black and white stripes") {
+    const size src_sz{.width = 2, .height = 1};
+    std::vector<std::byte> src;
+    std::ranges::copy(pixel(0, 0, 0, 255), std::back_inserter(src));
+    std::ranges::copy(pixel(255, 255, 255, 255), std::back_inserter(src));
+
+    WHEN("the next level is computed") {
+      std::vector<std::byte> dest(4);
+      img::downsample_rows(src, src_sz, dest, {.width = 1, .height = 1}, 0, 1);
+
+      THEN("colors are averaged in linear space") {
+        // Naive average of sRGB values would give 128
+        CHECK(std::ranges::equal(dest, pixel(187, 187, 187, 255)));
+      }
+    }
+  }
+}
+
+SCENARIO("Mip level downsampling kernels for different instruction sets") {
+  const auto supported = img::detail::supported_downsample_kernels();
+  REQUIRE(supported.front()->isa == "scalar");
+  CHECK(supported.back()->isa == img::downsample_isa());
+
+  GIVEN("image of odd size with transparent and opaque texels") {
+    const size src_sz = GENERATE(
+        size{.width = 39, .height = 11}, size{.width = 36, .height = 7}, size{.width = 1, .height = 9}
+    );
+    // Every third row is transparent and every fifth texel is opaque
+    const auto alpha = [&](size_t texel) -> size_t {
+      if (texel / src_sz.width % 3 == 0)
+        return 0;
+      return texel % 5 == 0 ? 255 : texel * 29 % 256;
+    };
+    std::vector<std::byte> src(4 * src_sz.width * src_sz.height);
+    for (size_t i = 0; i < src.size(); ++i)
+      src[i] = std::byte(i % 4 != 3 ? i * 67 % 256 : alpha(i / 4));
+
+    WHEN("the next level is computed with each of the supported kernels") {
+      const auto expected = downsample(src, src_sz, *supported.front());
+
+      THEN("all of them produce the same texels as the scalar ones") {
+        for (const auto* kern : supported) {
+          INFO("isa: " << kern->isa << ", size: " << src_sz.width << "x" << src_sz.height);
+          CHECK(downsample(src, src_sz, *kern) == expected);
+        }
+      }
+    }
+  }
+
+  GIVEN("rows of linear texels with extreme colors and alphas") {
+    constexpr size_t width = 257;
+    std::vector<uint16_t> rows[2] = {std::vector<uint16_t>(8 * width), std::vector<uint16_t>(8 * width)};
+    // Blocks of every third pair of texels are fully transparent
+    for (size_t i = 0; i < 8 * width; ++i) {
+      const size_t block = i / 8;
+      const size_t top_alpha = block % 3 == 0 ? 0 : block % 256;
+      const size_t bottom_alpha = block % 3 == 0 ? 0 : 255 - i / 4 % 256;
+      rows[0][i] = static_cast<uint16_t>(i % 4 != 3 ? 65535 - i * 251 % 1024 : top_alpha);
+      rows[1][i] = static_cast<uint16_t>(i % 4 != 3 ? i * 4093 % 65536 : bottom_alpha);
+    }
+
+    WHEN("they are averaged with each of the supported kernels") {
+      std::vector<uint16_t> expected(4 * width);
+      supported.front()->box(rows[0].data(), rows[1].data(), expected.data(), width);
+
+      THEN("all of them produce the same texels as the scalar ones") {
+        for (const auto* kern : supported) {
+          INFO("isa: " << kern->isa);
+          std::vector<uint16_t> averaged(4 * width);
+          kern->box(rows[0].data(), rows[1].data(), averaged.data(), width);
+          CHECK(averaged == expected);
+        }
+      }
+    }
+  }
+}
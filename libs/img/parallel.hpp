@@ -0,0 +1,49 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <memory>
+
+#include <asio/post.hpp>
+
+namespace img {
+
+/// Splits `rows` into bands of `band_rows` and calls `fn(first_row, rows)` for
+/// each of them concurrently on the `exec`. Returns once all bands are
+/// processed. The calling thread takes bands as well so it is safe to call
+/// this function from a task running on the same executor. `fn` must not
+/// throw.
+template <typename Executor, std::invocable<size_t, size_t> F>
+void parallel_rows(const Executor& exec, size_t rows, size_t band_rows, F&& fn) {
+  band_rows = std::max<size_t>(band_rows, 1);
+  const size_t bands = (rows + band_rows - 1) / band_rows;
+  if (bands <= 1) {
+    if (rows > 0)
+      fn(size_t{0}, rows);
+    return;
+  }
+
+  struct progress {
+    std::atomic<size_t> next = 0;
+    std::atomic<size_t> done = 0;
+  };
+  // Helpers may start after all bands are processed and this function
+  // returned. They must find no bands left in that case and never touch `fn`.
+  auto state = std::make_shared<progress>();
+  auto work = [state, &fn, rows, band_rows, bands] {
+    for (size_t band; (band = state->next.fetch_add(1)) < bands;) {
+      const size_t first = band * band_rows;
+      fn(first, std::min(band_rows, rows - first));
+      if (state->done.fetch_add(1) + 1 == bands)
+        state->done.notify_all();
+    }
+  };
+  for (size_t i = 1; i < bands; ++i)
+    asio::post(exec, work);
+  work();
+  for (size_t done = state->done.load(); done < bands; done = state->done.load())
+    state->done.wait(done);
+}
+
+} // namespace img
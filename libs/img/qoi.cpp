@@ -0,0 +1,294 @@
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+#include <thinsys/io/input.hpp>
+
+#include <libs/img/qoi.hpp>
+
+namespace img::qoi {
+
+namespace {
+
+constexpr std::array<std::byte, magic_size> magic = {
+    std::byte{'q'}, std::byte{'o'}, std::byte{'i'}, std::byte{'f'}
+};
+constexpr size_t header_size = 14;
+constexpr std::array<std::byte, 8> end_marker = {std::byte{0}, std::byte{0}, std::byte{0}, std::byte{0},
+                                                 std::byte{0}, std::byte{0}, std::byte{0}, std::byte{1}};
+// Limit from the reference implementation protecting from bogus headers
+constexpr size_t max_pixels = 400'000'000;
+
+constexpr uint8_t op_index = 0x00;
+constexpr uint8_t op_diff = 0x40;
+constexpr uint8_t op_luma = 0x80;
+constexpr uint8_t op_run = 0xc0;
+constexpr uint8_t op_rgb = 0xfe;
+constexpr uint8_t op_rgba = 0xff;
+constexpr uint8_t op_mask = 0xc0;
+
+constexpr size_t max_chunk_size = 5;
+constexpr size_t max_run = 62;
+
+struct pixel {
+  uint8_t r = 0;
+  uint8_t g = 0;
+  uint8_t b = 0;
+  uint8_t a = 255;
+
+  constexpr bool operator==(const pixel&) const noexcept = default;
+};
+
+constexpr size_t index_position(pixel px) noexcept {
+  return (px.r * 3 + px.g * 5 + px.b * 7 + px.a * 11) % 64;
+}
+
+uint32_t read_be32(const std::byte* data) noexcept {
+  return std::to_integer<uint32_t>(data[0]) << 24 | std::to_integer<uint32_t>(data[1]) << 16 |
+         std::to_integer<uint32_t>(data[2]) << 8 | std::to_integer<uint32_t>(data[3]);
+}
+
+void write_be32(std::vector<std::byte>& out, uint32_t val) {
+  for (int shift = 24; shift >= 0; shift -= 8)
+    out.push_back(static_cast<std::byte>(val >> shift));
+}
+
+[[noreturn]] void premature_end() { throw std::runtime_error{"invalid qoi stream, premature end of data"}; }
+
+class byte_source {
+public:
+  explicit byte_source(std::span<const std::byte> data) noexcept : data_{data} {}
+  byte_source(thinsys::io::file_descriptor& in, std::span<const std::byte> consumed)
+      : in_{&in}, buf_(buffer_size) {
+    std::ranges::copy(consumed, buf_.begin());
+    data_ = std::span{buf_}.first(consumed.size());
+  }
+
+  /// Returns unread bytes which are at least `count` long.
+  std::span<const std::byte> ensure(size_t count) {
+    if (data_.size() >= count)
+      return data_;
+    if (in_ == nullptr)
+      premature_end();
+
+    std::memmove(buf_.data(), data_.data(), data_.size());
+    size_t filled = data_.size();
+    while (filled < count) {
+      const size_t read = thinsys::io::read(*in_, std::span{buf_}.subspan(filled));
+      if (read == 0)
+        premature_end();
+      filled += read;
+    }
+    data_ = std::span{buf_}.first(filled);
+    return data_;
+  }
+
+  void consume(size_t count) noexcept { data_ = data_.subspan(count); }
+
+private:
+  static constexpr size_t buffer_size = 64 * 1024;
+
+  thinsys::io::file_descriptor* in_ = nullptr;
+  std::vector<std::byte> buf_;
+  std::span<const std::byte> data_;
+};
+
+template <size_t Channels>
+std::byte* fill_run(std::byte* out, size_t count, pixel px) noexcept {
+  // Long runs are filled by blocks of pixels which compiles into a few vector
+  // stores instead of a store per pixel.
+  constexpr size_t block_pixels = 16;
+  if (count >= block_pixels) {
+    std::array<std::byte, block_pixels * Channels> block;
+    for (size_t i = 0; i < block_pixels; ++i)
+      std::memcpy(block.data() + i * Channels, &px, Channels);
+    for (; count >= block_pixels; count -= block_pixels, out += block.size())
+      std::memcpy(out, block.data(), block.size());
+  }
+  for (; count > 0; --count, out += Channels)
+    std::memcpy(out, &px, Channels);
+  return out;
+}
+
+class decoder {
+public:
+  explicit decoder(byte_source src) : src_{std::move(src)} {}
+
+  template <size_t Channels>
+  void decode(std::span<std::byte> dest) {
+    std::byte* out = dest.data();
+    std::byte* const out_end = out + dest.size();
+
+    std::span<const std::byte> in;
+    const std::byte* pos = nullptr;
+    const std::byte* chunks_end = nullptr;
+    while (out < out_end) {
+      if (run_ > 0) {
+        const size_t count = std::min<size_t>(run_, (out_end - out) / Channels);
+        out = fill_run<Channels>(out, count, px_);
+        run_ -= count;
+        continue;
+      }
+
+      if (pos >= chunks_end) {
+        src_.consume(pos - in.data());
+        in = src_.ensure(max_chunk_size);
+        pos = in.data();
+        // Any chunk can be started while there are enough bytes for the
+        // longest one.
+        chunks_end = pos + in.size() - max_chunk_size + 1;
+      }
+
+      const auto op = std::to_integer<uint8_t>(*pos++);
+      if (op == op_rgb) {
+        px_.r = std::to_integer<uint8_t>(*pos++);
+        px_.g = std::to_integer<uint8_t>(*pos++);
+        px_.b = std::to_integer<uint8_t>(*pos++);
+      } else if (op == op_rgba) {
+        px_.r = std::to_integer<uint8_t>(*pos++);
+        px_.g = std::to_integer<uint8_t>(*pos++);
+        px_.b = std::to_integer<uint8_t>(*pos++);
+        px_.a = std::to_integer<uint8_t>(*pos++);
+      } else {
+        switch (op & op_mask) {
+        case op_index:
+          px_ = index_[op];
+          break;
+        case op_diff:
+          px_.r += ((op >> 4) & 0x03) - 2;
+          px_.g += ((op >> 2) & 0x03) - 2;
+          px_.b += (op & 0x03) - 2;
+          break;
+        case op_luma: {
+          const auto drb = std::to_integer<uint8_t>(*pos++);
+          const int dg = (op & 0x3f) - 32;
+          px_.r += dg - 8 + ((drb >> 4) & 0x0f);
+          px_.g += dg;
+          px_.b += dg - 8 + (drb & 0x0f);
+        } break;
+        case op_run:
+          run_ = (op & 0x3f) + 1;
+          break;
+        }
+      }
+      index_[index_position(px_)] = px_;
+
+      if (run_ == 0) {
+        std::memcpy(out, &px_, Channels);
+        out += Channels;
+      }
+    }
+    src_.consume(pos - in.data());
+  }
+
+private:
+  byte_source src_;
+  std::array<pixel, 64> index_{};
+  pixel px_;
+  size_t run_ = 0;
+};
+
+reader make_reader(byte_source src) {
+  const auto header = src.ensure(header_size);
+  if (!is_qoi(header))
+    throw std::runtime_error{"invalid qoi stream, format signature verification failed"};
+
+  const ::size sz{
+      .width = static_cast<int32_t>(read_be32(header.data() + 4)),
+      .height = static_cast<int32_t>(read_be32(header.data() + 8))
+  };
+  if (sz.width <= 0 || sz.height <= 0 || static_cast<size_t>(sz.width) * sz.height > max_pixels)
+    throw std::runtime_error{"invalid qoi stream, bad image size"};
+
+  const auto channels = std::to_integer<uint8_t>(header[12]);
+  src.consume(header_size);
+
+  switch (channels) {
+  case 3:
+    return {sz, pixel_fmt::rgb, [dec = decoder{std::move(src)}](std::span<std::byte> dest) mutable {
+              dec.decode<3>(dest);
+            }};
+  case 4:
+    return {sz, pixel_fmt::rgba, [dec = decoder{std::move(src)}](std::span<std::byte> dest) mutable {
+              dec.decode<4>(dest);
+            }};
+  }
+  throw std::runtime_error{"invalid qoi stream, bad channels count"};
+}
+
+} // namespace
+
+bool is_qoi(std::span<const std::byte> data) noexcept {
+  return data.size() >= magic.size() && std::ranges::equal(data.first(magic.size()), magic);
+}
+
+reader load_reader(thinsys::io::file_descriptor& in, std::span<const std::byte> consumed) {
+  return make_reader(byte_source{in, consumed});
+}
+
+reader decode_reader(std::span<const std::byte> data) { return make_reader(byte_source{data}); }
+
+std::vector<std::byte> encode(std::span<const std::byte> pixels, ::size sz, pixel_fmt fmt) {
+  const size_t channels = pixel_byte_size(fmt);
+  if (fmt != pixel_fmt::rgb && fmt != pixel_fmt::rgba)
+    throw std::runtime_error{"Only RGB and RGBA images can be encoded as qoi"};
+  if (pixels.size() < bytes_size(sz, fmt))
+    throw std::runtime_error{"Not enough pixels to encode"};
+
+  std::vector<std::byte> res;
+  res.reserve(header_size + bytes_size(sz, fmt) + end_marker.size());
+  res.insert(res.end(), magic.begin(), magic.end());
+  write_be32(res, sz.width);
+  write_be32(res, sz.height);
+  res.push_back(static_cast<std::byte>(channels));
+  // All channels are sRGB encoded
+  res.push_back(std::byte{0});
+
+  std::array<pixel, 64> index{};
+  pixel prev;
+  size_t run = 0;
+  const size_t count = static_cast<size_t>(sz.width) * sz.height;
+  const auto emit = [&res](auto... bytes) { (res.push_back(static_cast<std::byte>(bytes)), ...); };
+  for (size_t i = 0; i < count; ++i) {
+    pixel px;
+    std::memcpy(&px, pixels.data() + i * channels, channels);
+
+    if (px == prev) {
+      if (++run == max_run || i + 1 == count) {
+        emit(op_run | (run - 1));
+        run = 0;
+      }
+      continue;
+    }
+    if (run > 0) {
+      emit(op_run | (run - 1));
+      run = 0;
+    }
+
+    const size_t pos = index_position(px);
+    if (index[pos] == px) {
+      emit(op_index | pos);
+    } else if (px.a != prev.a) {
+      emit(op_rgba, px.r, px.g, px.b, px.a);
+    } else {
+      const int8_t dr = static_cast<int8_t>(px.r - prev.r);
+      const int8_t dg = static_cast<int8_t>(px.g - prev.g);
+      const int8_t db = static_cast<int8_t>(px.b - prev.b);
+      const int8_t dr_dg = static_cast<int8_t>(dr - dg);
+      const int8_t db_dg = static_cast<int8_t>(db - dg);
+      if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1)
+        emit(op_diff | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2));
+      else if (dg >= -32 && dg <= 31 && dr_dg >= -8 && dr_dg <= 7 && db_dg >= -8 && db_dg <= 7)
+        emit(op_luma | (dg + 32), (dr_dg + 8) << 4 | (db_dg + 8));
+      else
+        emit(op_rgb, px.r, px.g, px.b);
+    }
+    index[pos] = px;
+    prev = px;
+  }
+  res.insert(res.end(), end_marker.begin(), end_marker.end());
+  return res;
+}
+
+} // namespace img::qoi
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include <thinsys/io/io.hpp>
+
+#include <libs/geom/geom.hpp>
+#include <libs/img/pixel_fmt.hpp>
+#include <libs/img/reader.hpp>
+
+/// The Quite OK Image format: https://qoiformat.org/qoi-specification.pdf
+namespace img::qoi {
+
+constexpr size_t magic_size = 4;
+
+bool is_qoi(std::span<const std::byte> data) noexcept;
+
+/// Reads QOI image from the stream. Bytes of the stream which were already
+/// consumed in order to detect image format are passed as `consumed`.
+/// Stream must outlive the reader.
+reader load_reader(thinsys::io::file_descriptor& in, std::span<const std::byte> consumed = {});
+
+/// Reads QOI image from memory which must outlive the reader.
+reader decode_reader(std::span<const std::byte> data);
+
+std::vector<std::byte> encode(std::span<const std::byte> pixels, ::size sz, pixel_fmt fmt);
+
+} // namespace img::qoi
@@ -0,0 +1,71 @@
+#include "qoi.hpp"
+
+#include <stdexcept>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+
+// Horizontal gradient interrupted with long solid runs crossing row ends and
+// a few pixels changing only alpha so that all QOI chunk types are used.
+std::vector<std::byte> make_pixels(size sz, img::pixel_fmt fmt) {
+  const size_t channels = img::pixel_byte_size(fmt);
+  std::vector<std::byte> res;
+  res.reserve(img::bytes_size(sz, fmt));
+  for (int y = 0; y < sz.height; ++y) {
+    for (int x = 0; x < sz.width; ++x) {
+      const bool solid = (y * sz.width + x) % 97 < 70;
+      const uint8_t val = solid ? 42 : static_cast<uint8_t>(x * 3 + y);
+      const uint8_t pixel[] = {val, static_cast<uint8_t>(val + y % 7), static_cast<uint8_t>(255 - val),
+                               static_cast<uint8_t>(x % 5 == 0 ? 128 : 255)};
+      for (size_t c = 0; c < channels; ++c)
+        res.push_back(std::byte{pixel[c]});
+    }
+  }
+  return res;
+}
+
+} // namespace
+
+SCENARIO("QOI images encoding and decoding") {
+  const size sz{.width = 33, .height = 17};
+
+  for (const auto fmt : {img::pixel_fmt::rgb, img::pixel_fmt::rgba}) {
+    GIVEN("QOI encoded image with " << img::pixel_byte_size(fmt) << " channels") {
+      const auto pixels = make_pixels(sz, fmt);
+      const auto encoded = img::qoi::encode(pixels, sz, fmt);
+
+      THEN("it is recognized as QOI") { CHECK(img::qoi::is_qoi(encoded)); }
+
+      WHEN("it is decoded at once") {
+        auto reader = img::qoi::decode_reader(encoded);
+        std::vector<std::byte> decoded(reader.pixels_size());
+        reader.read_pixels(decoded);
+
+        THEN("original image is restored") {
+          CHECK(reader.size() == sz);
+          CHECK(reader.format() == fmt);
+          CHECK(decoded == pixels);
+        }
+      }
+
+      WHEN("it is decoded row by row") {
+        auto reader = img::qoi::decode_reader(encoded);
+        std::vector<std::byte> decoded(reader.pixels_size());
+        std::span<std::byte> dest = decoded;
+        while (reader.rows_left() > 0)
+          dest = dest.subspan(reader.read_rows(dest.first(reader.row_size())) * reader.row_size());
+
+        THEN("original image is restored") { CHECK(decoded == pixels); }
+      }
+
+      WHEN("truncated stream is decoded") {
+        auto reader = img::qoi::decode_reader(std::span{encoded}.first(encoded.size() / 2));
+        std::vector<std::byte> decoded(reader.pixels_size());
+
+        THEN("decoding fails") { CHECK_THROWS_AS(reader.read_pixels(decoded), std::runtime_error); }
+      }
+    }
+  }
+}
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <algorithm>
 #include <functional>
 #include <span>
+#include <stdexcept>
 
 #include <libs/img/pixel_fmt.hpp>
 
@@ -9,21 +11,53 @@ namespace img {
 
 class reader {
 public:
+  /// Fills the next `dest.size() / row_size()` rows of the image. Reader
+  /// guarantees that destination is never empty, always contains whole rows
+  /// and never exceeds the number of rows left.
+  using read_rows_function = std::move_only_function<void(std::span<std::byte>)>;
+
   reader() noexcept = default;
-  reader(::size sz, pixel_fmt fmt, std::move_only_function<size_t(std::span<std::byte>)> read_pixels)
-      : read_pixels_{std::move(read_pixels)}, sz_{sz}, fmt_{fmt} {}
+  reader(::size sz, pixel_fmt fmt, read_rows_function read_rows)
+      : read_rows_{std::move(read_rows)}, sz_{sz}, fmt_{fmt} {}
 
   ::size size() const noexcept { return sz_; }
   pixel_fmt format() const noexcept { return fmt_; }
 
   size_t pixels_size() const noexcept { return bytes_size(sz_, fmt_); }
-
-  size_t read_pixels(std::span<std::byte> dest) { return read_pixels_(dest); }
+  size_t row_size() const noexcept { return sz_.width * pixel_byte_size(fmt_); }
+
+  size_t rows_read() const noexcept { return rows_read_; }
+  size_t rows_left() const noexcept { return sz_.height - rows_read_; }
+
+  /// Reads as many whole rows as fit into `dest`. Returns the number of rows
+  /// read, zero means that either image is read completely or `dest` is
+  /// smaller than a single row. Rows of zero width image are all skipped at
+  /// once.
+  size_t read_rows(std::span<std::byte> dest) {
+    if (row_size() == 0) {
+      const size_t count = rows_left();
+      rows_read_ = sz_.height;
+      return count;
+    }
+    const size_t count = std::min(dest.size() / row_size(), rows_left());
+    if (count == 0)
+      return 0;
+    read_rows_(dest.first(count * row_size()));
+    rows_read_ += count;
+    return count;
+  }
+
+  size_t read_pixels(std::span<std::byte> dest) {
+    if (dest.size() < rows_left() * row_size())
+      throw std::runtime_error{"Buffer too small"};
+    return read_rows(dest) * row_size();
+  }
 
 private:
-  std::move_only_function<size_t(std::span<std::byte>)> read_pixels_;
+  read_rows_function read_rows_;
   ::size sz_;
   pixel_fmt fmt_;
+  size_t rows_read_ = 0;
 };
 
 } // namespace img
@@ -0,0 +1,85 @@
+#include "reader.hpp"
+
+#include <numeric>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+
+img::reader make_counting_reader(size sz) {
+  return {sz, img::pixel_fmt::grayscale, [next = 0](std::span<std::byte> dest) mutable {
+            for (std::byte& b : dest)
+              b = static_cast<std::byte>(next++);
+          }};
+}
+
+} // namespace
+
+SCENARIO("Reading image by bands of rows") {
+  GIVEN("reader of 4x10 grayscale image") {
+    auto reader = make_counting_reader({.width = 4, .height = 10});
+
+    WHEN("buffer for 3 rows is used to read rows") {
+      std::vector<std::byte> buf(3 * reader.row_size());
+      const size_t rows = reader.read_rows(buf);
+
+      THEN("3 rows are read") {
+        CHECK(rows == 3);
+        CHECK(reader.rows_read() == 3);
+        CHECK(reader.rows_left() == 7);
+      }
+
+      AND_WHEN("the rest of the image is read by the same buffer") {
+        std::vector<size_t> bands;
+        while (const size_t count = reader.read_rows(buf))
+          bands.push_back(count);
+
+        THEN("last band is truncated to the image height") { CHECK(bands == std::vector<size_t>{3, 3, 1}); }
+        THEN("nothing is left") { CHECK(reader.rows_left() == 0); }
+      }
+    }
+
+    WHEN("buffer smaller than a single row is used") {
+      std::vector<std::byte> buf(reader.row_size() - 1);
+
+      THEN("nothing is read") {
+        CHECK(reader.read_rows(buf) == 0);
+        CHECK(reader.rows_read() == 0);
+      }
+    }
+
+    WHEN("the first band is read and the rest is read with read_pixels") {
+      std::vector<std::byte> pixels(reader.pixels_size());
+      reader.read_rows(std::span{pixels}.first(2 * reader.row_size()));
+      reader.read_pixels(std::span{pixels}.subspan(2 * reader.row_size()));
+
+      THEN("all pixels are read in order") {
+        std::vector<std::byte> expected(reader.pixels_size());
+        std::ranges::generate(expected, [n = 0]() mutable { return static_cast<std::byte>(n++); });
+        CHECK(pixels == expected);
+      }
+    }
+
+    WHEN("read_pixels is called with too small buffer") {
+      std::vector<std::byte> pixels(reader.pixels_size() - 1);
+
+      THEN("exception is thrown") { CHECK_THROWS_AS(reader.read_pixels(pixels), std::runtime_error); }
+    }
+  }
+
+  GIVEN("reader of zero width image") {
+    auto reader = make_counting_reader({.width = 0, .height = 10});
+
+    WHEN("rows are read") {
+      std::vector<std::byte> buf(16);
+      const size_t rows = reader.read_rows(buf);
+
+      THEN("all of them are skipped at once") {
+        CHECK(rows == 10);
+        CHECK(reader.rows_left() == 0);
+        CHECK(reader.read_rows(buf) == 0);
+      }
+    }
+  }
+}
@@ -0,0 +1,373 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <numbers>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include <libs/img/resample.hpp>
+
+namespace img {
+
+namespace {
+
+constexpr int precision = 14;
+constexpr int32_t one = 1 << precision;
+constexpr int32_t rounding = 1 << (precision - 1);
+
+using detail::filter_taps;
+using kernels = detail::resample_kernels;
+
+double sinc(double x) noexcept {
+  if (x == 0.)
+    return 1.;
+  x *= std::numbers::pi;
+  return std::sin(x) / x;
+}
+
+double filter_weight(resample_filter filter, double x) noexcept {
+  x = std::abs(x);
+  switch (filter) {
+  case resample_filter::bilinear:
+    return x < 1. ? 1. - x : 0.;
+  case resample_filter::lanczos3:
+    return x < 3. ? sinc(x) * sinc(x / 3.) : 0.;
+  }
+  return 0.;
+}
+
+double filter_support(resample_filter filter) noexcept {
+  return filter == resample_filter::bilinear ? 1. : 3.;
+}
+
+namespace scalar {
+
+std::byte to_channel(int32_t acc) noexcept { return std::byte(std::clamp(acc >> precision, 0, 255)); }
+
+void horizontal(const std::byte* src, std::byte* dest, size_t width, const filter_taps& taps) noexcept {
+  for (size_t x = 0; x < width; ++x, dest += 4) {
+    const std::byte* px = src + 4 * taps.first[x];
+    const int16_t* weights = taps.weights + x * taps.stride;
+    int32_t acc[4] = {rounding, rounding, rounding, rounding};
+    for (int32_t k = 0; k < taps.count[x]; ++k, px += 4) {
+      for (size_t c = 0; c < 4; ++c)
+        acc[c] += std::to_integer<int32_t>(px[c]) * weights[k];
+    }
+    for (size_t c = 0; c < 4; ++c)
+      dest[c] = to_channel(acc[c]);
+  }
+}
+
+void vertical(
+    const std::byte* const* rows, const int16_t* weights, size_t count, std::byte* dest, size_t begin,
+    size_t end
+) noexcept {
+  for (size_t i = begin; i < end; ++i) {
+    int32_t acc = rounding;
+    for (size_t k = 0; k < count; ++k)
+      acc += std::to_integer<int32_t>(rows[k][i]) * weights[k];
+    dest[i] = to_channel(acc);
+  }
+}
+
+constexpr kernels table{.isa = "scalar", .horizontal = horizontal, .vertical = vertical};
+
+} // namespace scalar
+
+#if defined(__x86_64__) || defined(__i386__)
+
+namespace ssse3 {
+
+// Both halves of each 32 bit lane are multiplied with their own weight and
+// summed up by madd. Pixels are spread so that a lane holds the same channel
+// of two neighbour pixels.
+[[gnu::target("ssse3")]] inline __m128i weight_pair(const int16_t* weights, bool has_second) noexcept {
+  const auto first = static_cast<uint16_t>(weights[0]);
+  const auto second = has_second ? static_cast<uint16_t>(weights[1]) : uint16_t{0};
+  return _mm_set1_epi32(static_cast<int32_t>(first | static_cast<uint32_t>(second) << 16));
+}
+
+[[gnu::target("ssse3")]] inline __m128i
+accumulate_tail(__m128i acc, const std::byte* px, const int16_t* weights, int32_t k, int32_t count) noexcept {
+  const __m128i pair_shuffle = _mm_setr_epi8(0, -1, 4, -1, 1, -1, 5, -1, 2, -1, 6, -1, 3, -1, 7, -1);
+  const __m128i single_shuffle = _mm_setr_epi8(0, -1, -1, -1, 1, -1, -1, -1, 2, -1, -1, -1, 3, -1, -1, -1);
+  for (; k + 2 <= count; k += 2) {
+    const __m128i pixels =
+        _mm_shuffle_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(px + 4 * k)), pair_shuffle);
+    acc = _mm_add_epi32(acc, _mm_madd_epi16(pixels, weight_pair(weights + k, true)));
+  }
+  if (k < count) {
+    int32_t pixel;
+    std::memcpy(&pixel, px + 4 * k, sizeof(pixel));
+    const __m128i pixels = _mm_shuffle_epi8(_mm_cvtsi32_si128(pixel), single_shuffle);
+    acc = _mm_add_epi32(acc, _mm_madd_epi16(pixels, weight_pair(weights + k, false)));
+  }
+  return acc;
+}
+
+[[gnu::target("ssse3")]] inline void store_pixel(std::byte* dest, __m128i acc) noexcept {
+  acc = _mm_srai_epi32(acc, precision);
+  acc = _mm_packus_epi16(_mm_packs_epi32(acc, acc), acc);
+  const int32_t pixel = _mm_cvtsi128_si32(acc);
+  std::memcpy(dest, &pixel, sizeof(pixel));
+}
+
+[[gnu::target("ssse3")]] void
+horizontal(const std::byte* src, std::byte* dest, size_t width, const filter_taps& taps) noexcept {
+  for (size_t x = 0; x < width; ++x) {
+    const __m128i acc = accumulate_tail(
+        _mm_set1_epi32(rounding), src + 4 * taps.first[x], taps.weights + x * taps.stride, 0, taps.count[x]
+    );
+    store_pixel(dest + 4 * x, acc);
+  }
+}
+
+[[gnu::target("ssse3")]] void vertical(
+    const std::byte* const* rows, const int16_t* weights, size_t count, std::byte* dest, size_t begin,
+    size_t end
+) noexcept {
+  const __m128i zero = _mm_setzero_si128();
+  size_t i = begin;
+  for (; i + 16 <= end; i += 16) {
+    __m128i acc[4] = {
+        _mm_set1_epi32(rounding), _mm_set1_epi32(rounding), _mm_set1_epi32(rounding),
+        _mm_set1_epi32(rounding)
+    };
+    // Rows are taken in pairs with interleaved bytes so that madd sums up
+    // both of them at once
+    for (size_t k = 0; k < count; k += 2) {
+      const bool has_second = k + 1 < count;
+      const __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[k] + i));
+      const __m128i second =
+          has_second ? _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[k + 1] + i)) : zero;
+      const __m128i w = weight_pair(weights + k, has_second);
+      const __m128i lo = _mm_unpacklo_epi8(first, second);
+      const __m128i hi = _mm_unpackhi_epi8(first, second);
+      acc[0] = _mm_add_epi32(acc[0], _mm_madd_epi16(_mm_unpacklo_epi8(lo, zero), w));
+      acc[1] = _mm_add_epi32(acc[1], _mm_madd_epi16(_mm_unpackhi_epi8(lo, zero), w));
+      acc[2] = _mm_add_epi32(acc[2], _mm_madd_epi16(_mm_unpacklo_epi8(hi, zero), w));
+      acc[3] = _mm_add_epi32(acc[3], _mm_madd_epi16(_mm_unpackhi_epi8(hi, zero), w));
+    }
+    for (auto& val : acc)
+      val = _mm_srai_epi32(val, precision);
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i*>(dest + i),
+        _mm_packus_epi16(_mm_packs_epi32(acc[0], acc[1]), _mm_packs_epi32(acc[2], acc[3]))
+    );
+  }
+  scalar::vertical(rows, weights, count, dest, i, end);
+}
+
+constexpr kernels table{.isa = "ssse3", .horizontal = horizontal, .vertical = vertical};
+
+} // namespace ssse3
+
+namespace avx2 {
+
+[[gnu::target("avx2")]] inline __m256i weight_quad(const int16_t* weights) noexcept {
+  int32_t lo;
+  int32_t hi;
+  std::memcpy(&lo, weights, sizeof(lo));
+  std::memcpy(&hi, weights + 2, sizeof(hi));
+  return _mm256_set_m128i(_mm_set1_epi32(hi), _mm_set1_epi32(lo));
+}
+
+[[gnu::target("avx2")]] void
+horizontal(const std::byte* src, std::byte* dest, size_t width, const filter_taps& taps) noexcept {
+  // Each 128 bit lane takes its own pair out of four loaded pixels
+  const __m256i quad_shuffle = _mm256_setr_epi8(
+      0, -1, 4, -1, 1, -1, 5, -1, 2, -1, 6, -1, 3, -1, 7, -1, //
+      8, -1, 12, -1, 9, -1, 13, -1, 10, -1, 14, -1, 11, -1, 15, -1
+  );
+  for (size_t x = 0; x < width; ++x) {
+    const std::byte* px = src + 4 * taps.first[x];
+    const int16_t* weights = taps.weights + x * taps.stride;
+    const int32_t count = taps.count[x];
+    __m256i acc = _mm256_setzero_si256();
+    int32_t k = 0;
+    for (; k + 4 <= count; k += 4) {
+      const __m256i pixels = _mm256_shuffle_epi8(
+          _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(px + 4 * k))),
+          quad_shuffle
+      );
+      acc = _mm256_add_epi32(acc, _mm256_madd_epi16(pixels, weight_quad(weights + k)));
+    }
+    const __m128i sum = _mm_add_epi32(
+        _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1)), _mm_set1_epi32(rounding)
+    );
+    ssse3::store_pixel(dest + 4 * x, ssse3::accumulate_tail(sum, px, weights, k, count));
+  }
+}
+
+[[gnu::target("avx2")]] void vertical(
+    const std::byte* const* rows, const int16_t* weights, size_t count, std::byte* dest, size_t begin,
+    size_t end
+) noexcept {
+  // Unpacks and packs work within 128 bit lanes and undo each other so the
+  // byte order is preserved.
+  const __m256i zero = _mm256_setzero_si256();
+  size_t i = begin;
+  for (; i + 32 <= end; i += 32) {
+    __m256i acc[4] = {
+        _mm256_set1_epi32(rounding), _mm256_set1_epi32(rounding), _mm256_set1_epi32(rounding),
+        _mm256_set1_epi32(rounding)
+    };
+    for (size_t k = 0; k < count; k += 2) {
+      const bool has_second = k + 1 < count;
+      const __m256i first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows[k] + i));
+      const __m256i second =
+          has_second ? _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows[k + 1] + i)) : zero;
+      const __m256i w = _mm256_broadcastsi128_si256(ssse3::weight_pair(weights + k, has_second));
+      const __m256i lo = _mm256_unpacklo_epi8(first, second);
+      const __m256i hi = _mm256_unpackhi_epi8(first, second);
+      acc[0] = _mm256_add_epi32(acc[0], _mm256_madd_epi16(_mm256_unpacklo_epi8(lo, zero), w));
+      acc[1] = _mm256_add_epi32(acc[1], _mm256_madd_epi16(_mm256_unpackhi_epi8(lo, zero), w));
+      acc[2] = _mm256_add_epi32(acc[2], _mm256_madd_epi16(_mm256_unpacklo_epi8(hi, zero), w));
+      acc[3] = _mm256_add_epi32(acc[3], _mm256_madd_epi16(_mm256_unpackhi_epi8(hi, zero), w));
+    }
+    for (auto& val : acc)
+      val = _mm256_srai_epi32(val, precision);
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i*>(dest + i),
+        _mm256_packus_epi16(_mm256_packs_epi32(acc[0], acc[1]), _mm256_packs_epi32(acc[2], acc[3]))
+    );
+  }
+  ssse3::vertical(rows, weights, count, dest, i, end);
+}
+
+constexpr kernels table{.isa = "avx2", .horizontal = horizontal, .vertical = vertical};
+
+} // namespace avx2
+
+#endif
+
+// Compilers vectorize the scalar vertical pass well on other architectures
+std::vector<const kernels*> select_kernels() {
+  std::vector<const kernels*> res{&scalar::table};
+#if defined(__x86_64__) || defined(__i386__)
+  if (__builtin_cpu_supports("ssse3"))
+    res.push_back(&ssse3::table);
+  if (__builtin_cpu_supports("avx2"))
+    res.push_back(&avx2::table);
+#endif
+  return res;
+}
+
+const kernels& active_kernels() noexcept { return *detail::supported_resample_kernels().back(); }
+
+} // namespace
+
+std::span<const detail::resample_kernels* const> detail::supported_resample_kernels() noexcept {
+  static const std::vector<const resample_kernels*> res = select_kernels();
+  return res;
+}
+
+std::string_view resample_isa() noexcept { return active_kernels().isa; }
+
+resampler::resampler(::size src_sz, ::size dest_sz, resample_filter filter)
+    : src_sz_{src_sz}, dest_sz_{dest_sz}, horizontal_{make_taps(src_sz.width, dest_sz.width, filter)},
+      vertical_{make_taps(src_sz.height, dest_sz.height, filter)} {}
+
+// Filter is stretched when downscaling so that every source pixel contributes
+// to the result.
+resampler::taps resampler::make_taps(int32_t src_len, int32_t dest_len, resample_filter filter) {
+  taps res;
+  if (src_len <= 0 || dest_len <= 0)
+    return res;
+
+  const double scale = static_cast<double>(src_len) / dest_len;
+  const double filter_scale = std::max(scale, 1.);
+  const double support = filter_support(filter) * filter_scale;
+  res.stride = static_cast<size_t>(std::ceil(support)) * 2 + 1;
+  res.first.resize(dest_len);
+  res.count.resize(dest_len);
+  res.weights.resize(dest_len * res.stride);
+
+  std::vector<double> weights(res.stride);
+  for (int32_t i = 0; i < dest_len; ++i) {
+    const double center = (i + 0.5) * scale;
+    const int32_t first = std::max(static_cast<int32_t>(center - support + 0.5), 0);
+    const int32_t count = std::min(static_cast<int32_t>(center + support + 0.5), src_len) - first;
+    assert(count > 0 && static_cast<size_t>(count) <= res.stride);
+
+    double total = 0.;
+    for (int32_t k = 0; k < count; ++k)
+      total += weights[k] = filter_weight(filter, (first + k - center + 0.5) / filter_scale);
+
+    // Rounding error goes to the heaviest tap so that weights sum up to one
+    // exactly and flat areas stay flat.
+    int16_t* fixed = res.weights.data() + i * res.stride;
+    int32_t sum = 0;
+    int32_t heaviest = 0;
+    for (int32_t k = 0; k < count; ++k) {
+      fixed[k] = static_cast<int16_t>(std::lround(weights[k] / total * one));
+      sum += fixed[k];
+      if (std::abs(fixed[k]) > std::abs(fixed[heaviest]))
+        heaviest = k;
+    }
+    fixed[heaviest] = static_cast<int16_t>(fixed[heaviest] + one - sum);
+    res.first[i] = first;
+    res.count[i] = count;
+  }
+  return res;
+}
+
+void resampler::resample_rows(
+    std::span<const std::byte> src, std::span<std::byte> dest, size_t first_row, size_t rows
+) const {
+  resample_rows(src, dest, first_row, rows, active_kernels());
+}
+
+void resampler::resample_rows(
+    std::span<const std::byte> src, std::span<std::byte> dest, size_t first_row, size_t rows,
+    const detail::resample_kernels& kern
+) const {
+  if (rows == 0 || dest_sz_.width <= 0)
+    return;
+  assert(src.size() >= 4 * static_cast<size_t>(src_sz_.width) * src_sz_.height);
+  assert(dest.size() >= 4 * static_cast<size_t>(dest_sz_.width) * dest_sz_.height);
+
+  const size_t src_row_bytes = 4 * static_cast<size_t>(src_sz_.width);
+  const size_t row_bytes = 4 * static_cast<size_t>(dest_sz_.width);
+
+  // Source rows used by the band are scaled horizontally first unless the
+  // width stays the same in which case they are used as is.
+  const int32_t src_first = vertical_.first[first_row];
+  int32_t src_last = src_first;
+  for (size_t row = first_row; row < first_row + rows; ++row)
+    src_last = std::max(src_last, vertical_.first[row] + vertical_.count[row]);
+
+  std::vector<std::byte> band;
+  const std::byte* band_rows = src.data() + src_first * src_row_bytes;
+  if (src_sz_.width != dest_sz_.width) {
+    band.resize((src_last - src_first) * row_bytes);
+    const filter_taps taps{
+        .first = horizontal_.first.data(),
+        .count = horizontal_.count.data(),
+        .weights = horizontal_.weights.data(),
+        .stride = horizontal_.stride
+    };
+    for (int32_t y = src_first; y < src_last; ++y) {
+      kern.horizontal(
+          src.data() + y * src_row_bytes, band.data() + (y - src_first) * row_bytes, dest_sz_.width, taps
+      );
+    }
+    band_rows = band.data();
+  }
+
+  std::vector<const std::byte*> taps_rows(vertical_.stride);
+  for (size_t row = first_row; row < first_row + rows; ++row) {
+    const auto count = static_cast<size_t>(vertical_.count[row]);
+    for (size_t k = 0; k < count; ++k)
+      taps_rows[k] = band_rows + (vertical_.first[row] - src_first + k) * row_bytes;
+    kern.vertical(
+        taps_rows.data(), vertical_.weights.data() + row * vertical_.stride, count,
+        dest.data() + row * row_bytes, 0, row_bytes
+    );
+  }
+}
+
+} // namespace img
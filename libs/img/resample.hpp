@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include <libs/geom/geom.hpp>
+#include <libs/img/parallel.hpp>
+
+namespace img {
+
+enum class resample_filter { bilinear, lanczos3 };
+
+namespace detail {
+
+struct filter_taps {
+  const int32_t* first;
+  const int32_t* count;
+  const int16_t* weights;
+  size_t stride;
+};
+
+struct resample_kernels {
+  std::string_view isa;
+  /// Filters a row of 4 byte pixels producing `width` pixels.
+  void (*horizontal)(const std::byte* src, std::byte* dest, size_t width, const filter_taps& taps) noexcept;
+  /// Computes bytes in [begin, end) of the `dest` row as weighted sum of the
+  /// `count` source rows.
+  void (*vertical)(
+      const std::byte* const* rows, const int16_t* weights, size_t count, std::byte* dest, size_t begin,
+      size_t end
+  ) noexcept;
+};
+
+/// Kernels the current CPU is able to run starting from the scalar ones.
+/// The last of them are used for resampling.
+std::span<const resample_kernels* const> supported_resample_kernels() noexcept;
+
+} // namespace detail
+
+/// Name of the instruction set the resampling kernels were selected for at
+/// startup: "avx2", "ssse3" or "scalar".
+std::string_view resample_isa() noexcept;
+
+/// Scales images of 4 byte pixels with a separable filter. All channels are
+/// filtered the same way so pixels must have premultiplied alpha for
+/// transparent ones not to bleed their color into neighbours. Weights are
+/// computed once for the pair of sizes and applied in 14 bit fixed point.
+class resampler {
+public:
+  resampler(::size src_sz, ::size dest_sz, resample_filter filter = resample_filter::lanczos3);
+
+  ::size src_size() const noexcept { return src_sz_; }
+  ::size dest_size() const noexcept { return dest_sz_; }
+
+  /// Computes `rows` rows of the `dest` image starting from `first_row`.
+  /// Only source rows covered by the filter around them are read.
+  void resample_rows(
+      std::span<const std::byte> src, std::span<std::byte> dest, size_t first_row, size_t rows
+  ) const;
+  /// Same as above with the given kernels instead of the selected ones.
+  void resample_rows(
+      std::span<const std::byte> src, std::span<std::byte> dest, size_t first_row, size_t rows,
+      const detail::resample_kernels& kern
+  ) const;
+
+private:
+  struct taps {
+    // First source pixel and number of pixels contributing to each
+    // destination one
+    std::vector<int32_t> first;
+    std::vector<int32_t> count;
+    // `stride` weights per destination pixel summing up to 1 << 14
+    std::vector<int16_t> weights;
+    size_t stride = 0;
+  };
+
+  static taps make_taps(int32_t src_len, int32_t dest_len, resample_filter filter);
+
+private:
+  ::size src_sz_;
+  ::size dest_sz_;
+  taps horizontal_;
+  taps vertical_;
+};
+
+/// Scales the whole `src` image into `dest` splitting it into bands of rows
+/// processed concurrently on the `exec`.
+template <typename Executor>
+void resample(
+    const Executor& exec, const resampler& scaler, std::span<const std::byte> src, std::span<std::byte> dest
+) {
+  constexpr size_t band_bytes = 256 * 1024;
+  const ::size dest_sz = scaler.dest_size();
+  if (dest_sz.width <= 0 || dest_sz.height <= 0)
+    return;
+  parallel_rows(exec, dest_sz.height, band_bytes / (4 * dest_sz.width), [&](size_t first_row, size_t rows) {
+    scaler.resample_rows(src, dest, first_row, rows);
+  });
+}
+
+} // namespace img
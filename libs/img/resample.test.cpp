@@ -0,0 +1,129 @@
+#include "resample.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+namespace {
+
+std::vector<std::byte> make_image(size sz, auto&& pixel) {
+  std::vector<std::byte> res(4 * sz.width * sz.height);
+  for (int32_t y = 0; y < sz.height; ++y) {
+    for (int32_t x = 0; x < sz.width; ++x) {
+      for (int32_t c = 0; c < 4; ++c)
+        res[4 * (y * sz.width + x) + c] = std::byte(pixel(x, y, c));
+    }
+  }
+  return res;
+}
+
+std::vector<std::byte> resample(const std::vector<std::byte>& src, size src_sz, size dest_sz, auto filter) {
+  const img::resampler scaler{src_sz, dest_sz, filter};
+  std::vector<std::byte> res(4 * dest_sz.width * dest_sz.height);
+  scaler.resample_rows(src, res, 0, dest_sz.height);
+  return res;
+}
+
+std::vector<std::byte> resample(
+    const std::vector<std::byte>& src, const img::resampler& scaler, const img::detail::resample_kernels& kern
+) {
+  const size dest_sz = scaler.dest_size();
+  std::vector<std::byte> res(4 * dest_sz.width * dest_sz.height);
+  scaler.resample_rows(src, res, 0, dest_sz.height, kern);
+  return res;
+}
+
+} // namespace
+
+SCENARIO("Image resampling") {
+  constexpr size src_sz{.width = 40, .height = 12};
+  const auto filter = GENERATE(img::resample_filter::bilinear, img::resample_filter::lanczos3);
+
+  GIVEN("image with distinct pixels") {
+    const auto src = make_image(src_sz, [](int32_t x, int32_t y, int32_t c) { return x * 5 + y * 3 + c; });
+
+    WHEN("it is resampled to the same size") {
+      const auto res = resample(src, src_sz, src_sz, filter);
+
+      THEN("pixels are left intact") { CHECK(res == src); }
+    }
+
+    WHEN("it is resampled by bands of rows") {
+      constexpr size dest_sz{.width = 57, .height = 29};
+      const img::resampler scaler{src_sz, dest_sz, filter};
+      std::vector<std::byte> res(4 * dest_sz.width * dest_sz.height);
+      for (int32_t row = 0; row < dest_sz.height; row += 4)
+        scaler.resample_rows(src, res, row, std::min(4, dest_sz.height - row));
+
+      THEN("result is the same as resampling at once") {
+        CHECK(res == resample(src, src_sz, dest_sz, filter));
+      }
+    }
+  }
+
+  GIVEN("image filled with a single color") {
+    const auto src = make_image(src_sz, [](int32_t, int32_t, int32_t c) { return 50 + 60 * c; });
+
+    WHEN("it is scaled up and down") {
+      const size dest_sz = GENERATE(size{.width = 97, .height = 31}, size{.width = 13, .height = 5});
+      const auto res = resample(src, src_sz, dest_sz, filter);
+
+      THEN("all pixels keep the color") {
+        CHECK(res == make_image(dest_sz, [](int32_t, int32_t, int32_t c) { return 50 + 60 * c; }));
+      }
+    }
+  }
+
+  GIVEN("horizontal gradient") {
+    const auto src = make_image(src_sz, [](int32_t x, int32_t, int32_t) { return 5 * x; });
+
+    WHEN("it is scaled down twice with the bilinear filter") {
+      constexpr size dest_sz{.width = src_sz.width / 2, .height = src_sz.height / 2};
+      const auto res = resample(src, src_sz, dest_sz, img::resample_filter::bilinear);
+
+      THEN("pixels away from edges are averages of source pixel pairs") {
+        const auto expected = make_image(dest_sz, [](int32_t x, int32_t, int32_t) { return 10 * x + 3; });
+        for (int32_t y = 0; y < dest_sz.height; ++y) {
+          const auto row_begin = 4 * (y * dest_sz.width + 1);
+          const auto row_end = 4 * ((y + 1) * dest_sz.width - 1);
+          CHECK(std::ranges::equal(
+              std::span{res}.subspan(row_begin, row_end - row_begin),
+              std::span{expected}.subspan(row_begin, row_end - row_begin)
+          ));
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("Resampling kernels for different instruction sets") {
+  const auto supported = img::detail::supported_resample_kernels();
+  REQUIRE(supported.front()->isa == "scalar");
+  CHECK(supported.back()->isa == img::resample_isa());
+
+  GIVEN("image of odd size with sharp edges between pixels") {
+    constexpr size src_sz{.width = 37, .height = 11};
+    const auto src = make_image(src_sz, [](int32_t x, int32_t y, int32_t c) {
+      return (x * 67 + y * 29 + c * 101) % 256;
+    });
+    const auto filter = GENERATE(img::resample_filter::bilinear, img::resample_filter::lanczos3);
+    const size dest_sz = GENERATE(
+        size{.width = 61, .height = 23}, size{.width = 17, .height = 5}, size{.width = 37, .height = 19},
+        size{.width = 1, .height = 1}
+    );
+    const img::resampler scaler{src_sz, dest_sz, filter};
+
+    WHEN("it is resampled with each of the supported kernels") {
+      const auto expected = resample(src, scaler, *supported.front());
+
+      THEN("all of them produce the same pixels as the scalar ones including edge rows and columns") {
+        for (const auto* kern : supported) {
+          INFO("isa: " << kern->isa << ", size: " << dest_sz.width << "x" << dest_sz.height);
+          CHECK(resample(src, scaler, *kern) == expected);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,138 @@
+#include "sdf.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace img {
+
+namespace {
+
+constexpr float infinity = std::numeric_limits<float>::infinity();
+constexpr std::byte coverage_threshold{128};
+
+// Scratch buffers of the one dimensional transform reused between lines
+struct line_transform {
+  explicit line_transform(size_t len) : f(len), d(len), v(len), z(len + 1) {}
+
+  // Felzenszwalb & Huttenlocher lower envelope of parabolas rooted at each
+  // sample of `f`. Resulting squared distances are written to `d`.
+  void operator()() noexcept {
+    const int n = static_cast<int>(f.size());
+    int k = 0;
+    v[0] = 0;
+    z[0] = -infinity;
+    z[1] = infinity;
+    for (int q = 1; q < n; ++q) {
+      if (f[q] == infinity)
+        continue;
+      if (f[v[0]] == infinity) {
+        v[0] = q;
+        continue;
+      }
+      float s;
+      while ((s = intersection(q, v[k])) <= z[k])
+        --k;
+      ++k;
+      v[k] = q;
+      z[k] = s;
+      z[k + 1] = infinity;
+    }
+
+    if (f[v[0]] == infinity) {
+      std::ranges::fill(d, infinity);
+      return;
+    }
+    k = 0;
+    for (int q = 0; q < n; ++q) {
+      while (z[k + 1] < q)
+        ++k;
+      const float dq = static_cast<float>(q - v[k]);
+      d[q] = dq * dq + f[v[k]];
+    }
+  }
+
+  float intersection(int q, int p) const noexcept {
+    return ((f[q] + static_cast<float>(q) * q) - (f[p] + static_cast<float>(p) * p)) / (2.f * (q - p));
+  }
+
+  std::vector<float> f;
+  std::vector<float> d;
+  std::vector<int> v;
+  std::vector<float> z;
+};
+
+// Squared distances to the nearest pixel of the shape for pixels outside of
+// it and to the nearest background pixel for pixels inside.
+struct squared_distances {
+  explicit squared_distances(::size sz)
+      : outside(static_cast<size_t>(sz.width) * sz.height), inside(outside.size()) {}
+
+  std::vector<float> outside;
+  std::vector<float> inside;
+};
+
+// First pass of the separable Euclidean distance transform along columns
+void distance_field_columns(
+    std::span<const std::byte> coverage, ::size sz, squared_distances& dist
+) noexcept {
+  assert(coverage.size() >= static_cast<size_t>(sz.width) * sz.height);
+  const size_t stride = sz.width;
+  line_transform outside{static_cast<size_t>(sz.height)};
+  line_transform inside{static_cast<size_t>(sz.height)};
+  for (size_t x = 0; x < stride; ++x) {
+    for (size_t y = 0; y < static_cast<size_t>(sz.height); ++y) {
+      const bool in_shape = coverage[y * stride + x] >= coverage_threshold;
+      outside.f[y] = in_shape ? 0.f : infinity;
+      inside.f[y] = in_shape ? infinity : 0.f;
+    }
+    outside();
+    inside();
+    for (size_t y = 0; y < static_cast<size_t>(sz.height); ++y) {
+      dist.outside[y * stride + x] = outside.d[y];
+      dist.inside[y * stride + x] = inside.d[y];
+    }
+  }
+}
+
+// Second pass along rows mapping signed distances into bytes
+void distance_field_rows(
+    squared_distances& dist, ::size sz, int32_t spread, std::span<std::byte> dest
+) noexcept {
+  assert(dest.size() >= static_cast<size_t>(sz.width) * sz.height);
+  const size_t stride = sz.width;
+  line_transform outside{stride};
+  line_transform inside{stride};
+  const float scale = 127.5f / static_cast<float>(std::max(spread, 1));
+  for (size_t y = 0; y < static_cast<size_t>(sz.height); ++y) {
+    const auto row_outside = std::span{dist.outside}.subspan(y * stride, stride);
+    const auto row_inside = std::span{dist.inside}.subspan(y * stride, stride);
+    std::ranges::copy(row_outside, outside.f.begin());
+    std::ranges::copy(row_inside, inside.f.begin());
+    outside();
+    inside();
+    for (size_t x = 0; x < stride; ++x) {
+      // Boundary lies half way between inside and outside pixels
+      const float inside_dist = std::max(std::sqrt(inside.d[x]) - 0.5f, 0.f);
+      const float outside_dist = std::max(std::sqrt(outside.d[x]) - 0.5f, 0.f);
+      const float val = 127.5f + scale * (inside_dist - outside_dist);
+      dest[y * stride + x] = std::byte(static_cast<uint8_t>(std::lround(std::clamp(val, 0.f, 255.f))));
+    }
+  }
+}
+
+} // namespace
+
+void distance_field(
+    std::span<const std::byte> coverage, ::size sz, int32_t spread, std::span<std::byte> dest
+) {
+  if (sz.width <= 0 || sz.height <= 0)
+    return;
+  squared_distances dist{sz};
+  distance_field_columns(coverage, sz, dist);
+  distance_field_rows(dist, sz, spread, dest);
+}
+
+} // namespace img
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+#include <libs/geom/geom.hpp>
+
+namespace img {
+
+/// Converts grayscale coverage bitmap into a signed distance field. Signed
+/// distances are mapped into bytes so that the outline is at 128 and values
+/// saturate `spread` pixels away from it.
+void distance_field(
+    std::span<const std::byte> coverage, ::size sz, int32_t spread, std::span<std::byte> dest
+);
+
+} // namespace img
@@ -0,0 +1,85 @@
+#include "sdf.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+
+constexpr size sz{.width = 32, .height = 24};
+
+// Square with corners at (8, 6) and (23, 17) inclusive
+std::vector<std::byte> make_square() {
+  std::vector<std::byte> res(sz.width * sz.height);
+  for (int y = 6; y < 18; ++y) {
+    for (int x = 8; x < 24; ++x)
+      res[y * sz.width + x] = std::byte{0xff};
+  }
+  return res;
+}
+
+uint8_t at(const std::vector<std::byte>& field, int x, int y) {
+  return std::to_integer<uint8_t>(field[y * sz.width + x]);
+}
+
+} // namespace
+
+SCENARIO("Signed distance field generation") {
+  GIVEN("bitmap with a filled square") {
+    const auto coverage = make_square();
+
+    WHEN("distance field is computed") {
+      constexpr int32_t spread = 4;
+      std::vector<std::byte> field(coverage.size());
+      img::distance_field(coverage, sz, spread, field);
+
+      THEN("pixels inside of the shape are above the middle value") {
+        CHECK(at(field, 8, 6) > 128);
+        CHECK(at(field, 15, 11) > 128);
+      }
+
+      THEN("pixels outside of the shape are below the middle value") {
+        CHECK(at(field, 7, 11) < 128);
+        CHECK(at(field, 15, 18) < 128);
+      }
+
+      THEN("values grow towards the shape center") {
+        for (int x = 1; x < 12; ++x) {
+          INFO("x: " << x);
+          CHECK(at(field, x, 11) >= at(field, x - 1, 11));
+        }
+        CHECK(at(field, 11, 11) > at(field, 9, 11));
+      }
+
+      THEN("values saturate further than spread from the outline") {
+        CHECK(at(field, 0, 0) == 0);
+        CHECK(at(field, 2, 11) == 0);
+      }
+
+      THEN("distances are euclidean") {
+        // Both pixels are 3 pixels away from the square edge
+        CHECK(at(field, 5, 11) == at(field, 15, 3));
+        CHECK(at(field, 5, 3) < at(field, 5, 11));
+      }
+    }
+  }
+
+  GIVEN("empty bitmap") {
+    const std::vector<std::byte> coverage(sz.width * sz.height);
+
+    THEN("distance field is empty as well") {
+      std::vector<std::byte> field(coverage.size(), std::byte{42});
+      img::distance_field(coverage, sz, 4, field);
+      CHECK(std::ranges::all_of(field, [](std::byte b) { return b == std::byte{0}; }));
+    }
+  }
+
+  GIVEN("bitmap of zero size") {
+    THEN("nothing is written into the distance field") {
+      std::vector<std::byte> field;
+      img::distance_field({}, ::size{.width = 0, .height = 0}, 4, field);
+      CHECK(field.empty());
+    }
+  }
+}
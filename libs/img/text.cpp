@@ -1,41 +1,19 @@
 #include "text.hpp"
 
+#include <mutex>
+#include <stdexcept>
 #include <system_error>
+#include <unordered_map>
 
 #include <freetype/freetype.h>
 #include <freetype/fterrors.h>
 #include <freetype/ftglyph.h>
-
-#include <iconv.h>
+#include <freetype/ftsizes.h>
 
 #include <fmt/format.h>
 
-namespace {
-
-static_assert(std::is_pointer_v<iconv_t>);
-struct iconv_deleter {
-  void operator()(iconv_t ptr) const noexcept { iconv_close(ptr); }
-};
-using iconv_ptr = std::unique_ptr<std::remove_pointer_t<iconv_t>, iconv_deleter>;
-
-std::u32string utf8_to_utf32(std::string_view text) {
-  iconv_ptr conv{iconv_open("UTF32LE", "UTF8")};
-  if (conv.get() == (iconv_t)-1) {
-    conv.release();
-    throw std::system_error{errno, std::system_category(), "iconv_open"};
-  }
-  std::u32string chars{};
-  chars.resize(text.size());
-  size_t insz = text.size(), outsz = std::as_writable_bytes(std::span{chars}).size();
-  char* inbuf = const_cast<char*>(text.data());
-  char* outbuf = reinterpret_cast<char*>(chars.data());
-  if (iconv(conv.get(), &inbuf, &insz, &outbuf, &outsz) == static_cast<size_t>(-1))
-    throw std::system_error{errno, std::system_category(), "iconv"};
-  chars.resize(chars.size() - (outsz) / sizeof(char32_t));
-  return chars;
-}
-
-} // namespace
+#include <libs/img/sdf.hpp>
+#include <libs/img/utf8.hpp>
 
 namespace img::ft {
 namespace {
@@ -43,10 +21,12 @@ namespace {
 struct deleter {
   void operator()(FT_Library ptr) const noexcept { FT_Done_FreeType(ptr); }
   void operator()(FT_Face ptr) const noexcept { FT_Done_Face(ptr); }
+  void operator()(FT_Size ptr) const noexcept { FT_Done_Size(ptr); }
 };
 
 using library = std::unique_ptr<FT_LibraryRec_, deleter>;
 using face = std::unique_ptr<FT_FaceRec_, deleter>;
+using face_size = std::unique_ptr<FT_SizeRec_, deleter>;
 
 struct : std::error_category {
   const char* name() const noexcept override { return "freetype error"; }
@@ -123,6 +103,60 @@ private:
   FT_StreamRec_ stream_;
 };
 
+} // namespace
+
+// FreeType objects are not thread safe. Each face gets its own library and
+// all accesses to the face and its sizes are done under the mutex.
+struct loaded_face {
+  std::mutex mutex;
+  library lib;
+  std::unique_ptr<fd_stream> stream;
+  face handle;
+};
+
+namespace {
+
+void select_unicode(FT_Face face) {
+  if (FT_Error ec = FT_Select_Charmap(face, ft_encoding_unicode); ec != 0)
+    throw std::system_error{ec, ft::category, "FT_Select_Charmap"};
+}
+
+std::shared_ptr<loaded_face> open_stream_face(thinsys::io::file_descriptor& fd) {
+  auto res = std::make_shared<loaded_face>();
+  res->lib = init();
+  res->stream = std::make_unique<fd_stream>(fd);
+  res->handle = res->stream->open_face(*res->lib);
+  select_unicode(res->handle.get());
+  return res;
+}
+
+// Faces are shared between all fonts loaded from the same memory so that the
+// font file is parsed once.
+std::shared_ptr<loaded_face> open_memory_face(std::span<const std::byte> data) {
+  static std::mutex mutex;
+  static std::unordered_map<const std::byte*, std::weak_ptr<loaded_face>> faces;
+
+  std::lock_guard lock{mutex};
+  if (auto res = faces[data.data()].lock())
+    return res;
+
+  auto res = std::make_shared<loaded_face>();
+  res->lib = init();
+  FT_Face face_ptr;
+  if (const FT_Error ec = FT_New_Memory_Face(
+          res->lib.get(), reinterpret_cast<const FT_Byte*>(data.data()), static_cast<FT_Long>(data.size()), 0,
+          &face_ptr
+      );
+      ec != 0)
+    throw std::system_error{ec, ft::category, "FT_New_Memory_Face"};
+  res->handle.reset(face_ptr);
+  select_unicode(face_ptr);
+
+  std::erase_if(faces, [](const auto& item) { return item.second.expired(); });
+  faces[data.data()] = res;
+  return res;
+}
+
 } // namespace
 } // namespace img::ft
 
@@ -130,80 +164,242 @@ namespace img {
 
 class font::impl {
 public:
-  impl(thinsys::io::file_descriptor& fd) : lib{ft::init()}, stream{fd}, font{stream.open_face(*lib)} {
-    if (FT_Error ec = FT_Select_Charmap(font.get(), ft_encoding_unicode); ec != 0)
-      throw std::system_error{ec, ft::category, "FT_Select_Charmap"};
+  impl(std::shared_ptr<ft::loaded_face> face, glyph_rendering rendering)
+      : face{std::move(face)}, font{this->face->handle.get()}, rendering{rendering} {
+    std::lock_guard lock{this->face->mutex};
+    FT_Size ptr;
+    if (FT_Error ec = FT_New_Size(font, &ptr); ec != 0)
+      throw std::system_error{ec, ft::category, "FT_New_Size"};
+    size.reset(ptr);
+  }
+
+  impl(const impl&) = delete;
+  impl& operator=(const impl&) = delete;
+
+  // Sizes are owned by the face shared with other fonts
+  ~impl() noexcept {
+    std::lock_guard lock{face->mutex};
+    size.reset();
+  }
+
+  // Each font has its own size object so it has to be activated before any
+  // face access.
+  std::unique_lock<std::mutex> activate() {
+    std::unique_lock lock{face->mutex};
+    if (FT_Error ec = FT_Activate_Size(size.get()); ec != 0)
+      throw std::system_error{ec, ft::category, "FT_Activate_Size"};
+    return lock;
   }
 
   void set_pixel_size(FT_UInt width, FT_UInt height) {
-    if (FT_Error ec = FT_Set_Pixel_Sizes(font.get(), width, height); ec != 0)
+    const auto lock = activate();
+    if (FT_Error ec = FT_Set_Pixel_Sizes(font, width, height); ec != 0)
       throw std::system_error{ec, ft::category, "FT_Set_Pixel_Sizes"};
+    cache = glyph_cache{max_glyph_size(), cache_grid};
+  }
+
+  // Bounding box of all glyphs of the face scaled to the current size
+  ::size max_glyph_size() const noexcept {
+    const auto& metrics = size->metrics;
+    const auto scaled = [this](FT_Pos val, FT_Fixed scale) {
+      return static_cast<int32_t>((FT_MulFix(val, scale) + 63) >> 6) + 1 + 2 * padding();
+    };
+    return {
+        .width = scaled(font->bbox.xMax - font->bbox.xMin, metrics.x_scale),
+        .height = scaled(font->bbox.yMax - font->bbox.yMin, metrics.y_scale)
+    };
   }
 
-  ft::library lib;
-  ft::fd_stream stream;
-  ft::face font;
+  std::pair<const glyph_key, const cached_glyph&> glyph(glyph_cache& cache, char32_t ch) {
+    const auto idx = FT_Get_Char_Index(font, ch);
+    const glyph_key key{
+        .face = font, .pixel_size = size->metrics.y_ppem, .index = idx, .rendering = rendering
+    };
+    if (const auto* cached = cache.find(key))
+      return {key, *cached};
+
+    const auto lock = activate();
+    if (FT_Error ec = FT_Load_Glyph(font, idx, FT_LOAD_RENDER); ec != 0)
+      throw std::system_error{ec, ft::category, "FT_Load_Glyph"};
+    const auto& slot = *font->glyph;
+    const glyph_metrics metrics{
+        .left = slot.bitmap_left,
+        .top = slot.bitmap_top,
+        .advance = static_cast<int32_t>(slot.advance.x >> 6),
+        .bitmap = {
+            .width = static_cast<int32_t>(slot.bitmap.width),
+            .height = static_cast<int32_t>(slot.bitmap.rows)
+        }
+    };
+    const size_t pitch = static_cast<size_t>(std::abs(slot.bitmap.pitch));
+    const std::span<const std::byte> bitmap{
+        reinterpret_cast<const std::byte*>(slot.bitmap.buffer), pitch * slot.bitmap.rows
+    };
+    if (rendering == glyph_rendering::distance_field && metrics.bitmap.width > 0 && metrics.bitmap.height > 0)
+      return {key, insert_distance_field(cache, key, metrics, bitmap, pitch)};
+    return {key, cache.insert(key, metrics, bitmap, pitch)};
+  }
+
+  // Distance field spreads outside of the glyph bitmap so it is padded on
+  // each side.
+  const cached_glyph& insert_distance_field(
+      glyph_cache& cache, const glyph_key& key, glyph_metrics metrics, std::span<const std::byte> bitmap,
+      size_t pitch
+  ) {
+    const int32_t pad = padding();
+    const ::size sz{.width = metrics.bitmap.width + 2 * pad, .height = metrics.bitmap.height + 2 * pad};
+    std::vector<std::byte> coverage(bytes_size(sz, pixel_fmt::grayscale));
+    for (int32_t row = 0; row < metrics.bitmap.height; ++row) {
+      std::ranges::copy(
+          bitmap.subspan(row * pitch, metrics.bitmap.width), coverage.begin() + (row + pad) * sz.width + pad
+      );
+    }
+    std::vector<std::byte> field(coverage.size());
+    distance_field(coverage, sz, distance_field_spread, field);
+
+    metrics.left -= pad;
+    metrics.top += pad;
+    metrics.bitmap = sz;
+    return cache.insert(key, metrics, field, sz.width);
+  }
+
+  int32_t padding() const noexcept {
+    return rendering == glyph_rendering::distance_field ? distance_field_spread : 0;
+  }
+
+  static constexpr ::size cache_grid{.width = 16, .height = 8};
+  static constexpr FT_UInt coverage_pixel_size = 128;
+  static constexpr FT_UInt distance_field_pixel_size = 64;
+  static constexpr int32_t distance_field_spread = 8;
+
+  std::shared_ptr<ft::loaded_face> face;
+  FT_Face font;
+  ft::face_size size;
+  glyph_rendering rendering;
+  glyph_cache cache;
 };
 
 font::~font() noexcept = default;
 
-font font::load(thinsys::io::file_descriptor& fd) {
+font font::load(thinsys::io::file_descriptor& fd, glyph_rendering rendering) {
+  return load(ft::open_stream_face(fd), rendering);
+}
+
+font font::load(std::span<const std::byte> data, glyph_rendering rendering) {
+  return load(ft::open_memory_face(data), rendering);
+}
+
+font font::load(std::shared_ptr<ft::loaded_face> face, glyph_rendering rendering) {
   font res;
-  res.stm_ = std::make_unique<impl>(fd);
-  res.stm_->set_pixel_size(128, 128);
+  res.stm_ = std::make_unique<impl>(std::move(face), rendering);
+  const FT_UInt pixel_size = rendering == glyph_rendering::distance_field ? impl::distance_field_pixel_size
+                                                                          : impl::coverage_pixel_size;
+  res.stm_->set_pixel_size(pixel_size, pixel_size);
 
   return res;
 }
 
-reader font::text_image_reader(std::string_view text) {
-  auto chars = utf8_to_utf32(text);
+text_layout font::layout(std::string_view text, glyph_cache& cache) {
+  cache.next_epoch();
+
+  text_layout res;
+  int32_t top = 0;
+  int32_t bottom = 0;
+  int32_t left = 0;
+  int32_t right = 0;
+  int32_t pen = 0;
+  for (std::string_view rest = text; !rest.empty();) {
+    const auto [key, glyph] = stm_->glyph(cache, utf8::decode(rest));
+    top = std::max(top, glyph.metrics.top);
+    bottom = std::min(bottom, glyph.metrics.top - glyph.metrics.bitmap.height);
+    if (glyph.area.width > 0 && glyph.area.height > 0) {
+      res.quads.push_back({
+          .glyph = key,
+          .dest = {
+              .x = pen + glyph.metrics.left,
+              .y = -glyph.metrics.top,
+              .width = glyph.area.width,
+              .height = glyph.area.height
+          },
+          .src = glyph.area
+      });
+      left = std::min(left, res.quads.back().dest.x);
+      right = std::max(right, res.quads.back().dest.x + res.quads.back().dest.width);
+    }
+    pen += glyph.metrics.advance;
+  }
+  right = std::max(right, pen);
 
-  int top = 0;
-  int bottom = 0;
-  FT_Pos width = 0;
-  for (char32_t ch : chars) {
-    const auto idx = FT_Get_Char_Index(stm_->font.get(), ch);
-    if (FT_Error ec = FT_Load_Glyph(stm_->font.get(), idx, FT_LOAD_BITMAP_METRICS_ONLY); ec != 0)
-      throw std::system_error{ec, ft::category, "FT_Load_Glyph"};
-    top = std::max(top, stm_->font->glyph->bitmap_top);
-    bottom =
-        std::min(bottom, stm_->font->glyph->bitmap_top - static_cast<int>(stm_->font->glyph->bitmap.rows));
-    width += stm_->font->glyph->advance.x >> 6;
+  // Glyphs are placed relative to the pen origin until the text bounds are
+  // known. One pixel margin is kept around the text.
+  for (auto& quad : res.quads) {
+    quad.dest.x += 1 - left;
+    quad.dest.y += top + 1;
   }
-  width += 2;
-  return {
-      size{static_cast<int32_t>(width), static_cast<int32_t>(top - bottom + 2)}, pixel_fmt::rgba,
-      [chars = std::move(chars), font = stm_->font.get(), top, width](std::span<std::byte> dest) -> size_t {
-        std::ranges::fill(dest, std::byte{0});
-
-        FT_Pos left = 1;
-        for (char32_t ch : chars) {
-          const auto idx = FT_Get_Char_Index(font, ch);
-          if (FT_Error ec = FT_Load_Glyph(font, idx, FT_LOAD_DEFAULT); ec != 0)
-            throw std::system_error{ec, ft::category, "FT_Load_Glyph"};
-          if (FT_Error ec = FT_Render_Glyph(font->glyph, FT_RENDER_MODE_NORMAL); ec != 0)
-            throw std::system_error{ec, ft::category, "FT_Render_Glyph"};
-
-          const std::byte* bitmap_pos = reinterpret_cast<const std::byte*>(font->glyph->bitmap.buffer);
-          for (unsigned row = 0; row < font->glyph->bitmap.rows; ++row) {
-            const auto y = top - font->glyph->bitmap_top + row + 1;
-            const auto x = left + font->glyph->bitmap_left;
-            auto* dest_pos = dest.data() + (y * width + x) * pixel_byte_size(pixel_fmt::rgba);
-
-            for (std::byte val : std::span{bitmap_pos, static_cast<size_t>(font->glyph->bitmap.width)}) {
-              *(dest_pos++) = std::byte{0x7a};
-              *(dest_pos++) = std::byte{0x7a};
-              *(dest_pos++) = std::byte{0x7a};
-              *(dest_pos++) = val;
-            }
-
-            bitmap_pos += font->glyph->bitmap.pitch;
-          }
-
-          left += font->glyph->advance.x >> 6;
-        }
+  res.size = {.width = right - left + 2, .height = top - bottom + 2};
+  res.origin_x = 1 - left;
+  res.baseline = top + 1;
+  return res;
+}
+
+text_layout font::layout(std::string_view text) { return layout(text, stm_->cache); }
+
+const glyph_cache& font::glyphs() const noexcept { return stm_->cache; }
+
+int32_t font::ascender() const noexcept {
+  return static_cast<int32_t>((FT_MulFix(stm_->font->bbox.yMax, stm_->size->metrics.y_scale) + 63) >> 6) +
+         stm_->padding();
+}
+
+int32_t font::descender() const noexcept {
+  return static_cast<int32_t>((-FT_MulFix(stm_->font->bbox.yMin, stm_->size->metrics.y_scale) + 63) >> 6) +
+         stm_->padding();
+}
+
+namespace {
 
-        return 0;
+void render_quads(
+    const text_layout& layout, const glyph_cache& cache, pixel_fmt fmt, std::span<std::byte> dest
+) {
+  std::ranges::fill(dest, std::byte{0});
+
+  const auto atlas = cache.pixels();
+  const size_t atlas_stride = cache.size().width;
+  const size_t px_size = pixel_byte_size(fmt);
+  for (const auto& quad : layout.quads) {
+    for (int32_t row = 0; row < quad.dest.height; ++row) {
+      const auto* src = atlas.data() + (quad.src.y + row) * atlas_stride + quad.src.x;
+      const size_t dest_offset = (quad.dest.y + row) * layout.size.width + quad.dest.x;
+      auto* dest_pos = dest.data() + dest_offset * px_size;
+      for (std::byte val : std::span{src, static_cast<size_t>(quad.dest.width)}) {
+        // Coverage goes to the last channel while the color ones are gray
+        std::fill_n(dest_pos, px_size - 1, std::byte{0x7a});
+        dest_pos += px_size - 1;
+        // Neighbour glyphs may overlap a bit
+        *dest_pos = std::max(*dest_pos, val);
+        ++dest_pos;
+      }
+    }
+  }
+}
+
+} // namespace
+
+reader font::text_image_reader(std::string_view text, pixel_fmt fmt) {
+  if (fmt != pixel_fmt::grayscale && fmt != pixel_fmt::rgba)
+    throw std::runtime_error{"Text can only be rendered to grayscale or RGBA image"};
+
+  // Glyphs are copied out right away since the cache may change before the
+  // image is read.
+  const auto layout = this->layout(text);
+  const size_t total = bytes_size(layout.size, fmt);
+  std::unique_ptr<std::byte[]> rendered{new std::byte[total]};
+  render_quads(layout, stm_->cache, fmt, {rendered.get(), total});
+  return {
+      layout.size, fmt,
+      [rendered = std::move(rendered), offset = size_t{0}](std::span<std::byte> dest) mutable {
+        std::ranges::copy(std::span{rendered.get() + offset, dest.size()}, dest.data());
+        offset += dest.size();
       }
   };
 }
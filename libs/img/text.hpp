@@ -1,13 +1,41 @@
 #pragma once
 
 #include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
 
 #include <thinsys/io/io.hpp>
 
+#include <libs/geom/geom.hpp>
+#include <libs/img/glyph_cache.hpp>
+#include <libs/img/pixel_fmt.hpp>
 #include <libs/img/reader.hpp>
 
 namespace img {
 
+namespace ft {
+struct loaded_face;
+} // namespace ft
+
+struct glyph_quad {
+  glyph_key glyph;
+  /// Glyph area in the text image.
+  rect dest;
+  /// Glyph bitmap area in the glyph cache atlas.
+  rect src;
+
+  constexpr bool operator==(const glyph_quad&) const noexcept = default;
+};
+
+struct text_layout {
+  ::size size;
+  /// Pen start position on the baseline in the text image.
+  int32_t origin_x = 0;
+  int32_t baseline = 0;
+  std::vector<glyph_quad> quads;
+};
+
 class font {
 public:
   font() noexcept = default;
@@ -20,9 +48,32 @@ public:
 
   ~font() noexcept;
 
-  static font load(thinsys::io::file_descriptor& fd);
+  /// Distance field glyphs are rasterized at a smaller size since they scale
+  /// up without blurring.
+  static font load(thinsys::io::file_descriptor& fd, glyph_rendering rendering = glyph_rendering::coverage);
+  /// Loads font file placed in memory which must outlive all fonts loaded
+  /// from it. Fonts loaded from the same memory share the parsed face.
+  static font load(std::span<const std::byte> data, glyph_rendering rendering = glyph_rendering::coverage);
+
+  /// Renders the text into the image with glyph coverage (or distance field)
+  /// in the last channel. Grayscale images store nothing else making them
+  /// four times smaller than RGBA ones with constant gray color.
+  reader text_image_reader(std::string_view text, pixel_fmt fmt = pixel_fmt::rgba);
+
+  /// Places glyphs of the text rasterizing those missing in the `cache`.
+  /// Quads stay valid until the next layout with the same cache.
+  text_layout layout(std::string_view text, glyph_cache& cache);
+  /// Same as above with the cache owned by the font.
+  text_layout layout(std::string_view text);
+  const glyph_cache& glyphs() const noexcept;
 
-  reader text_image_reader(std::string_view text);
+  /// Distance from the baseline to the top of the highest glyph.
+  int32_t ascender() const noexcept;
+  /// Distance from the baseline to the bottom of the lowest glyph.
+  int32_t descender() const noexcept;
+
+private:
+  static font load(std::shared_ptr<ft::loaded_face> face, glyph_rendering rendering);
 
 private:
   class impl;
@@ -0,0 +1,45 @@
+#include "text.hpp"
+
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+
+std::vector<std::byte> read_font() {
+  std::ifstream in{TEST_FONT_PATH, std::ios::binary};
+  std::vector<char> data{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+  REQUIRE(!data.empty());
+  const auto bytes = std::as_bytes(std::span{data});
+  return {bytes.begin(), bytes.end()};
+}
+
+const void* face_of(img::font& font) {
+  const auto layout = font.layout("A");
+  REQUIRE(!layout.quads.empty());
+  return layout.quads.front().glyph.face;
+}
+
+} // namespace
+
+SCENARIO("Fonts loaded from memory") {
+  GIVEN("font file placed in memory") {
+    const auto data = read_font();
+    auto first = img::font::load(data);
+
+    WHEN("it is loaded again while the first font is alive") {
+      auto second = img::font::load(data, img::glyph_rendering::distance_field);
+
+      THEN("the parsed face is reused") { CHECK(face_of(second) == face_of(first)); }
+    }
+
+    WHEN("a copy of the file placed elsewhere is loaded") {
+      const auto copy = data;
+      auto other = img::font::load(copy);
+
+      THEN("it gets a face of its own") { CHECK(face_of(other) != face_of(first)); }
+    }
+  }
+}
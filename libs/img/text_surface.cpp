@@ -0,0 +1,109 @@
+#include <algorithm>
+
+#include <libs/img/text_surface.hpp>
+
+namespace img {
+
+namespace {
+
+// Replaces overlapping or touching rects with their bounding boxes until no
+// such pairs are left.
+void merge(std::vector<rect>& rects) {
+  const auto adjacent = [](rect lhs, rect rhs) {
+    return lhs.x <= rhs.x + rhs.width && rhs.x <= lhs.x + lhs.width && lhs.y <= rhs.y + rhs.height &&
+           rhs.y <= lhs.y + lhs.height;
+  };
+  for (bool merged = true; merged;) {
+    merged = false;
+    for (size_t i = 0; i < rects.size(); ++i) {
+      for (size_t j = i + 1; j < rects.size();) {
+        if (adjacent(rects[i], rects[j])) {
+          rects[i] = bounding_box(rects[i], rects[j]);
+          rects.erase(rects.begin() + j);
+          merged = true;
+        } else
+          ++j;
+      }
+    }
+  }
+}
+
+::size grid(const glyph_cache& cache) noexcept {
+  return {
+      .width = cache.size().width / cache.cell_size().width,
+      .height = cache.size().height / cache.cell_size().height
+  };
+}
+
+} // namespace
+
+text_surface::text_surface(font& fnt, int32_t width)
+    : font_{&fnt}, cache_{fnt.glyphs().cell_size(), grid(fnt.glyphs())},
+      sz_{.width = width, .height = fnt.ascender() + fnt.descender() + 2},
+      baseline_{fnt.ascender() + 1},
+      pixels_{new std::byte[bytes_size(sz_, pixel_fmt::grayscale)]{}},
+      dirty_{{.x = 0, .y = 0, .width = sz_.width, .height = sz_.height}} {}
+
+std::span<const std::byte> text_surface::pixels() const noexcept {
+  return {pixels_.get(), bytes_size(sz_, pixel_fmt::grayscale)};
+}
+
+void text_surface::update(std::string_view text) {
+  auto layout = font_->layout(text, cache_);
+  for (auto& quad : layout.quads) {
+    quad.dest.x += 1 - layout.origin_x;
+    quad.dest.y += baseline_ - layout.baseline;
+  }
+
+  std::vector<rect> changed;
+  for (size_t i = 0; i < std::max(quads_.size(), layout.quads.size()); ++i) {
+    // Glyph moved to another cache cell looks the same
+    if (i < quads_.size() && i < layout.quads.size() && quads_[i].glyph == layout.quads[i].glyph &&
+        quads_[i].dest == layout.quads[i].dest)
+      continue;
+    if (i < quads_.size())
+      changed.push_back(quads_[i].dest);
+    if (i < layout.quads.size())
+      changed.push_back(layout.quads[i].dest);
+  }
+  quads_ = std::move(layout.quads);
+
+  const rect bounds{.x = 0, .y = 0, .width = sz_.width, .height = sz_.height};
+  for (auto& area : changed)
+    area = intersection(area, bounds);
+  std::erase_if(changed, [](const rect& r) { return empty(r); });
+  merge(changed);
+  for (rect area : changed)
+    redraw(area);
+
+  dirty_.insert(dirty_.end(), changed.begin(), changed.end());
+  merge(dirty_);
+}
+
+// Neighbour glyphs may overlap so all of them touching the area are redrawn
+// and combined with max. Unchanged glyphs are read from the atlas too, which
+// is safe since all quads come from the last layout whose epoch pins their
+// cells until the next update.
+void text_surface::redraw(rect area) noexcept {
+  const size_t stride = sz_.width;
+  for (int32_t y = area.y; y < area.y + area.height; ++y)
+    std::fill_n(pixels_.get() + y * stride + area.x, area.width, std::byte{0});
+
+  const auto atlas = cache_.pixels();
+  const size_t atlas_stride = cache_.size().width;
+  for (const auto& quad : quads_) {
+    const rect common = intersection(quad.dest, area);
+    if (empty(common))
+      continue;
+    const int32_t src_x = quad.src.x + common.x - quad.dest.x;
+    const int32_t src_y = quad.src.y + common.y - quad.dest.y;
+    for (int32_t row = 0; row < common.height; ++row) {
+      const auto* src = atlas.data() + (src_y + row) * atlas_stride + src_x;
+      auto* dest = pixels_.get() + (common.y + row) * stride + common.x;
+      for (int32_t col = 0; col < common.width; ++col)
+        dest[col] = std::max(dest[col], src[col]);
+    }
+  }
+}
+
+} // namespace img
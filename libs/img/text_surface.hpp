@@ -0,0 +1,49 @@
+#pragma once
+
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include <libs/geom/geom.hpp>
+#include <libs/img/text.hpp>
+
+namespace img {
+
+/// Grayscale image of a single text line which changes often, like frame
+/// time or score counters. Glyphs which stay in place after the text update
+/// are not redrawn and areas changed are reported for partial GPU upload.
+///
+/// Glyphs are placed on the fixed baseline so that changing glyphs never
+/// shift the rest of the line. Text which doesn't fit into the surface is
+/// clipped. Glyphs are kept in the surface own cache so that other texts
+/// laid out with the same font never evict them.
+class text_surface {
+public:
+  /// Font must outlive the surface. Surface height is enough for any glyph
+  /// of the font.
+  text_surface(font& fnt, int32_t width);
+
+  void update(std::string_view text);
+
+  ::size size() const noexcept { return sz_; }
+  std::span<const std::byte> pixels() const noexcept;
+
+  /// Non overlapping areas changed since the previous call. The whole surface
+  /// is reported after construction.
+  std::vector<rect> take_dirty() noexcept { return std::exchange(dirty_, {}); }
+
+private:
+  void redraw(rect area) noexcept;
+
+private:
+  font* font_;
+  glyph_cache cache_;
+  ::size sz_;
+  int32_t baseline_;
+  std::unique_ptr<std::byte[]> pixels_;
+  std::vector<glyph_quad> quads_;
+  std::vector<rect> dirty_;
+};
+
+} // namespace img
@@ -0,0 +1,119 @@
+#include "text_surface.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <string_view>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+
+std::vector<std::byte> read_font() {
+  std::ifstream in{TEST_FONT_PATH, std::ios::binary};
+  std::vector<char> data{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+  REQUIRE(!data.empty());
+  const auto bytes = std::as_bytes(std::span{data});
+  return {bytes.begin(), bytes.end()};
+}
+
+std::vector<std::byte> snapshot(const img::text_surface& surf) {
+  return {surf.pixels().begin(), surf.pixels().end()};
+}
+
+bool inside(std::span<const rect> rects, int32_t x, int32_t y) {
+  return std::ranges::any_of(rects, [x, y](const rect& r) {
+    return x >= r.x && x < r.x + r.width && y >= r.y && y < r.y + r.height;
+  });
+}
+
+// Pixels outside of the `dirty` rects are the same in both images
+bool same_outside(
+    size sz, std::span<const rect> dirty, std::span<const std::byte> lhs, std::span<const std::byte> rhs
+) {
+  for (int32_t y = 0; y < sz.height; ++y) {
+    for (int32_t x = 0; x < sz.width; ++x) {
+      const size_t pos = y * sz.width + x;
+      if (!inside(dirty, x, y) && lhs[pos] != rhs[pos])
+        return false;
+    }
+  }
+  return true;
+}
+
+int64_t area(std::span<const rect> rects) {
+  int64_t res = 0;
+  for (const rect& r : rects)
+    res += int64_t{r.width} * r.height;
+  return res;
+}
+
+// Pixels of the text drawn on a fresh surface
+std::vector<std::byte> render(img::font& font, int32_t width, std::string_view text) {
+  img::text_surface surf{font, width};
+  surf.update(text);
+  return snapshot(surf);
+}
+
+} // namespace
+
+SCENARIO("Text surface reports changed areas") {
+  GIVEN("text surface with some text drawn") {
+    constexpr int32_t width = 1024;
+    const auto data = read_font();
+    auto font = img::font::load(data);
+    img::text_surface surf{font, width};
+    const rect whole{.x = 0, .y = 0, .width = width, .height = surf.size().height};
+
+    REQUIRE(surf.take_dirty() == std::vector{whole});
+    surf.update("1234");
+    const auto dirty = surf.take_dirty();
+    REQUIRE(!dirty.empty());
+    CHECK(std::ranges::all_of(dirty, [&](const rect& r) { return intersection(r, whole) == r; }));
+    const auto before = snapshot(surf);
+
+    WHEN("the same text is drawn again") {
+      surf.update("1234");
+
+      THEN("nothing is reported") {
+        CHECK(surf.take_dirty().empty());
+        CHECK(snapshot(surf) == before);
+      }
+    }
+
+    WHEN("the last glyph is changed") {
+      surf.update("1235");
+      const auto changed = surf.take_dirty();
+
+      THEN("only the area around it is reported") {
+        REQUIRE(!changed.empty());
+        CHECK(area(changed) < area(dirty));
+        CHECK(same_outside(surf.size(), changed, before, snapshot(surf)));
+        CHECK(snapshot(surf) == render(font, width, "1235"));
+      }
+    }
+
+    WHEN("shorter text is drawn") {
+      surf.update("12");
+      const auto changed = surf.take_dirty();
+
+      THEN("the area of removed glyphs is reported and cleared") {
+        REQUIRE(!changed.empty());
+        CHECK(area(changed) < area(dirty));
+        CHECK(same_outside(surf.size(), changed, before, snapshot(surf)));
+        CHECK(snapshot(surf) == render(font, width, "12"));
+      }
+    }
+
+    WHEN("other text is laid out with the same font in between") {
+      font.layout("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789");
+      surf.update("1235");
+
+      THEN("the surface glyphs are not affected") {
+        surf.take_dirty();
+        CHECK(snapshot(surf) == render(font, width, "1235"));
+      }
+    }
+  }
+}
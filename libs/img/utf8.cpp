@@ -0,0 +1,71 @@
+#include <cassert>
+
+#include <libs/img/utf8.hpp>
+
+namespace img::utf8 {
+
+namespace {
+
+constexpr bool is_continuation(unsigned char byte) noexcept { return (byte & 0xc0) == 0x80; }
+
+} // namespace
+
+char32_t decode(std::string_view& text) noexcept {
+  assert(!text.empty());
+  const auto lead = static_cast<unsigned char>(text.front());
+  if (lead < 0x80) {
+    text.remove_prefix(1);
+    return lead;
+  }
+
+  size_t len;
+  char32_t res;
+  char32_t min;
+  if ((lead & 0xe0) == 0xc0) {
+    len = 2;
+    res = lead & 0x1f;
+    min = 0x80;
+  } else if ((lead & 0xf0) == 0xe0) {
+    len = 3;
+    res = lead & 0x0f;
+    min = 0x800;
+  } else if ((lead & 0xf8) == 0xf0) {
+    len = 4;
+    res = lead & 0x07;
+    min = 0x10000;
+  } else {
+    text.remove_prefix(1);
+    return replacement_character;
+  }
+
+  if (text.size() < len) {
+    text.remove_prefix(1);
+    return replacement_character;
+  }
+  for (size_t i = 1; i < len; ++i) {
+    const auto byte = static_cast<unsigned char>(text[i]);
+    if (!is_continuation(byte)) {
+      text.remove_prefix(1);
+      return replacement_character;
+    }
+    res = (res << 6) | (byte & 0x3f);
+  }
+
+  // Overlong encodings, surrogates and values beyond Unicode range are invalid
+  if (res < min || (res >= 0xd800 && res <= 0xdfff) || res > 0x10ffff) {
+    text.remove_prefix(1);
+    return replacement_character;
+  }
+  text.remove_prefix(len);
+  return res;
+}
+
+std::u32string to_utf32(std::string_view text) {
+  std::u32string res;
+  res.reserve(text.size());
+  while (!text.empty())
+    res.push_back(decode(text));
+  return res;
+}
+
+} // namespace img::utf8
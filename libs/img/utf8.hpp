@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace img::utf8 {
+
+constexpr char32_t replacement_character = 0xfffd;
+
+/// Decodes the code point at the beginning of `text` and removes its bytes
+/// from it. Malformed sequences are decoded as U+FFFD one byte at a time.
+/// `text` must not be empty.
+char32_t decode(std::string_view& text) noexcept;
+
+std::u32string to_utf32(std::string_view text);
+
+} // namespace img::utf8
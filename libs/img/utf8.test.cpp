@@ -0,0 +1,31 @@
+#include "utf8.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+SCENARIO("UTF-8 decoding") {
+  GIVEN("ASCII text") {
+    THEN("it is decoded byte by byte") { CHECK(img::utf8::to_utf32("abc 123") == U"abc 123"); }
+  }
+
+  GIVEN("text with multibyte sequences of all lengths") {
+    THEN("it is decoded into code points") {
+      CHECK(img::utf8::to_utf32("привет") == U"привет");
+      CHECK(img::utf8::to_utf32("aé€\U0001f600z") == U"aé€\U0001f600z");
+    }
+  }
+
+  GIVEN("malformed sequences") {
+    THEN("truncated sequence is replaced") { CHECK(img::utf8::to_utf32("a\xd0") == U"a�"); }
+    THEN("stray continuation byte is replaced") { CHECK(img::utf8::to_utf32("\x80z") == U"�z"); }
+    THEN("overlong encoding is replaced byte by byte") {
+      CHECK(img::utf8::to_utf32("\xc0\xaf") == U"��");
+    }
+    THEN("encoded surrogate is rejected") { CHECK(img::utf8::to_utf32("\xed\xa0\x80").front() == U'�'); }
+    THEN("code points beyond Unicode range are rejected") {
+      CHECK(img::utf8::to_utf32("\xf4\x90\x80\x80").front() == U'�');
+    }
+    THEN("interrupted sequence keeps the following character") {
+      CHECK(img::utf8::to_utf32("\xe2\x82z") == U"��z");
+    }
+  }
+}
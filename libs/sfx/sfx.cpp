@@ -4,6 +4,9 @@
 #include "sfx.hpp"
 #include "zip.hpp"
 
+#include <sys/mman.h>
+#include <sys/stat.h>
+
 #include <thinsys/io/input.hpp>
 #include <thinsys/io/io.hpp>
 #include <thinsys/io/span_io.hpp>
@@ -226,6 +229,44 @@ thinsys::io::file_descriptor& archive::open(const fs::path& path) {
   return open(it->second);
 }
 
+thinsys::io::file_descriptor archive::open_detached(const fs::path& path) {
+  const auto it = entries_.find(path);
+  if (it == entries_.end())
+    throw std::system_error{std::make_error_code(std::errc::no_such_file_or_directory), "sfx-archive open"};
+  open(it->second);
+
+  auto res = open_self_stream();
+  thinsys::io::seek(res, it->second.offset, thinsys::io::seek_whence::set);
+  return res;
+}
+
+std::span<const std::byte> archive::map(const fs::path& path) {
+  const auto it = entries_.find(path);
+  if (it == entries_.end())
+    throw std::system_error{std::make_error_code(std::errc::no_such_file_or_directory), "sfx-archive map"};
+  open(it->second);
+
+  if (!mapping_) {
+    struct stat st;
+    if (::fstat(fd_.native_handle(), &st) == -1)
+      throw std::system_error{errno, std::system_category(), "fstat"};
+    const size_t len = static_cast<size_t>(st.st_size);
+    void* addr = ::mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd_.native_handle(), 0);
+    if (addr == MAP_FAILED)
+      throw std::system_error{errno, std::system_category(), "mmap"};
+    mapping_ = std::unique_ptr<const std::byte[], unmapper>{static_cast<const std::byte*>(addr), {len}};
+  }
+
+  const auto& e = it->second;
+  if (e.offset + e.size > mapping_.get_deleter().size)
+    throw std::runtime_error{"sfx-archive entry is out of file bounds"};
+  return {mapping_.get() + e.offset, e.size};
+}
+
+void archive::unmapper::operator()(const std::byte* ptr) const noexcept {
+  ::munmap(const_cast<std::byte*>(ptr), size);
+}
+
 archive archive::open_self() {
   auto self = open_self_stream();
   const auto cd_end = end_of_cd_record::read(self);
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <filesystem>
+#include <memory>
+#include <span>
 #include <unordered_map>
 
 #include <thinsys/io/io.hpp>
@@ -20,15 +22,29 @@ public:
   thinsys::io::file_descriptor& open(entry& e);
   thinsys::io::file_descriptor& open(const fs::path& path);
 
+  thinsys::io::file_descriptor open_detached(const fs::path& path);
+
+  /// Gives direct access to the resource content without copying it. The
+  /// whole archive is mapped into memory on the first call and stays mapped
+  /// for the archive lifetime.
+  std::span<const std::byte> map(const fs::path& path);
+
   static archive open_self();
 
 private:
   archive(std::unordered_map<fs::path, entry> entries, thinsys::io::file_descriptor fd)
       : entries_{std::move(entries)}, fd_{std::move(fd)} {}
 
+private:
+  struct unmapper {
+    size_t size;
+    void operator()(const std::byte* ptr) const noexcept;
+  };
+
 private:
   std::unordered_map<fs::path, entry> entries_;
   thinsys::io::file_descriptor fd_;
+  std::unique_ptr<const std::byte[], unmapper> mapping_;
 };
 
 } // namespace sfx
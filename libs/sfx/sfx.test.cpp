@@ -41,5 +41,33 @@ SCENARIO("Open self executable as zip-archive") {
         CHECK(content == "Hello world\n");
       }
     }
+
+    WHEN("resource is mapped into memory") {
+      const auto content = archive.map("b.txt");
+
+      THEN("it's content is accessible directly") {
+        CHECK(std::string_view{reinterpret_cast<const char*>(content.data()), content.size()} ==
+              "Goodby and thanks for all the fish\n");
+      }
+    }
+
+    WHEN("two resources opened as detached streams") {
+      auto a_fd = archive.open_detached("a.txt");
+      auto b_fd = archive.open_detached("b.txt");
+
+      THEN("they can be read independently") {
+        std::string a_content;
+        a_content.resize(archive.entries().at("a.txt").size);
+        std::string b_content;
+        b_content.resize(archive.entries().at("b.txt").size);
+
+        thinsys::io::read(b_fd, std::as_writable_bytes(std::span{b_content}).first(8));
+        thinsys::io::read(a_fd, std::as_writable_bytes(std::span{a_content}));
+        thinsys::io::read(b_fd, std::as_writable_bytes(std::span{b_content}).subspan(8));
+
+        CHECK(a_content == "Hello world\n");
+        CHECK(b_content == "Goodby and thanks for all the fish\n");
+      }
+    }
   }
 }
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <concepts>
+#include <memory>
+
+#include <spdlog/spdlog.h>
+
+#include <libs/swrast/rasterizer.hpp>
+
+#include <libs/wlwnd/framebuf.hpp>
+#include <libs/wlwnd/renderer.hpp>
+
+/// Renders frames of a window on the CPU into shared memory buffers. Tiles of
+/// each frame are rasterized concurrently on the `exec`.
+template <renderer Renderer, typename Executor>
+class swrast_window_renderer final : public window_renderer {
+public:
+  template <typename... A>
+  swrast_window_renderer(wl_shm& shm, Executor exec, const render_target& target, A&&... a)
+      : surf_{target.surface}, exec_{exec}, fb_{shm, target.display, target.size},
+        rast_{make_rasterizer(fb_.size())}, render_{rast_, std::forward<A>(a)...} {
+    spdlog::debug("Software rasterizer uses {} kernels", swrast::rasterizer_isa());
+    render_.resize(fb_.size());
+  }
+
+  void resize(size sz) override {
+    fb_.resize(sz);
+    rast_.resize(sz);
+    render_.resize(sz);
+  }
+
+  bool draw(frames_clock::time_point frame_time) override {
+    render_.draw(frame_time);
+    swrast::rasterize(exec_, rast_, fb_.front());
+    fb_.swap(surf_);
+    return true;
+  }
+
+private:
+  static swrast::rasterizer make_rasterizer(size sz) {
+    swrast::rasterizer rast;
+    rast.resize(sz);
+    return rast;
+  }
+
+private:
+  wl_surface& surf_;
+  Executor exec_;
+  wl::framebuf fb_;
+  swrast::rasterizer rast_;
+  Renderer render_;
+};
+
+/// Renders frames on the CPU into shared memory buffers. The renderer is
+/// constructed with the rasterizer to draw into followed by `a`. Tiles of
+/// each frame are rasterized concurrently on the `exec`.
+template <renderer Renderer, typename Executor, typename... A>
+  requires std::constructible_from<Renderer, swrast::rasterizer&, A...>
+animation_function make_swrast_animation_function(wl_shm& shm, Executor exec, A&&... a) {
+  using window_renderer_type = swrast_window_renderer<Renderer, Executor>;
+  return [&shm, exec, ... args = std::forward<A>(a)](const render_target& target) mutable {
+    return std::make_unique<window_renderer_type>(shm, exec, target, std::move(args)...);
+  };
+}
@@ -0,0 +1,348 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <optional>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include <libs/swrast/rasterizer.hpp>
+
+namespace swrast {
+
+namespace {
+
+// Vertices are snapped to 1/16 of a pixel like GPUs do
+constexpr float subpixels = 16.f;
+// Triangles reaching further away from the image are dropped to keep edge
+// functions precise enough
+constexpr float guard_band = 1 << 20;
+
+using kernels = detail::rasterizer_kernels;
+
+uint32_t pack_color(glm::vec4 color) noexcept {
+  const auto channel = [](float val) {
+    return static_cast<uint32_t>(std::clamp(val, 0.f, 1.f) * 255.f + .5f);
+  };
+  return channel(color.a) << 24 | channel(color.r * color.a) << 16 | channel(color.g * color.a) << 8 |
+         channel(color.b * color.a);
+}
+
+struct screen_vertex {
+  float x;
+  float y;
+  float z;
+  float inv_w;
+  glm::vec3 color;
+};
+
+screen_vertex to_screen(const vertex& v, ::size sz) noexcept {
+  const float inv_w = 1.f / v.position.w;
+  const auto snap = [](float val) { return std::round(val * subpixels) / subpixels; };
+  return {
+      .x = snap((v.position.x * inv_w + 1.f) * .5f * sz.width),
+      .y = snap((1.f - v.position.y * inv_w) * .5f * sz.height),
+      .z = (v.position.z * inv_w + 1.f) * .5f,
+      .inv_w = inv_w,
+      .color = v.color
+  };
+}
+
+bool outside_frustum(const vertex& v0, const vertex& v1, const vertex& v2) noexcept {
+  for (int axis = 0; axis < 3; ++axis) {
+    const auto below = [axis](const vertex& v) { return v.position[axis] < -v.position.w; };
+    const auto above = [axis](const vertex& v) { return v.position[axis] > v.position.w; };
+    if ((below(v0) && below(v1) && below(v2)) || (above(v0) && above(v1) && above(v2)))
+      return true;
+  }
+  return false;
+}
+
+void set_edge(triangle_setup& tri, int k, const screen_vertex& p, const screen_vertex& q) noexcept {
+  tri.a[k] = p.y - q.y;
+  tri.b[k] = q.x - p.x;
+  tri.c[k] = p.x * q.y - p.y * q.x;
+  // Gradient of the edge function points inside of the triangle so the
+  // triangle is below top edges and to the right of left ones.
+  tri.top_left[k] = tri.a[k] > 0.f || (tri.a[k] == 0.f && tri.b[k] > 0.f);
+}
+
+} // namespace
+
+std::optional<triangle_setup>
+detail::setup_triangle(const vertex& v0, const vertex& v1, const vertex& v2, ::size sz) noexcept {
+  if (!(v0.position.w > 0.f && v1.position.w > 0.f && v2.position.w > 0.f))
+    return std::nullopt;
+  if (outside_frustum(v0, v1, v2))
+    return std::nullopt;
+
+  std::array<screen_vertex, 3> verts{to_screen(v0, sz), to_screen(v1, sz), to_screen(v2, sz)};
+  for (const auto& v : verts) {
+    if (!(std::abs(v.x) < guard_band && std::abs(v.y) < guard_band))
+      return std::nullopt;
+  }
+
+  triangle_setup tri;
+  const auto setup_edges = [&] {
+    set_edge(tri, 0, verts[1], verts[2]);
+    set_edge(tri, 1, verts[2], verts[0]);
+    set_edge(tri, 2, verts[0], verts[1]);
+    return tri.a[0] * verts[0].x + tri.b[0] * verts[0].y + tri.c[0];
+  };
+  float area = setup_edges();
+  if (area < 0.f) {
+    // Both windings are drawn. Swapping vertices negates edge functions
+    // exactly so adjacent triangles still share edges without gaps.
+    std::swap(verts[1], verts[2]);
+    area = setup_edges();
+  }
+  if (!(area > 0.f))
+    return std::nullopt;
+
+  tri.inv_area = 1.f / area;
+  tri.z0 = verts[0].z;
+  tri.dz1 = verts[1].z - verts[0].z;
+  tri.dz2 = verts[2].z - verts[0].z;
+  for (int k = 0; k < 3; ++k) {
+    tri.inv_w[k] = verts[k].inv_w;
+    tri.red[k] = verts[k].color.r;
+    tri.green[k] = verts[k].color.g;
+    tri.blue[k] = verts[k].color.b;
+  }
+
+  const auto [min_x, max_x] = std::minmax({verts[0].x, verts[1].x, verts[2].x});
+  const auto [min_y, max_y] = std::minmax({verts[0].y, verts[1].y, verts[2].y});
+  const auto left = static_cast<int32_t>(std::floor(min_x));
+  const auto top = static_cast<int32_t>(std::floor(min_y));
+  tri.bounds = intersection(
+      rect{
+          .x = left,
+          .y = top,
+          .width = static_cast<int32_t>(std::ceil(max_x)) - left,
+          .height = static_cast<int32_t>(std::ceil(max_y)) - top
+      },
+      rect{.width = sz.width, .height = sz.height}
+  );
+  if (empty(tri.bounds))
+    return std::nullopt;
+  return tri;
+}
+
+namespace {
+
+namespace scalar {
+
+// Floating point operations are kept in the same order as in the vector
+// kernels so that all of them produce identical images.
+void shade_row(
+    const triangle_setup& tri, int32_t x, int32_t y, int32_t count, float* depth, uint32_t* color
+) noexcept {
+  const float py = static_cast<float>(y) + .5f;
+  for (int32_t i = 0; i < count; ++i) {
+    const float px = static_cast<float>(x + i) + .5f;
+    float e[3];
+    bool inside = true;
+    for (int k = 0; k < 3; ++k) {
+      e[k] = tri.a[k] * px + tri.b[k] * py + tri.c[k];
+      inside = inside && (e[k] > 0.f || (e[k] == 0.f && tri.top_left[k]));
+    }
+    if (!inside)
+      continue;
+
+    const float b0 = e[0] * tri.inv_area;
+    const float b1 = e[1] * tri.inv_area;
+    const float b2 = e[2] * tri.inv_area;
+    const float z = tri.z0 + b1 * tri.dz1 + b2 * tri.dz2;
+    if (!(z >= 0.f && z < depth[i]))
+      continue;
+    depth[i] = z;
+
+    // Colors are interpolated with perspective correction
+    const float q0 = b0 * tri.inv_w[0];
+    const float q1 = b1 * tri.inv_w[1];
+    const float q2 = b2 * tri.inv_w[2];
+    const float sum = q0 + q1 + q2;
+    const auto channel = [&](const float* c) {
+      const float val = std::min(std::max((q0 * c[0] + q1 * c[1] + q2 * c[2]) / sum, 0.f), 1.f);
+      return static_cast<uint32_t>(val * 255.f + .5f);
+    };
+    color[i] = 0xff000000 | channel(tri.red) << 16 | channel(tri.green) << 8 | channel(tri.blue);
+  }
+}
+
+constexpr kernels table{.isa = "scalar", .shade_row = shade_row};
+
+} // namespace scalar
+
+#if defined(__x86_64__) || defined(__i386__)
+
+namespace avx2 {
+
+[[gnu::target("avx2")]] inline __m256i channel(
+    __m256 q0, __m256 q1, __m256 q2, __m256 sum, const float* c
+) noexcept {
+  __m256 val = _mm256_add_ps(
+      _mm256_add_ps(_mm256_mul_ps(q0, _mm256_set1_ps(c[0])), _mm256_mul_ps(q1, _mm256_set1_ps(c[1]))),
+      _mm256_mul_ps(q2, _mm256_set1_ps(c[2]))
+  );
+  val = _mm256_min_ps(_mm256_max_ps(_mm256_div_ps(val, sum), _mm256_setzero_ps()), _mm256_set1_ps(1.f));
+  return _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(val, _mm256_set1_ps(255.f)), _mm256_set1_ps(.5f)));
+}
+
+[[gnu::target("avx2")]] void shade_row(
+    const triangle_setup& tri, int32_t x, int32_t y, int32_t count, float* depth, uint32_t* color
+) noexcept {
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 py = _mm256_set1_ps(static_cast<float>(y) + .5f);
+  const __m256 centers = _mm256_setr_ps(.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+  const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  for (int32_t i = 0; i < count; i += 8) {
+    const __m256 px = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(x + i)), centers);
+    __m256 e[3];
+    __m256 inside = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(count - i), lanes));
+    for (int k = 0; k < 3; ++k) {
+      e[k] = _mm256_add_ps(
+          _mm256_add_ps(
+              _mm256_mul_ps(_mm256_set1_ps(tri.a[k]), px), _mm256_mul_ps(_mm256_set1_ps(tri.b[k]), py)
+          ),
+          _mm256_set1_ps(tri.c[k])
+      );
+      __m256 edge = _mm256_cmp_ps(e[k], zero, _CMP_GT_OQ);
+      if (tri.top_left[k])
+        edge = _mm256_or_ps(edge, _mm256_cmp_ps(e[k], zero, _CMP_EQ_OQ));
+      inside = _mm256_and_ps(inside, edge);
+    }
+    if (_mm256_movemask_ps(inside) == 0)
+      continue;
+
+    const __m256 inv_area = _mm256_set1_ps(tri.inv_area);
+    const __m256 b0 = _mm256_mul_ps(e[0], inv_area);
+    const __m256 b1 = _mm256_mul_ps(e[1], inv_area);
+    const __m256 b2 = _mm256_mul_ps(e[2], inv_area);
+    const __m256 z = _mm256_add_ps(
+        _mm256_add_ps(_mm256_set1_ps(tri.z0), _mm256_mul_ps(b1, _mm256_set1_ps(tri.dz1))),
+        _mm256_mul_ps(b2, _mm256_set1_ps(tri.dz2))
+    );
+    const __m256 stored = _mm256_maskload_ps(depth + i, _mm256_castps_si256(inside));
+    const __m256 pass = _mm256_and_ps(
+        inside, _mm256_and_ps(_mm256_cmp_ps(z, zero, _CMP_GE_OQ), _mm256_cmp_ps(z, stored, _CMP_LT_OQ))
+    );
+    if (_mm256_movemask_ps(pass) == 0)
+      continue;
+    _mm256_maskstore_ps(depth + i, _mm256_castps_si256(pass), z);
+
+    const __m256 q0 = _mm256_mul_ps(b0, _mm256_set1_ps(tri.inv_w[0]));
+    const __m256 q1 = _mm256_mul_ps(b1, _mm256_set1_ps(tri.inv_w[1]));
+    const __m256 q2 = _mm256_mul_ps(b2, _mm256_set1_ps(tri.inv_w[2]));
+    const __m256 sum = _mm256_add_ps(_mm256_add_ps(q0, q1), q2);
+    const __m256i pixels = _mm256_or_si256(
+        _mm256_or_si256(
+            _mm256_set1_epi32(static_cast<int32_t>(0xff000000)),
+            _mm256_slli_epi32(channel(q0, q1, q2, sum, tri.red), 16)
+        ),
+        _mm256_or_si256(
+            _mm256_slli_epi32(channel(q0, q1, q2, sum, tri.green), 8), channel(q0, q1, q2, sum, tri.blue)
+        )
+    );
+    _mm256_maskstore_epi32(reinterpret_cast<int*>(color + i), _mm256_castps_si256(pass), pixels);
+  }
+}
+
+constexpr kernels table{.isa = "avx2", .shade_row = shade_row};
+
+} // namespace avx2
+
+#endif
+
+std::vector<const kernels*> select_kernels() {
+  std::vector<const kernels*> res{&scalar::table};
+#if defined(__x86_64__) || defined(__i386__)
+  if (__builtin_cpu_supports("avx2"))
+    res.push_back(&avx2::table);
+#endif
+  return res;
+}
+
+const kernels& active_kernels() noexcept { return *detail::supported_rasterizer_kernels().back(); }
+
+} // namespace
+
+std::span<const detail::rasterizer_kernels* const> detail::supported_rasterizer_kernels() noexcept {
+  static const std::vector<const rasterizer_kernels*> res = select_kernels();
+  return res;
+}
+
+std::string_view rasterizer_isa() noexcept { return active_kernels().isa; }
+
+void rasterizer::resize(::size sz) {
+  sz_ = sz;
+  tiles_x_ = (sz.width + tile_size - 1) / tile_size;
+  const int32_t tiles_y = (sz.height + tile_size - 1) / tile_size;
+  bins_.resize(std::max(tiles_x_ * tiles_y, 0));
+  clear({});
+}
+
+void rasterizer::clear(glm::vec4 color) {
+  clear_color_ = pack_color(color);
+  triangles_.clear();
+  for (auto& bin : bins_)
+    bin.clear();
+}
+
+void rasterizer::draw(std::span<const vertex> verticies, std::span<const unsigned> indexes) {
+  for (size_t i = 0; i + 2 < indexes.size(); i += 3) {
+    const auto tri = detail::setup_triangle(
+        verticies[indexes[i]], verticies[indexes[i + 1]], verticies[indexes[i + 2]], sz_
+    );
+    if (!tri)
+      continue;
+
+    const auto idx = static_cast<uint32_t>(triangles_.size());
+    triangles_.push_back(*tri);
+    const rect& bounds = tri->bounds;
+    for (int32_t ty = bounds.y / tile_size; ty <= (bounds.y + bounds.height - 1) / tile_size; ++ty) {
+      for (int32_t tx = bounds.x / tile_size; tx <= (bounds.x + bounds.width - 1) / tile_size; ++tx)
+        bins_[ty * tiles_x_ + tx].push_back(idx);
+    }
+  }
+}
+
+void rasterizer::rasterize_tiles(std::span<std::byte> dest, size_t first, size_t count) const {
+  const auto& kern = active_kernels();
+  alignas(32) std::array<float, tile_size * tile_size> depth;
+  alignas(32) std::array<uint32_t, tile_size * tile_size> color;
+  for (size_t tile = first; tile < first + count; ++tile) {
+    const rect area = intersection(
+        rect{
+            .x = static_cast<int32_t>(tile % tiles_x_) * tile_size,
+            .y = static_cast<int32_t>(tile / tiles_x_) * tile_size,
+            .width = tile_size,
+            .height = tile_size
+        },
+        rect{.width = sz_.width, .height = sz_.height}
+    );
+    std::ranges::fill(depth, 1.f);
+    std::ranges::fill(color, clear_color_);
+
+    for (uint32_t idx : bins_[tile]) {
+      const triangle_setup& tri = triangles_[idx];
+      const rect span = intersection(tri.bounds, area);
+      for (int32_t y = span.y; y < span.y + span.height; ++y) {
+        const size_t pos = (y - area.y) * tile_size + (span.x - area.x);
+        kern.shade_row(tri, span.x, y, span.width, depth.data() + pos, color.data() + pos);
+      }
+    }
+
+    for (int32_t y = area.y; y < area.y + area.height; ++y) {
+      std::memcpy(
+          dest.data() + 4 * (static_cast<size_t>(y) * sz_.width + area.x),
+          color.data() + (y - area.y) * tile_size, 4 * area.width
+      );
+    }
+  }
+}
+
+} // namespace swrast
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include <libs/geom/geom.hpp>
+#include <libs/img/parallel.hpp>
+
+namespace swrast {
+
+/// Name of the instruction set the rasterization kernels were selected for at
+/// startup: "avx2" or "scalar".
+std::string_view rasterizer_isa() noexcept;
+
+/// Result of the vertex processing: clip space position and the color
+/// interpolated over triangles.
+struct vertex {
+  glm::vec4 position;
+  glm::vec3 color;
+};
+
+/// Triangle in pixel coordinates prepared for rasterization.
+struct triangle_setup {
+  // Edge functions a*x + b*y + c are positive inside of the triangle. Edge k
+  // is the one opposite to the vertex k and its value divided by the doubled
+  // triangle area is the barycentric coordinate of that vertex.
+  float a[3];
+  float b[3];
+  float c[3];
+  // Pixels exactly on top and left edges belong to the triangle so that
+  // pixels on edges shared by adjacent triangles are drawn exactly once.
+  bool top_left[3];
+  float inv_area;
+  float z0;
+  float dz1;
+  float dz2;
+  float inv_w[3];
+  float red[3];
+  float green[3];
+  float blue[3];
+  rect bounds;
+};
+
+namespace detail {
+
+/// Prepares the triangle for drawing into the image of size `sz`. Triangles
+/// which are invisible or have to be dropped are not returned.
+std::optional<triangle_setup>
+setup_triangle(const vertex& v0, const vertex& v1, const vertex& v2, ::size sz) noexcept;
+
+struct rasterizer_kernels {
+  std::string_view isa;
+  /// Draws `count` pixels of the row `y` starting from `x` which are covered
+  /// by the triangle and pass the depth test.
+  void (*shade_row)(
+      const triangle_setup& tri, int32_t x, int32_t y, int32_t count, float* depth, uint32_t* color
+  ) noexcept;
+};
+
+/// Kernels the current CPU is able to run starting from the scalar ones.
+/// The last of them are used for rasterization.
+std::span<const rasterizer_kernels* const> supported_rasterizer_kernels() noexcept;
+
+} // namespace detail
+
+/// Draws triangle meshes into 4 byte premultiplied BGRA images with the
+/// layout of WL_SHM_FORMAT_ARGB8888 buffers. Triangles are binned into square
+/// tiles when submitted and rasterized tile by tile later with a depth buffer
+/// which fits into cache. Tiles are independent so they are processed
+/// concurrently and the result depends neither on the order of processing
+/// nor on the instruction set in use.
+///
+/// Depth test passes for fragments closer than the stored ones as with
+/// GL_LESS. Triangles with any vertex behind the camera are dropped instead
+/// of being clipped.
+class rasterizer {
+public:
+  static constexpr int32_t tile_size = 64;
+
+  void resize(::size sz);
+  ::size size() const noexcept { return sz_; }
+
+  /// Starts a new frame filled with the `color` having straight alpha and
+  /// the farthest depth.
+  void clear(glm::vec4 color);
+  /// Bins triangles of the indexed mesh for the current frame.
+  void draw(std::span<const vertex> verticies, std::span<const unsigned> indexes);
+
+  size_t tiles_count() const noexcept { return bins_.size(); }
+  /// Rasterizes `count` tiles starting from `first` into the `dest` image of
+  /// size(). Distinct tiles may be rasterized concurrently.
+  void rasterize_tiles(std::span<std::byte> dest, size_t first, size_t count) const;
+
+private:
+  ::size sz_;
+  int32_t tiles_x_ = 0;
+  uint32_t clear_color_ = 0;
+  std::vector<triangle_setup> triangles_;
+  // Indexes of triangles touching each tile in the order of submission
+  std::vector<std::vector<uint32_t>> bins_;
+};
+
+/// Rasterizes the whole frame into `dest` processing tiles concurrently on
+/// the `exec`.
+template <typename Executor>
+void rasterize(const Executor& exec, const rasterizer& rast, std::span<std::byte> dest) {
+  img::parallel_rows(exec, rast.tiles_count(), 1, [&](size_t first, size_t count) {
+    rast.rasterize_tiles(dest, first, count);
+  });
+}
+
+} // namespace swrast
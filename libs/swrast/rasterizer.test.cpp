@@ -0,0 +1,157 @@
+#include "rasterizer.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+namespace {
+
+constexpr size image_size{.width = 150, .height = 70};
+
+std::vector<uint32_t> render(const swrast::rasterizer& rast) {
+  std::vector<std::byte> bytes(4 * rast.size().width * rast.size().height);
+  rast.rasterize_tiles(bytes, 0, rast.tiles_count());
+  std::vector<uint32_t> res(bytes.size() / 4);
+  std::memcpy(res.data(), bytes.data(), bytes.size());
+  return res;
+}
+
+swrast::vertex at(float x, float y, float z = 0.f, glm::vec3 color = {1., 1., 1.}) {
+  return {.position = {x, y, z, 1.}, .color = color};
+}
+
+std::vector<uint32_t> render_mesh(std::span<const swrast::vertex> verts, std::span<const unsigned> idxs) {
+  swrast::rasterizer rast;
+  rast.resize(image_size);
+  rast.clear({});
+  rast.draw(verts, idxs);
+  return render(rast);
+}
+
+} // namespace
+
+SCENARIO("Triangles rasterization") {
+  GIVEN("fan of triangles covering the whole image around an arbitrary point") {
+    const float cx = GENERATE(0.f, 0.013f, -0.37f);
+    const float cy = GENERATE(0.f, 0.29f, -0.0071f);
+    const swrast::vertex verts[] = {at(cx, cy), at(-1, -1), at(1, -1), at(1, 1), at(-1, 1)};
+    const unsigned idxs[] = {0, 1, 2, 0, 2, 3, 0, 3, 4, 0, 4, 1};
+
+    WHEN("each triangle is rendered separately") {
+      std::vector<int> coverage(image_size.width * image_size.height);
+      for (size_t tri = 0; tri < std::size(idxs); tri += 3) {
+        const auto pixels = render_mesh(verts, std::span{idxs}.subspan(tri, 3));
+        for (size_t i = 0; i < pixels.size(); ++i)
+          coverage[i] += pixels[i] != 0 ? 1 : 0;
+      }
+
+      THEN("every pixel is drawn exactly once") {
+        CHECK(std::ranges::count(coverage, 1) == image_size.width * image_size.height);
+      }
+    }
+  }
+
+  GIVEN("triangle with the same color in all vertices") {
+    const glm::vec3 color{.2, .6, 1.};
+    const swrast::vertex verts[] = {at(-1, -1, 0, color), at(1, -1, 0, color), at(0, 1, 0, color)};
+    const unsigned idxs[] = {0, 2, 1};
+
+    WHEN("it is rendered") {
+      const auto pixels = render_mesh(verts, idxs);
+
+      THEN("all drawn pixels have that color") {
+        for (uint32_t px : pixels)
+          CHECK((px == 0 || px == 0xff3399ff));
+        CHECK(pixels[image_size.width * (image_size.height - 1) + image_size.width / 2] == 0xff3399ff);
+      }
+    }
+  }
+
+  GIVEN("two overlapping triangles at different depth") {
+    const swrast::vertex verts[] = {
+        at(-1, -1, .5, {1, 0, 0}), at(1, -1, .5, {1, 0, 0}), at(0, 1, .5, {1, 0, 0}),
+        at(-1, 1, -.5, {0, 0, 1}), at(1, 1, -.5, {0, 0, 1}), at(0, -1, -.5, {0, 0, 1}),
+    };
+    const unsigned near_first[] = {3, 4, 5, 0, 1, 2};
+    const unsigned far_first[] = {0, 1, 2, 3, 4, 5};
+
+    WHEN("they are rendered in different order") {
+      const auto pixels = render_mesh(verts, near_first);
+
+      THEN("the nearer one is visible in both cases") {
+        CHECK(pixels == render_mesh(verts, far_first));
+        CHECK(pixels[image_size.width * (image_size.height / 2) + image_size.width / 2] == 0xff0000ff);
+      }
+    }
+  }
+
+  GIVEN("rasterizer cleared with a translucent color") {
+    swrast::rasterizer rast;
+    rast.resize(image_size);
+    rast.clear({1., .5, 0., .5});
+
+    WHEN("empty frame is rendered") {
+      const auto pixels = render(rast);
+
+      THEN("all pixels have premultiplied clear color") {
+        CHECK(std::ranges::count(pixels, 0x80804000) == image_size.width * image_size.height);
+      }
+    }
+  }
+}
+
+SCENARIO("Row shading kernels for different instruction sets") {
+  const auto supported = swrast::detail::supported_rasterizer_kernels();
+  REQUIRE(supported.front()->isa == "scalar");
+  CHECK(supported.back()->isa == swrast::rasterizer_isa());
+
+  GIVEN("triangle with distinct vertex colors") {
+    const swrast::vertex triangles[][3] = {
+        // Different w of vertices make perspective correction matter
+        {{.position = {-.9, -.8, .3, 1.}, .color = {1, 0, 0}},
+         {.position = {1.7, -.2, -.4, 2.}, .color = {0, 1, 0}},
+         {.position = {.1, .95, .9, 1.3}, .color = {0, 0, 1}}},
+        // Pixel centers lie exactly on the vertical and horizontal edges
+        {at(-.5, -.5, 0, {1, 1, 0}), at(.5, -.5, .5, {0, 1, 1}), at(-.5, .5, -.5, {1, 0, 1})},
+        // Thin sliver covering a few pixels of each row
+        {at(-1, -.5, 0, {.3, .6, .9}), at(1, -.49, 0, {.9, .6, .3}), at(.3, -.43, 0, {.5, .5, .5})},
+    };
+    const auto& verts = triangles[GENERATE(0, 1, 2)];
+    const auto tri = swrast::detail::setup_triangle(verts[0], verts[1], verts[2], image_size);
+    REQUIRE(tri);
+
+    WHEN("rows around it are shaded over depth values failing the test for some pixels") {
+      // Rows start before the triangle and end after it to cover partial
+      // vectors of pixels on both sides
+      const int32_t x = tri->bounds.x - 3;
+      const int32_t count = tri->bounds.width + 7;
+      const auto shade = [&](const swrast::detail::rasterizer_kernels& kern) {
+        std::vector<float> depth(count * tri->bounds.height);
+        std::vector<uint32_t> color(depth.size(), 0);
+        for (size_t i = 0; i < depth.size(); ++i)
+          depth[i] = i % 3 == 0 ? .5f : 1.f;
+        for (int32_t row = 0; row < tri->bounds.height; ++row) {
+          kern.shade_row(
+              *tri, x, tri->bounds.y + row, count, depth.data() + row * count, color.data() + row * count
+          );
+        }
+        return std::pair{depth, color};
+      };
+      const auto [expected_depth, expected_color] = shade(*supported.front());
+
+      THEN("all kernels produce the same depth and colors as the scalar ones") {
+        CHECK(std::ranges::count(expected_color, 0u) < std::ssize(expected_color));
+        for (const auto* kern : supported) {
+          INFO("isa: " << kern->isa);
+          const auto [depth, color] = shade(*kern);
+          CHECK(depth == expected_depth);
+          CHECK(color == expected_color);
+        }
+      }
+    }
+  }
+}
@@ -1,11 +1,38 @@
 #pragma once
 
 #include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
 #include <cstdint>
+#include <ctime>
 #include <utility>
 
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
 class heartbeat;
 
+namespace detail {
+
+// std::atomic::wait has no timed version so beat counters are waited with
+// futex directly. Both sides have to use it since libstdc++ may skip waking
+// waiters it does not know about.
+inline void futex_wait(std::atomic<uint32_t>& word, uint32_t expected, const timespec* deadline) noexcept {
+  // Absolute deadline of CLOCK_MONOTONIC which backs steady_clock
+  ::syscall(
+      SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_BITSET_PRIVATE, expected, deadline, nullptr,
+      FUTEX_BITSET_MATCH_ANY
+  );
+}
+
+inline void futex_wake_all(std::atomic<uint32_t>& word) noexcept {
+  ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+}
+
+} // namespace detail
+
 class heartbeat_waiter {
 private:
   constexpr static uint32_t beat_mask = 0x00'ff'ff'ff;
@@ -15,9 +42,23 @@ public:
   constexpr heartbeat_waiter() noexcept = default;
 
   uint32_t wait_new_beats() noexcept {
-    beat_count_->wait(recieved_count_);
-    const uint32_t old = std::exchange(recieved_count_, beat_count_->load());
-    return (recieved_count_ & beat_mask) - (old & beat_mask);
+    while (beat_count_->load() == recieved_count_)
+      detail::futex_wait(*beat_count_, recieved_count_, nullptr);
+    return take_new_beats();
+  }
+
+  /// Same as wait_new_beats but gives up at the `deadline`. Zero is returned
+  /// both on timeout and on wake without new beats.
+  uint32_t wait_new_beats_until(std::chrono::steady_clock::time_point deadline) noexcept {
+    const auto since_epoch = deadline.time_since_epoch();
+    const auto sec = std::chrono::floor<std::chrono::seconds>(since_epoch);
+    const timespec ts{
+        .tv_sec = static_cast<time_t>(sec.count()),
+        .tv_nsec = static_cast<long>(std::chrono::nanoseconds{since_epoch - sec}.count())
+    };
+    while (beat_count_->load() == recieved_count_ && std::chrono::steady_clock::now() < deadline)
+      detail::futex_wait(*beat_count_, recieved_count_, &ts);
+    return take_new_beats();
   }
 
   void wake() const noexcept { wake_impl(*beat_count_); }
@@ -27,9 +68,14 @@ private:
   explicit heartbeat_waiter(std::atomic<uint32_t>* beat_count, uint32_t start_count) noexcept
       : beat_count_{beat_count}, recieved_count_{start_count} {}
 
+  uint32_t take_new_beats() noexcept {
+    const uint32_t old = std::exchange(recieved_count_, beat_count_->load());
+    return (recieved_count_ & beat_mask) - (old & beat_mask);
+  }
+
   static void wake_impl(std::atomic<uint32_t>& beat_count) noexcept {
     beat_count.fetch_add(wake_step);
-    beat_count.notify_all();
+    detail::futex_wake_all(beat_count);
   }
 
 private:
@@ -41,7 +87,7 @@ class heartbeat {
 public:
   void beat() {
     ++beat_count_;
-    beat_count_.notify_all();
+    detail::futex_wake_all(beat_count_);
   }
 
   void wake_waiters() noexcept { heartbeat_waiter::wake_impl(beat_count_); }
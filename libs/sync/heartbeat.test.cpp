@@ -0,0 +1,61 @@
+#include "heartbeat.hpp"
+
+#include <thread>
+
+#include <catch2/catch_test_macros.hpp>
+
+using namespace std::literals;
+
+SCENARIO("Waiting for heartbeats with a deadline") {
+  GIVEN("heartbeat waiter") {
+    heartbeat hb;
+    auto waiter = hb.make_waiter();
+
+    WHEN("nothing happens until the deadline") {
+      const auto deadline = std::chrono::steady_clock::now() + 10ms;
+      const auto beats = waiter.wait_new_beats_until(deadline);
+
+      THEN("waiting times out without new beats") {
+        CHECK(beats == 0);
+        CHECK(std::chrono::steady_clock::now() >= deadline);
+      }
+    }
+
+    WHEN("beats happen before waiting") {
+      hb.beat();
+      hb.beat();
+
+      THEN("they are returned right away") {
+        CHECK(waiter.wait_new_beats_until(std::chrono::steady_clock::now()) == 2);
+      }
+    }
+
+    WHEN("another thread beats while waiting") {
+      const auto start = std::chrono::steady_clock::now();
+      std::jthread beater{[&] {
+        std::this_thread::sleep_for(5ms);
+        hb.beat();
+      }};
+      const auto beats = waiter.wait_new_beats_until(start + 10s);
+
+      THEN("waiting is finished before the deadline") {
+        CHECK(beats == 1);
+        CHECK(std::chrono::steady_clock::now() - start < 5s);
+      }
+    }
+
+    WHEN("waiter is woken while waiting") {
+      const auto start = std::chrono::steady_clock::now();
+      std::jthread waker{[&] {
+        std::this_thread::sleep_for(5ms);
+        waiter.wake();
+      }};
+      const auto beats = waiter.wait_new_beats_until(start + 10s);
+
+      THEN("it returns without new beats") {
+        CHECK(beats == 0);
+        CHECK(std::chrono::steady_clock::now() - start < 5s);
+      }
+    }
+  }
+}
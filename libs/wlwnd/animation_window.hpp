@@ -1,21 +1,24 @@
-#include <libs/corort/executors.hpp>
+#pragma once
+
+#include <atomic>
+#include <latch>
+#include <memory>
+
 #include <libs/sync/channel.hpp>
 
 #include <libs/wlwnd/event_loop.hpp>
+#include <libs/wlwnd/presentation.hpp>
 #include <libs/wlwnd/renderer.hpp>
 #include <libs/wlwnd/shell_window.hpp>
+#include <libs/wlwnd/xdg_window.hpp>
 
-namespace wl {
-class gui_shell;
-}
+class render_loop;
 
+/// Window drawn by a render_loop. Destruction removes the window from the
+/// loop and waits until the render thread destroys its renderer.
 class animation_window {
 public:
   animation_window() noexcept = default;
-  animation_window(
-      event_queue queue, co::pool_executor pool_exec, wl::sized_window<wl::shell_window>&& wnd,
-      animation_function animation_func
-  );
 
   animation_window(const animation_window&) = delete;
   animation_window& operator=(const animation_window&) = delete;
@@ -28,10 +31,41 @@ public:
   [[nodiscard]] bool is_closed() const noexcept;
 
 private:
-  struct impl;
+  friend class render_loop;
+  struct state;
+
+  animation_window(wl::shell_window&& wnd, std::shared_ptr<state> st);
+
+  void detach() noexcept;
 
 private:
+  // Shell window may still call its delegate until destroyed
+  std::shared_ptr<state> state_;
   wl::shell_window wnd_;
-  event_queue queue_;
-  std::unique_ptr<impl> impl_;
+};
+
+// Shared between the thread handling window events and the render thread
+struct animation_window::state : xdg::delegate {
+  state(event_queue& queue, wl::sized_window<wl::shell_window>& wnd, animation_function animation)
+      : queue{queue}, surface{wnd.window.get_surface()}, presentation{wnd.presentation},
+        viewporter{wnd.viewporter}, fractional_scale{wnd.fractional_scale},
+        animation{std::move(animation)}, resize_channel{wnd.sz} {}
+
+  // Render thread may be idle waiting for events on its own queue
+  void resize(size sz) override {
+    resize_channel.update(sz);
+    queue.wake();
+  }
+  void close() override;
+
+  event_queue& queue;
+  wl_surface& surface;
+  wl::presentation_service presentation;
+  wp_viewporter* viewporter;
+  wp_fractional_scale_manager_v1* fractional_scale;
+  animation_function animation;
+  value_update_channel<size> resize_channel;
+  std::atomic<bool> closed = false;
+  std::atomic<bool> detached = false;
+  std::latch released{1};
 };
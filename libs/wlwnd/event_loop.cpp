@@ -1,30 +1,83 @@
-#include <asio/posix/stream_descriptor.hpp>
+#include <cerrno>
+#include <system_error>
+
 #include <asio/use_awaitable.hpp>
 
 #include <libs/wlwnd/event_loop.hpp>
 #include <libs/wlwnd/ui_category.hpp>
 
+namespace {
+
+// Cancels the prepared read unless events are read. This covers exceptions
+// as well as destruction of the coroutine suspended on the display socket
+// which would otherwise leave other threads stuck waiting for the read.
+class read_intent {
+public:
+  explicit read_intent(wl_display& display) noexcept : display_{display} {}
+
+  read_intent(const read_intent&) = delete;
+  read_intent& operator=(const read_intent&) = delete;
+
+  ~read_intent() noexcept {
+    if (prepared_)
+      wl_display_cancel_read(&display_);
+  }
+
+  bool prepare() noexcept {
+    prepared_ = wl_display_prepare_read(&display_) == 0;
+    return prepared_;
+  }
+
+  void read() {
+    prepared_ = false;
+    if (wl_display_read_events(&display_) != 0)
+      throw std::system_error{errno, std::system_category(), "wl_display_read_events"};
+  }
+
+private:
+  wl_display& display_;
+  bool prepared_ = false;
+};
+
+} // namespace
+
 event_loop::event_loop(const char* display) : display_{wl_display_connect(display)} {
   if (!display_)
     throw std::system_error{errno, std::system_category(), "wl_display_connect"};
 }
 
+event_loop::~event_loop() noexcept {
+  if (conn_)
+    conn_->release();
+}
+
 void event_loop::dispatch() noexcept { wl_display_dispatch(display_.get()); }
 
 void event_loop::dispatch_pending() noexcept { wl_display_dispatch_pending(display_.get()); }
 
 asio::awaitable<void> event_loop::dispatch_once(asio::io_context::executor_type exec) {
-  if (wl_display_prepare_read(&get_display()) != 0) {
+  wl_display& display = get_display();
+  read_intent intent{display};
+  if (!intent.prepare()) {
     dispatch_pending();
     co_return;
   }
-  wl_display_flush(&get_display());
-  asio::posix::stream_descriptor conn{exec, wl_display_get_fd(&get_display())};
-  co_await conn.async_wait(asio::posix::stream_descriptor::wait_read, asio::use_awaitable);
-  conn.release();
-  wl_display_read_events(&get_display());
-  heartbeat_.beat();
-  // TODO `wl_display_cancel_read(display);` on wait failure!!!
-  dispatch_pending();
+
+  if (!conn_)
+    conn_.emplace(exec, wl_display_get_fd(&display));
+  // Requests may not fit into the socket buffer at once
+  while (wl_display_flush(&display) < 0) {
+    if (errno != EAGAIN)
+      throw std::system_error{errno, std::system_category(), "wl_display_flush"};
+    co_await conn_->async_wait(asio::posix::stream_descriptor::wait_write, asio::use_awaitable);
+  }
+  co_await conn_->async_wait(asio::posix::stream_descriptor::wait_read, asio::use_awaitable);
+
+  asio::error_code ec;
+  do {
+    intent.read();
+    heartbeat_.beat();
+    dispatch_pending();
+  } while (conn_->available(ec) > 0 && !ec && intent.prepare());
   co_return;
 }
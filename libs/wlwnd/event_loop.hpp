@@ -1,7 +1,11 @@
 #pragma once
 
+#include <chrono>
+#include <optional>
+
 #include <asio/awaitable.hpp>
 #include <asio/io_context.hpp>
+#include <asio/posix/stream_descriptor.hpp>
 
 #include <libs/sync/heartbeat.hpp>
 
@@ -22,6 +26,9 @@ public:
 
   wl_event_queue& get() const noexcept { return *queue_; }
   void dispatch();
+  /// Waits for events read by the event loop or wake up until the `deadline`
+  /// and dispatches them.
+  void dispatch_until(std::chrono::steady_clock::time_point deadline);
   void dispatch_pending();
   wl_display& display() const noexcept { return *display_; }
 
@@ -37,6 +44,11 @@ class event_loop {
 public:
   event_loop(const char* display);
 
+  event_loop(const event_loop&) = delete;
+  event_loop& operator=(const event_loop&) = delete;
+
+  ~event_loop() noexcept;
+
   [[nodiscard]] wl_display& get_display() const noexcept { return *display_; }
 
   void dispatch() noexcept;
@@ -44,6 +56,10 @@ public:
 
   event_queue make_queue() noexcept { return event_queue{*this}; }
 
+  /// Waits for the display socket to become readable and dispatches all the
+  /// events available without waiting again. The socket is registered with
+  /// the reactor of the `exec` on the first call and stays there, so the
+  /// same executor has to be passed every time.
   asio::awaitable<void> dispatch_once(asio::io_context::executor_type exec);
   template <std::predicate Pred>
   asio::awaitable<void> dispatch_while(asio::io_context::executor_type exec, Pred&& pred) {
@@ -58,6 +74,8 @@ private:
 private:
   wl::unique_ptr<wl_display> display_;
   heartbeat heartbeat_;
+  // Wraps the descriptor owned by the display and never closes it
+  std::optional<asio::posix::stream_descriptor> conn_;
 };
 
 inline event_queue::event_queue(event_loop& eloop) noexcept
@@ -69,4 +87,9 @@ inline void event_queue::dispatch() {
     dispatch_pending();
 }
 
+inline void event_queue::dispatch_until(std::chrono::steady_clock::time_point deadline) {
+  if (waiter_.wait_new_beats_until(deadline) != 0)
+    dispatch_pending();
+}
+
 inline void event_queue::dispatch_pending() { wl_display_dispatch_queue_pending(display_, queue_.get()); }
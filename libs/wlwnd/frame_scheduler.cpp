@@ -0,0 +1,69 @@
+#include <algorithm>
+#include <utility>
+
+#include <libs/wlwnd/frame_scheduler.hpp>
+
+namespace {
+
+double moving_average(double average, double sample, double weight) noexcept {
+  return average == 0 ? sample : average + weight * (sample - average);
+}
+
+} // namespace
+
+frame_scheduler::clock::time_point
+frame_scheduler::frame_callback(clock::time_point now, std::chrono::nanoseconds refresh) noexcept {
+  const auto prev = std::exchange(last_callback_, now);
+  if (refresh > std::chrono::nanoseconds::zero()) {
+    refresh_ = static_cast<double>(refresh.count());
+  } else if (prev) {
+    const auto interval = static_cast<double>((now - prev.value()).count());
+    // Much longer intervals mean skipped frames and much shorter ones mean
+    // that the estimate was made from skipped frames
+    if (refresh_ == 0 || interval < .75 * refresh_)
+      refresh_ = interval;
+    else if (interval < 1.5 * refresh_)
+      refresh_ = moving_average(refresh_, interval, opts_.smoothing);
+  }
+
+  if (refresh_ == 0 || samples_ < min_samples) {
+    deadline_.reset();
+    return now;
+  }
+  deadline_ = now + refresh_period();
+  return std::max(now, deadline_.value() - opts_.margin - planned_cost());
+}
+
+void frame_scheduler::frame_started(clock::time_point now) noexcept { started_ = now; }
+
+void frame_scheduler::frame_finished(clock::time_point now) noexcept {
+  if (!started_)
+    return;
+  const auto cost = now - std::exchange(started_, std::nullopt).value();
+  costs_[samples_++ % history_size] = cost;
+  average_cost_ = moving_average(average_cost_, static_cast<double>(cost.count()), opts_.smoothing);
+  if (deadline_ && now > deadline_.value())
+    ++missed_;
+}
+
+std::chrono::nanoseconds frame_scheduler::average_cost() const noexcept {
+  return std::chrono::nanoseconds{static_cast<std::chrono::nanoseconds::rep>(average_cost_)};
+}
+
+std::chrono::nanoseconds frame_scheduler::percentile_cost() const noexcept {
+  const size_t count = std::min(samples_, history_size);
+  if (count == 0)
+    return std::chrono::nanoseconds::zero();
+  auto costs = costs_;
+  const auto nth = costs.begin() + static_cast<ptrdiff_t>(opts_.percentile * static_cast<double>(count - 1));
+  std::nth_element(costs.begin(), nth, costs.begin() + count);
+  return *nth;
+}
+
+std::chrono::nanoseconds frame_scheduler::refresh_period() const noexcept {
+  return std::chrono::nanoseconds{static_cast<std::chrono::nanoseconds::rep>(refresh_)};
+}
+
+std::chrono::nanoseconds frame_scheduler::planned_cost() const noexcept {
+  return std::max(average_cost(), percentile_cost());
+}
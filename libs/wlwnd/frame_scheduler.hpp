@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <optional>
+
+struct frame_scheduler_options {
+  /// Time reserved between the planned end of a frame and the deadline to
+  /// absorb render cost jitter.
+  std::chrono::nanoseconds margin = std::chrono::milliseconds{2};
+  /// Render cost percentile frames are planned for. The moving average is
+  /// used instead if it happens to be higher.
+  double percentile = .95;
+  /// Weight of the latest sample in the render cost and refresh period moving
+  /// averages.
+  double smoothing = .125;
+};
+
+/// Plans the start of each frame so that it is finished right before the
+/// compositor deadline instead of right after the frame callback. Renderers
+/// started later pick the latest input and the frame reaches the screen with
+/// less latency.
+///
+/// Compositors send frame callbacks when they repaint, so the deadline is
+/// predicted one refresh period after the callback. Render cost is tracked
+/// over the last `history_size` frames. Frames are started without delay
+/// until `min_samples` costs are known.
+class frame_scheduler {
+public:
+  using clock = std::chrono::steady_clock;
+
+  static constexpr size_t history_size = 64;
+  static constexpr size_t min_samples = 8;
+
+  frame_scheduler() noexcept : frame_scheduler(frame_scheduler_options{}) {}
+  explicit frame_scheduler(frame_scheduler_options opts) noexcept : opts_{opts} {}
+
+  /// Registers the frame callback received at `now` and returns the time to
+  /// start drawing the frame at. Zero `refresh` means the output refresh
+  /// period is unknown and is estimated from intervals between callbacks.
+  clock::time_point frame_callback(clock::time_point now, std::chrono::nanoseconds refresh) noexcept;
+  void frame_started(clock::time_point now) noexcept;
+  /// Frame is finished once its buffer is committed.
+  void frame_finished(clock::time_point now) noexcept;
+
+  [[nodiscard]] std::chrono::nanoseconds average_cost() const noexcept;
+  [[nodiscard]] std::chrono::nanoseconds percentile_cost() const noexcept;
+  [[nodiscard]] std::chrono::nanoseconds refresh_period() const noexcept;
+  [[nodiscard]] size_t missed_deadlines() const noexcept { return missed_; }
+
+private:
+  std::chrono::nanoseconds planned_cost() const noexcept;
+
+private:
+  frame_scheduler_options opts_;
+  std::array<std::chrono::nanoseconds, history_size> costs_{};
+  size_t samples_ = 0;
+  double average_cost_ = 0;
+  double refresh_ = 0;
+  std::optional<clock::time_point> last_callback_;
+  std::optional<clock::time_point> started_;
+  std::optional<clock::time_point> deadline_;
+  size_t missed_ = 0;
+};
@@ -0,0 +1,87 @@
+#include "frame_scheduler.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+using namespace std::literals;
+
+namespace {
+
+using time_point = frame_scheduler::clock::time_point;
+
+constexpr auto refresh = 16ms;
+
+// Runs frames of the given cost starting each at the planned time and
+// returns the time of the next frame callback.
+time_point run_frames(
+    frame_scheduler& scheduler, time_point callback, size_t count, std::chrono::nanoseconds cost,
+    std::chrono::nanoseconds known_refresh = refresh
+) {
+  for (size_t i = 0; i < count; ++i, callback += refresh) {
+    const auto start = scheduler.frame_callback(callback, known_refresh);
+    scheduler.frame_started(start);
+    scheduler.frame_finished(start + cost);
+  }
+  return callback;
+}
+
+} // namespace
+
+SCENARIO("Frames scheduling") {
+  GIVEN("scheduler with 1ms safety margin") {
+    frame_scheduler scheduler{{.margin = 1ms}};
+    const time_point callback{1h};
+
+    WHEN("render cost history is too short") {
+      const auto next = run_frames(scheduler, callback, frame_scheduler::min_samples - 1, 3ms);
+
+      THEN("frames are started right on the frame callback") {
+        CHECK(scheduler.frame_callback(next, refresh) == next);
+      }
+    }
+
+    WHEN("frames have the same render cost") {
+      const auto next = run_frames(scheduler, callback, 20, 3ms);
+
+      THEN("frame is started to finish the margin before the next refresh") {
+        CHECK(scheduler.average_cost() == 3ms);
+        CHECK(scheduler.percentile_cost() == 3ms);
+        CHECK(scheduler.frame_callback(next, refresh) == next + refresh - 1ms - 3ms);
+      }
+      THEN("no deadlines are missed") { CHECK(scheduler.missed_deadlines() == 0); }
+    }
+
+    WHEN("some frames are much more expensive") {
+      auto next = callback;
+      for (size_t i = 0; i < 4; ++i) {
+        next = run_frames(scheduler, next, 1, 10ms);
+        next = run_frames(scheduler, next, 9, 2ms);
+      }
+
+      THEN("frames are planned for the expensive ones") {
+        CHECK(scheduler.percentile_cost() == 10ms);
+        CHECK(scheduler.frame_callback(next, refresh) == next + refresh - 1ms - 10ms);
+      }
+    }
+
+    WHEN("frames are more expensive than the refresh period") {
+      run_frames(scheduler, callback, 20, 20ms);
+
+      THEN("they are started right away and miss deadlines") {
+        CHECK(scheduler.missed_deadlines() > 0);
+        const auto next = callback + 100 * refresh;
+        CHECK(scheduler.frame_callback(next, refresh) == next);
+      }
+    }
+
+    WHEN("refresh period is unknown") {
+      auto next = run_frames(scheduler, callback, 10, 3ms, 0ns);
+      // Skipped frame
+      next = run_frames(scheduler, next + refresh, 10, 3ms, 0ns);
+
+      THEN("it is estimated from frame callbacks ignoring skipped frames") {
+        CHECK(scheduler.refresh_period() == refresh);
+        CHECK(scheduler.frame_callback(next, 0ns) == next + refresh - 1ms - 3ms);
+      }
+    }
+  }
+}
@@ -1,36 +1,197 @@
 #include "framebuf.hpp"
 
-#include <libs/xdg/xdg.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+#include <utility>
+
+#include <unistd.h>
 
 namespace wl {
 
-framebuf::framebuf(wl_shm& shm, size sz) {
+struct framebuf::buffer {
+  wl::unique_ptr<wl_buffer> handle;
+  size_t offset = 0;
+  // Created for another size and has to be recreated once released
+  bool stale = true;
+  bool busy = false;
+  uint64_t frame = 0;
+};
+
+framebuf::framebuf(wl_shm& shm, wl_display& display, ::size sz, framebuf_options opts)
+    : shm_{&shm}, display_{&display}, opts_{opts}, queue_{wl_display_create_queue(&display)} {
+  resize(sz);
+}
+
+framebuf::framebuf(framebuf&&) noexcept = default;
+framebuf& framebuf::operator=(framebuf&&) noexcept = default;
+
+framebuf::~framebuf() noexcept = default;
+
+void framebuf::resize(::size sz) {
+  sz_ = sz;
+  cur_ = no_front;
+  frame_ = 0;
+  damage_.clear();
+  for (auto& buf : bufs_)
+    buf->frame = 0;
+
   const size_t pixel_size = 4 * sz.width * sz.height;
+  if (pixel_size <= slot_size_) {
+    for (auto& buf : bufs_)
+      buf->stale = true;
+    return;
+  }
 
-  auto mapping_fd = thinsys::io::open_anonymous(xdg::runtime_dir(), thinsys::io::mode::read_write);
-  thinsys::io::truncate(mapping_fd, 2 * pixel_size);
-
-  shmem_ = thinsys::io::mmap_mut(mapping_fd, 0, 2 * pixel_size, thinsys::io::map_sharing::sahre);
-  spool_ = wl::unique_ptr<wl_shm_pool>{wl_shm_create_pool(&shm, mapping_fd.native_handle(), 2 * pixel_size)};
-  bufs_ = {
-      wl::unique_ptr<wl_buffer>{wl_shm_pool_create_buffer(
-          spool_.get(), 0, sz.width, sz.height, 4 * sz.width, WL_SHM_FORMAT_ARGB8888
-      )},
-      wl::unique_ptr<wl_buffer>{wl_shm_pool_create_buffer(
-          spool_.get(), pixel_size, sz.width, sz.height, 4 * sz.width, WL_SHM_FORMAT_ARGB8888
-      )}
+  // Buffers of the old pool still used by the compositor are destroyed once
+  // released, their memory is never written again.
+  for (auto& buf : bufs_) {
+    if (buf->busy)
+      retired_.push_back(std::move(buf));
+  }
+  bufs_.clear();
+  // Growing windows reallocate memory a few times only. Slots take whole
+  // pages of the pool so that buffers never share pages. Whether hugetlb
+  // pages are available is known only once the pool is allocated.
+  const auto page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+  slot_size_ = std::max(pixel_size, slot_size_ + slot_size_ / 2);
+  slot_size_ = (slot_size_ + page_size - 1) / page_size * page_size;
+  shmem_ = shm_memory{2 * slot_size_, opts_.hugetlb};
+  if (shmem_.hugetlb()) {
+    constexpr size_t huge_page_size = shm_memory::huge_page_size;
+    slot_size_ = (slot_size_ + huge_page_size - 1) / huge_page_size * huge_page_size;
+    shmem_.grow(2 * slot_size_);
+  }
+  // Buffers inherit the queue from the pool
+  auto* shm = static_cast<wl_shm*>(wl_proxy_create_wrapper(shm_));
+  wl_proxy_set_queue(reinterpret_cast<wl_proxy*>(shm), queue_.get());
+  spool_ = wl::unique_ptr<wl_shm_pool>{
+      wl_shm_create_pool(shm, shmem_.native_handle(), static_cast<int32_t>(shmem_.size()))
   };
+  wl_proxy_wrapper_destroy(shm);
+}
+
+void framebuf::damage(const rect& r) {
+  damage_.add(intersection(r, rect{.width = sz_.width, .height = sz_.height}));
 }
 
 void framebuf::swap(wl_surface& surf) {
-  wl_surface_attach(&surf, bufs_[cur_].get(), 0, 0);
+  auto& buf = *bufs_[acquire()];
+  if (damage_.empty())
+    damage_.add(rect{.width = sz_.width, .height = sz_.height});
+  sync(buf);
+  damage_.simplify(max_damage_rects);
+
+  buf.busy = true;
+  buf.frame = ++frame_;
+  wl_surface_attach(&surf, buf.handle.get(), 0, 0);
+  const bool buffer_damage =
+      wl_proxy_get_version(reinterpret_cast<wl_proxy*>(&surf)) >= WL_SURFACE_DAMAGE_BUFFER_SINCE_VERSION;
+  for (const rect& r : damage_.rects()) {
+    // Surface coordinates match buffer ones since neither scale nor
+    // transform is ever set
+    if (buffer_damage)
+      wl_surface_damage_buffer(&surf, r.x, r.y, r.width, r.height);
+    else
+      wl_surface_damage(&surf, r.x, r.y, r.width, r.height);
+  }
   wl_surface_commit(&surf);
-  cur_ = (cur_ + 1) % 2;
+
+  std::swap(history_[frame_ % max_buffers], damage_);
+  damage_.clear();
+  last_attached_ = std::exchange(cur_, no_front);
+}
+
+std::span<std::byte> framebuf::front() {
+  const auto& buf = *bufs_[acquire()];
+  return shmem_.bytes().subspan(buf.offset, 4 * sz_.width * sz_.height);
 }
 
-std::span<std::byte> framebuf::front() const noexcept {
-  auto res = std::span{shmem_};
-  return res.subspan(cur_ * res.size() / 2, res.size() / 2);
+size_t framebuf::front_index() { return acquire(); }
+
+size_t framebuf::acquire() {
+  if (cur_ != no_front)
+    return cur_;
+
+  const auto is_free = [](const auto& buf) { return !buf->busy; };
+  dispatch_releases(false);
+  auto it = std::ranges::find_if(bufs_, is_free);
+  if (it == bufs_.end() && bufs_.size() < max_buffers) {
+    add_buffer();
+    it = bufs_.end() - 1;
+  }
+  // Compositor holds all the buffers
+  while (it == bufs_.end()) {
+    dispatch_releases(true);
+    it = std::ranges::find_if(bufs_, is_free);
+  }
+  cur_ = it - bufs_.begin();
+
+  if (auto& buf = *bufs_[cur_]; buf.stale)
+    create_handle(buf);
+  return cur_;
+}
+
+// Releases may be read from the socket by any thread, so they are either
+// dispatched if already queued or waited for with a blocking dispatch which
+// flushes committed frames first.
+void framebuf::dispatch_releases(bool wait) {
+  const int res = wait ? wl_display_dispatch_queue(display_, queue_.get())
+                       : wl_display_dispatch_queue_pending(display_, queue_.get());
+  if (res < 0)
+    throw std::system_error{errno, std::system_category(), "wl_display_dispatch_queue"};
+  std::erase_if(retired_, [](const auto& buf) { return !buf->busy; });
+}
+
+void framebuf::add_buffer() {
+  const size_t offset = bufs_.size() * slot_size_;
+  if (const size_t pool_size = offset + slot_size_; pool_size > shmem_.size()) {
+    shmem_.grow(pool_size);
+    wl_shm_pool_resize(spool_.get(), static_cast<int32_t>(shmem_.size()));
+  }
+  bufs_.push_back(std::make_unique<buffer>());
+  bufs_.back()->offset = offset;
+}
+
+void framebuf::create_handle(buffer& buf) {
+  static constexpr wl_buffer_listener listener{.release = [](void* data, wl_buffer*) {
+    static_cast<buffer*>(data)->busy = false;
+  }};
+  buf.handle.reset(wl_shm_pool_create_buffer(
+      spool_.get(), static_cast<int32_t>(buf.offset), sz_.width, sz_.height, 4 * sz_.width,
+      WL_SHM_FORMAT_ARGB8888
+  ));
+  wl_buffer_add_listener(buf.handle.get(), &listener, &buf);
+  buf.busy = false;
+  buf.stale = false;
+}
+
+// Copies pixels changed since the frame held by the buffer from the last
+// attached one except for those redrawn for the current frame.
+void framebuf::sync(buffer& buf) {
+  if (frame_ == 0 || buf.frame == frame_)
+    return;
+
+  damage_region outdated;
+  if (buf.frame == 0 || frame_ - buf.frame > max_buffers) {
+    outdated.add(rect{.width = sz_.width, .height = sz_.height});
+  } else {
+    for (uint64_t frame = buf.frame + 1; frame <= frame_; ++frame)
+      outdated.add(history_[frame % max_buffers]);
+  }
+  for (const rect& r : damage_.rects())
+    outdated.subtract(r);
+
+  const size_t stride = 4 * sz_.width;
+  const std::byte* src = shmem_.bytes().data() + bufs_[last_attached_]->offset;
+  std::byte* dest = shmem_.bytes().data() + buf.offset;
+  for (const rect& r : outdated.rects()) {
+    for (int32_t y = r.y; y < r.y + r.height; ++y) {
+      const size_t pos = y * stride + 4 * r.x;
+      std::memcpy(dest + pos, src + pos, 4 * r.width);
+    }
+  }
 }
 
 } // namespace wl
@@ -1,26 +1,108 @@
 #pragma once
 
+#include "shm_memory.hpp"
 #include "wlutil.hpp"
 
-#include <thinsys/io/mmap.hpp>
-
+#include <array>
+#include <limits>
 #include <span>
+#include <vector>
+
+#include <libs/geom/damage.hpp>
 
 namespace wl {
 
+struct framebuf_options {
+  /// Back large buffers with hugetlb pages if the system has them reserved.
+  bool hugetlb = false;
+};
+
+/// Pool of shared memory buffers for software rendering. Buffers are tracked
+/// with wl_buffer.release so that a buffer still read by the compositor is
+/// never drawn into nor destroyed. More buffers are added when all of them
+/// are busy and once there are `max_buffers` of them the front buffer is
+/// waited for. Release events are delivered to a queue of the framebuf own
+/// which is dispatched by its methods.
+///
+/// Only rectangles reported with `damage` are sent to the compositor. Every
+/// buffer remembers the frame it holds and on swap gets the regions changed
+/// since then copied from the previously attached one, so renderers redraw
+/// just their dirty rectangles.
+///
+/// Shared memory is prefaulted on allocation and grown geometrically, so
+/// neither the first frames after a resize take page faults nor a window
+/// resized interactively reallocates it every frame.
 class framebuf {
 public:
+  /// Limit after which the front buffer waits for the compositor to release
+  /// one of them.
+  static constexpr size_t max_buffers = 4;
+  /// Damage of a frame consisting of more rectangles is reduced to their
+  /// bounding box.
+  static constexpr size_t max_damage_rects = 16;
+
   framebuf() noexcept = default;
-  framebuf(wl_shm& shm, size sz);
+  framebuf(wl_shm& shm, wl_display& display, ::size sz) : framebuf(shm, display, sz, {}) {}
+  framebuf(wl_shm& shm, wl_display& display, ::size sz, framebuf_options opts);
+
+  framebuf(const framebuf&) = delete;
+  framebuf& operator=(const framebuf&) = delete;
+
+  framebuf(framebuf&&) noexcept;
+  framebuf& operator=(framebuf&&) noexcept;
 
+  ~framebuf() noexcept;
+
+  /// Buffers of the new size are created lazily. Those still used by the
+  /// compositor keep their memory untouched and are destroyed once released.
+  /// Shared memory is reallocated only if the new buffers do not fit into it,
+  /// so shrinking windows keep using the memory allocated before.
+  void resize(::size sz);
+
+  /// Marks the part of the front buffer redrawn for the next frame. Pixels of
+  /// the rectangle must be repainted entirely since the buffer may hold an
+  /// older frame there. Whole buffer is damaged if nothing is reported.
+  void damage(const rect& r);
+
+  /// Attaches the front buffer to the surface and commits it. The buffer is
+  /// busy until released and the next front one is picked among free ones.
   void swap(wl_surface& surf);
-  std::span<std::byte> front() const noexcept;
+  std::span<std::byte> front();
+  /// Index of the front buffer below `max_buffers` which lets callers track
+  /// what each buffer holds and skip redrawing unchanged content.
+  size_t front_index();
+  ::size size() const noexcept { return sz_; }
 
 private:
-  std::unique_ptr<std::byte[], thinsys::io::auto_unmaper> shmem_;
+  struct buffer;
+
+  size_t acquire();
+  void dispatch_releases(bool wait);
+  void add_buffer();
+  void create_handle(buffer& buf);
+  void sync(buffer& buf);
+
+private:
+  static constexpr size_t no_front = std::numeric_limits<size_t>::max();
+
+  wl_shm* shm_ = nullptr;
+  wl_display* display_ = nullptr;
+  framebuf_options opts_;
+  wl::unique_ptr<wl_event_queue> queue_;
+  shm_memory shmem_;
   wl::unique_ptr<wl_shm_pool> spool_;
-  std::array<wl::unique_ptr<wl_buffer>, 2> bufs_;
-  size_t cur_ = 0;
+  std::vector<std::unique_ptr<buffer>> bufs_;
+  // Buffers of the previous pool still used by the compositor
+  std::vector<std::unique_ptr<buffer>> retired_;
+  ::size sz_;
+  size_t slot_size_ = 0;
+  size_t cur_ = no_front;
+  size_t last_attached_ = 0;
+  // Frames are counted from 1 after each resize, 0 means undefined content.
+  // Damage of the last max_buffers frames is indexed by frame number.
+  uint64_t frame_ = 0;
+  damage_region damage_;
+  std::array<damage_region, max_buffers> history_;
 };
 
 } // namespace wl
@@ -0,0 +1,147 @@
+#include "framebuf.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <optional>
+#include <set>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <testing/compositor/session.hpp>
+
+using namespace std::literals;
+
+namespace {
+
+constexpr size window_size{.width = 32, .height = 16};
+
+bool filled_with(std::span<const std::byte> pixels, std::byte val) {
+  return std::ranges::all_of(pixels, [val](std::byte b) { return b == val; });
+}
+
+} // namespace
+
+SCENARIO("Software rendered frames presentation") {
+  GIVEN("shm framebuffer of a window shown by the test compositor") {
+    test_session session{{.refresh_period = 2ms}};
+    auto wnd = session.create_window(window_size);
+    wl_surface& surf = wnd.window.get_surface();
+    event_queue queue = session.eloop.make_queue();
+    wl::framebuf fb{*session.shell.get_shm(), session.eloop.get_display(), wnd.sz};
+
+    std::ranges::fill(fb.front(), std::byte{0x11});
+    fb.swap(surf);
+    session.roundtrip(queue);
+
+    WHEN("the first frame is committed") {
+      REQUIRE(session.compositor.wait_commits(1, 1s));
+      const auto frame = session.compositor.commits().back();
+
+      THEN("compositor gets whole buffer contents damaged") {
+        CHECK(frame.size == window_size);
+        CHECK(frame.stride == 4 * window_size.width);
+        CHECK(filled_with(frame.pixels, std::byte{0x11}));
+        CHECK(frame.damage == std::vector<rect>{{.x = 0, .y = 0, .width = 32, .height = 16}});
+      }
+    }
+
+    WHEN("only a rectangle is redrawn in the next frame") {
+      constexpr rect dirty{.x = 4, .y = 2, .width = 8, .height = 8};
+      auto pixels = fb.front();
+      for (int32_t y = dirty.y; y < dirty.y + dirty.height; ++y) {
+        const auto row = pixels.subspan(4 * (y * window_size.width + dirty.x), 4 * dirty.width);
+        std::ranges::fill(row, std::byte{0x22});
+      }
+      fb.damage(dirty);
+      fb.swap(surf);
+      session.roundtrip(queue);
+      REQUIRE(session.compositor.wait_commits(2, 1s));
+      const auto frame = session.compositor.commits().back();
+
+      THEN("just that rectangle is damaged and the rest is kept from the previous frame") {
+        CHECK(frame.damage == std::vector<rect>{dirty});
+        for (int32_t y = 0; y < window_size.height; ++y) {
+          for (int32_t x = 0; x < window_size.width; ++x) {
+            const bool inside =
+                x >= dirty.x && x < dirty.x + dirty.width && y >= dirty.y && y < dirty.y + dirty.height;
+            const auto px = std::span{frame.pixels}.subspan(y * frame.stride + 4 * x, 4);
+            CHECK(filled_with(px, inside ? std::byte{0x22} : std::byte{0x11}));
+          }
+        }
+      }
+    }
+
+    WHEN("frames are committed on frame callbacks") {
+      std::vector<uint32_t> vblanks;
+      for (size_t i = 0; i < 4; ++i) {
+        wl::unique_ptr<wl_callback> cb{wl_surface_frame(&surf)};
+        wl_proxy_set_queue(reinterpret_cast<wl_proxy*>(cb.get()), &queue.get());
+        std::optional<uint32_t> done;
+        const wl_callback_listener listener = {.done = [](void* data, wl_callback*, uint32_t ms) {
+          *static_cast<std::optional<uint32_t>*>(data) = ms;
+        }};
+        wl_callback_add_listener(cb.get(), &listener, &done);
+        fb.swap(surf);
+        while (!done)
+          wl_display_dispatch_queue(&session.eloop.get_display(), &queue.get());
+        vblanks.push_back(done.value());
+      }
+      const auto frames = session.compositor.commits();
+      REQUIRE(frames.size() == 1 + vblanks.size());
+
+      THEN("callbacks are fired on the virtual output refreshes") {
+        for (size_t i = 1; i < vblanks.size(); ++i) {
+          const auto interval = static_cast<int32_t>(vblanks[i] - vblanks[i - 1]);
+          CHECK(interval > 0);
+          CHECK(interval % 2 == 0);
+        }
+      }
+
+      THEN("each frame is committed after the refresh of the previous one") {
+        for (size_t i = 0; i + 1 < vblanks.size(); ++i) {
+          const auto commit_ms = static_cast<uint32_t>(
+              std::chrono::duration_cast<std::chrono::milliseconds>(frames[i + 2].time.time_since_epoch())
+                  .count()
+          );
+          CHECK(static_cast<int32_t>(commit_ms - vblanks[i]) >= 0);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("Software rendered frames presentation with buffers held by the compositor") {
+  GIVEN("shm framebuffer of a window shown by the compositor holding buffers for a few refreshes") {
+    test_session session{{.refresh_period = 5ms, .hold_refreshes = 3}};
+    auto wnd = session.create_window(window_size);
+    wl_surface& surf = wnd.window.get_surface();
+    event_queue queue = session.eloop.make_queue();
+    wl::framebuf fb{*session.shell.get_shm(), session.eloop.get_display(), wnd.sz};
+
+    WHEN("frames are committed faster than buffers are released") {
+      constexpr size_t count = 3 * wl::framebuf::max_buffers;
+      std::set<size_t> used;
+      for (size_t i = 0; i < count; ++i) {
+        used.insert(fb.front_index());
+        std::ranges::fill(fb.front(), static_cast<std::byte>(i));
+        fb.swap(surf);
+      }
+      session.roundtrip(queue);
+      REQUIRE(session.compositor.wait_commits(count, 1s));
+      const auto frames = session.compositor.commits();
+
+      THEN("buffers are added up to the limit") {
+        CHECK(used.size() == wl::framebuf::max_buffers);
+        CHECK(*used.rbegin() < wl::framebuf::max_buffers);
+      }
+
+      THEN("no buffer is attached again before it is released") {
+        for (size_t i = 0; i < count; ++i) {
+          CHECK(!frames[i].held_buffer_attached);
+          CHECK(filled_with(frames[i].pixels, static_cast<std::byte>(i)));
+        }
+      }
+    }
+  }
+}
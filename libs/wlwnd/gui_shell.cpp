@@ -25,6 +25,12 @@ gui_shell::gui_shell(event_loop& eloop) : xdg_listener_{.ping = &xdg_ping} {
   if (xdg_wm_.service)
     xdg_wm_base_add_listener(xdg_wm_.service.get(), &xdg_listener_, nullptr);
 
+  // Clock is announced right after binding and is needed before any frame
+  if (presentation_.service) {
+    wp_presentation_add_listener(presentation_.service.get(), &presentation_listener_, this);
+    wl_display_roundtrip(&eloop.get_display());
+  }
+
   if (const auto ec = check())
     throw std::system_error{ec, "gui_shell::gui_shell"};
 }
@@ -61,7 +67,13 @@ gui_shell::create_maximized_window(event_loop& eloop, asio::io_context::executor
   if (szdelegate.closed)
     throw std::system_error{ui_errc::window_closed, "create_maximized_window"};
 
-  co_return sized_window<shell_window>{.window = std::move(wnd), .sz = szdelegate.wnd_size.value()};
+  co_return sized_window<shell_window>{
+      .window = std::move(wnd),
+      .sz = szdelegate.wnd_size.value(),
+      .presentation = get_presentation(),
+      .viewporter = get_viewporter(),
+      .fractional_scale = get_fractional_scale()
+  };
 }
 
 sized_window<shell_window> gui_shell::create_window(event_loop& eloop, size sz) {
@@ -73,7 +85,13 @@ sized_window<shell_window> gui_shell::create_window(event_loop& eloop, size sz)
     wnd = shell_window{std::move(xdg_wnd)};
   }
 
-  return sized_window<shell_window>{.window = std::move(wnd), .sz = sz};
+  return sized_window<shell_window>{
+      .window = std::move(wnd),
+      .sz = sz,
+      .presentation = get_presentation(),
+      .viewporter = get_viewporter(),
+      .fractional_scale = get_fractional_scale()
+  };
 }
 
 void gui_shell::global(void* data, wl_registry* reg, uint32_t id, const char* name, uint32_t ver) {
@@ -86,6 +104,12 @@ void gui_shell::global(void* data, wl_registry* reg, uint32_t id, const char* na
     self->ivi_ = {wl::bind<ivi_application>(reg, id, ver), id};
   if (name == wl::service_trait<xdg_wm_base>::name)
     self->xdg_wm_ = {wl::bind<xdg_wm_base>(reg, id, ver), id};
+  if (name == wl::service_trait<wp_presentation>::name)
+    self->presentation_ = {wl::bind<wp_presentation>(reg, id, 1), id};
+  if (name == wl::service_trait<wp_viewporter>::name)
+    self->viewporter_ = {wl::bind<wp_viewporter>(reg, id, 1), id};
+  if (name == wl::service_trait<wp_fractional_scale_manager_v1>::name)
+    self->fractional_scale_ = {wl::bind<wp_fractional_scale_manager_v1>(reg, id, 1), id};
 }
 
 void gui_shell::global_remove(void* data, wl_registry*, uint32_t id) {
@@ -98,6 +122,17 @@ void gui_shell::global_remove(void* data, wl_registry*, uint32_t id) {
     self->ivi_ = {{}, {}};
   if (id == self->xdg_wm_.id)
     self->xdg_wm_ = {{}, {}};
+  if (id == self->presentation_.id)
+    self->presentation_ = {{}, {}};
+  if (id == self->viewporter_.id)
+    self->viewporter_ = {{}, {}};
+  if (id == self->fractional_scale_.id)
+    self->fractional_scale_ = {{}, {}};
+}
+
+void gui_shell::presentation_clock(void* data, wp_presentation*, uint32_t clock) {
+  gui_shell* self = reinterpret_cast<gui_shell*>(data);
+  self->presentation_clock_ = static_cast<clockid_t>(clock);
 }
 
 static_assert(window<xdg::toplevel_window>);
@@ -23,6 +23,13 @@ public:
   [[nodiscard]] wl_shm* get_shm() const noexcept { return shm_.service.get(); }
   [[nodiscard]] ivi_application* get_ivi() const noexcept { return ivi_.service.get(); }
   [[nodiscard]] xdg_wm_base* get_xdg_wm() const noexcept { return xdg_wm_.service.get(); }
+  [[nodiscard]] presentation_service get_presentation() const noexcept {
+    return {.presentation = presentation_.service.get(), .clock = presentation_clock_};
+  }
+  [[nodiscard]] wp_viewporter* get_viewporter() const noexcept { return viewporter_.service.get(); }
+  [[nodiscard]] wp_fractional_scale_manager_v1* get_fractional_scale() const noexcept {
+    return fractional_scale_.service.get();
+  }
 
   std::error_code check() noexcept;
 
@@ -34,6 +41,7 @@ public:
 private:
   static void global(void* data, wl_registry* reg, uint32_t id, const char* name, uint32_t ver);
   static void global_remove(void* data, wl_registry*, uint32_t id);
+  static void presentation_clock(void* data, wp_presentation*, uint32_t clock);
 
 private:
   wl::unique_ptr<wl_registry> registry_;
@@ -43,6 +51,11 @@ private:
   identified<ivi_application> ivi_;
   identified<xdg_wm_base> xdg_wm_;
   xdg_wm_base_listener xdg_listener_;
+  identified<wp_presentation> presentation_;
+  wp_presentation_listener presentation_listener_ = {&presentation_clock};
+  clockid_t presentation_clock_ = CLOCK_MONOTONIC;
+  identified<wp_viewporter> viewporter_;
+  identified<wp_fractional_scale_manager_v1> fractional_scale_;
 };
 
 } // namespace wl
@@ -0,0 +1,92 @@
+#include <algorithm>
+
+#include <libs/wlwnd/presentation.hpp>
+
+namespace wl {
+
+namespace {
+
+frames_clock::time_point make_time_point(uint64_t sec, uint32_t nsec) noexcept {
+  return frames_clock::time_point{std::chrono::seconds{sec} + std::chrono::nanoseconds{nsec}};
+}
+
+} // namespace
+
+struct presentation_feedback::feedback {
+  presentation_feedback* owner;
+  wl::unique_ptr<struct wp_presentation_feedback> proxy;
+  frames_clock::time_point target{};
+  bool done = false;
+
+  static void sync_output(void*, struct wp_presentation_feedback*, wl_output*) {}
+
+  static void presented(
+      void* data, struct wp_presentation_feedback*, uint32_t tv_sec_hi, uint32_t tv_sec_lo, uint32_t tv_nsec,
+      uint32_t refresh, uint32_t seq_hi, uint32_t seq_lo, uint32_t flags
+  ) {
+    auto* self = reinterpret_cast<feedback*>(data);
+    self->done = true;
+    const frame_presentation frame{
+        .time = make_time_point((uint64_t{tv_sec_hi} << 32) | tv_sec_lo, tv_nsec),
+        .refresh = std::chrono::nanoseconds{refresh},
+        .sequence = (uint64_t{seq_hi} << 32) | seq_lo,
+        .flags = flags,
+        .target = self->target
+    };
+    self->owner->presented_.push_back(frame);
+    auto& last = self->owner->last_presented_;
+    if (!last || last->time <= frame.time)
+      last = frame;
+  }
+
+  static void discarded(void* data, struct wp_presentation_feedback*) {
+    reinterpret_cast<feedback*>(data)->done = true;
+  }
+
+  static constexpr wp_presentation_feedback_listener listener = {
+      .sync_output = &sync_output, .presented = &presented, .discarded = &discarded
+  };
+};
+
+presentation_feedback::presentation_feedback(
+    wl_event_queue& queue, presentation_service presentation
+) noexcept
+    : queue_{queue}, presentation_{presentation} {}
+
+presentation_feedback::~presentation_feedback() noexcept = default;
+
+void presentation_feedback::request(wl_surface& surf) {
+  if (!presentation_.presentation)
+    return;
+  std::erase_if(feedbacks_, [](const auto& fb) { return fb->done; });
+
+  // Feedback events are to be dispatched by the thread drawing the frames
+  auto* presentation = static_cast<wp_presentation*>(wl_proxy_create_wrapper(presentation_.presentation));
+  wl_proxy_set_queue(reinterpret_cast<wl_proxy*>(presentation), &queue_);
+  auto& fb = feedbacks_.emplace_back(std::make_unique<feedback>(this));
+  fb->proxy.reset(wp_presentation_feedback(presentation, &surf));
+  wl_proxy_wrapper_destroy(presentation);
+  wp_presentation_feedback_add_listener(fb->proxy.get(), &feedback::listener, fb.get());
+}
+
+void presentation_feedback::frame_drawn(frames_clock::time_point target) noexcept {
+  if (!feedbacks_.empty() && !feedbacks_.back()->done)
+    feedbacks_.back()->target = target;
+}
+
+frames_clock::time_point presentation_feedback::frame_time(uint32_t callback_ms) const noexcept {
+  if (!presentation_.presentation)
+    return frames_clock::time_point{std::chrono::milliseconds{callback_ms}};
+
+  timespec ts;
+  clock_gettime(presentation_.clock, &ts);
+  const auto now = make_time_point(ts.tv_sec, ts.tv_nsec);
+  if (!last_presented_ || last_presented_->refresh <= frames_clock::duration::zero())
+    return now;
+  // Outputs with fixed refresh rate show frames on the retrace grid only
+  const auto& last = last_presented_.value();
+  const auto retraces = std::max(now - last.time, frames_clock::duration::zero()) / last.refresh + 1;
+  return last.time + retraces * last.refresh;
+}
+
+} // namespace wl
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <libs/anime/clock.hpp>
+
+#include <libs/wlwnd/wlutil.hpp>
+
+namespace wl {
+
+/// wp_presentation global along with the clock its timestamps are taken from.
+struct presentation_service {
+  wp_presentation* presentation = nullptr;
+  clockid_t clock = CLOCK_MONOTONIC;
+};
+
+/// Feedback on a frame shown on the screen by the compositor.
+struct frame_presentation {
+  frames_clock::time_point time;
+  /// Zero if the output refresh rate is variable or unknown.
+  std::chrono::nanoseconds refresh{};
+  /// Vertical retrace counter of the output. Zero if the output has none.
+  uint64_t sequence = 0;
+  /// Bitmask of wp_presentation_feedback_kind values.
+  uint32_t flags = 0;
+  /// Time the frame was drawn for or the epoch if it is unknown.
+  frames_clock::time_point target{};
+};
+
+/// Tracks presentation of frames committed to a surface.
+///
+/// With wp_presentation frame times are in its clock with nanosecond
+/// precision and point to the vertical retrace the frame drawn now is going
+/// to be shown on at the earliest. Otherwise millisecond timestamps of frame
+/// callbacks are used as is.
+class presentation_feedback {
+public:
+  presentation_feedback(wl_event_queue& queue, presentation_service presentation) noexcept;
+
+  presentation_feedback(const presentation_feedback&) = delete;
+  presentation_feedback& operator=(const presentation_feedback&) = delete;
+
+  ~presentation_feedback() noexcept;
+
+  /// Requests feedback on the next commit of the `surf`. Events are
+  /// dispatched with the queue passed to the constructor.
+  void request(wl_surface& surf);
+  /// Remembers that the frame to be committed with the latest requested
+  /// feedback is drawn for the `target` time.
+  void frame_drawn(frames_clock::time_point target) noexcept;
+
+  /// Frames shown on the screen since the previous call in the order their
+  /// feedback was received.
+  std::vector<frame_presentation> take_presented() noexcept { return std::exchange(presented_, {}); }
+
+  /// The latest frame shown on the screen. Empty until the first feedback is
+  /// received or if the compositor does not support wp_presentation.
+  const std::optional<frame_presentation>& last_presented() const noexcept { return last_presented_; }
+  /// Refresh period of the output the latest frame was shown on or zero if
+  /// it is unknown.
+  std::chrono::nanoseconds refresh() const noexcept {
+    return last_presented_ ? last_presented_->refresh : std::chrono::nanoseconds::zero();
+  }
+
+  /// Time of the frame to be drawn after the frame callback with the
+  /// `callback_ms` timestamp.
+  frames_clock::time_point frame_time(uint32_t callback_ms) const noexcept;
+
+private:
+  struct feedback;
+
+private:
+  wl_event_queue& queue_;
+  presentation_service presentation_;
+  // Feedback is requested for every commit and kept until the compositor
+  // reports that the frame was either presented or discarded.
+  std::vector<std::unique_ptr<feedback>> feedbacks_;
+  std::optional<frame_presentation> last_presented_;
+  std::vector<frame_presentation> presented_;
+};
+
+} // namespace wl
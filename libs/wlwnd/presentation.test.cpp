@@ -0,0 +1,99 @@
+#include "presentation.hpp"
+
+#include <chrono>
+#include <ctime>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <testing/compositor/session.hpp>
+
+#include <libs/wlwnd/framebuf.hpp>
+
+using namespace std::literals;
+
+namespace {
+
+constexpr auto refresh = 4ms;
+
+frames_clock::time_point monotonic_now() noexcept {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return frames_clock::time_point{std::chrono::seconds{ts.tv_sec} + std::chrono::nanoseconds{ts.tv_nsec}};
+}
+
+} // namespace
+
+SCENARIO("Presentation feedback of committed frames") {
+  GIVEN("window shown by the test compositor with wp_presentation") {
+    test_session session{{.refresh_period = refresh, .record_pixels = false}};
+    auto wnd = session.create_window({.width = 16, .height = 16});
+    wl_surface& surf = wnd.window.get_surface();
+    event_queue queue = session.eloop.make_queue();
+    wl::framebuf fb{*session.shell.get_shm(), session.eloop.get_display(), wnd.sz};
+    wl::presentation_feedback feedback{queue.get(), session.shell.get_presentation()};
+    REQUIRE(session.shell.get_presentation().presentation != nullptr);
+
+    THEN("nothing is presented before the first commit") {
+      CHECK(!feedback.last_presented());
+      CHECK(feedback.refresh() == 0ns);
+      CHECK(feedback.take_presented().empty());
+    }
+
+    WHEN("frames are committed one after another") {
+      std::vector<wl::frame_presentation> presented;
+      for (size_t i = 0; i < 4; ++i) {
+        feedback.request(surf);
+        feedback.frame_drawn(feedback.frame_time(0));
+        fb.swap(surf);
+        auto frames = feedback.take_presented();
+        while (frames.empty()) {
+          wl_display_dispatch_queue(&session.eloop.get_display(), &queue.get());
+          frames = feedback.take_presented();
+        }
+        presented.insert(presented.end(), frames.begin(), frames.end());
+      }
+      REQUIRE(presented.size() == 4);
+
+      THEN("each of them is presented on a virtual output refresh") {
+        for (size_t i = 0; i < presented.size(); ++i) {
+          INFO("frame: " << i);
+          CHECK(presented[i].refresh == refresh);
+          CHECK((presented[i].flags & WP_PRESENTATION_FEEDBACK_KIND_VSYNC) != 0);
+          CHECK(presented[i].sequence > 0);
+          CHECK(presented[i].sequence <= session.compositor.refreshes());
+          CHECK(presented[i].time >= presented[i].target);
+        }
+        for (size_t i = 1; i < presented.size(); ++i) {
+          INFO("frame: " << i);
+          REQUIRE(presented[i].sequence > presented[i - 1].sequence);
+          const auto retraces = static_cast<int64_t>(presented[i].sequence - presented[i - 1].sequence);
+          CHECK(presented[i].time - presented[i - 1].time == retraces * refresh);
+        }
+      }
+
+      THEN("the latest of them is remembered") {
+        REQUIRE(feedback.last_presented());
+        CHECK(feedback.last_presented()->sequence == presented.back().sequence);
+        CHECK(feedback.last_presented()->time == presented.back().time);
+        CHECK(feedback.refresh() == refresh);
+      }
+
+      THEN("frames drawn after the first presentation target retraces") {
+        for (size_t i = 1; i < presented.size(); ++i) {
+          INFO("frame: " << i);
+          CHECK((presented[i].target - presented[0].time) % refresh == 0ns);
+        }
+      }
+
+      THEN("the next frame is planned for a retrace after the latest presented one") {
+        const auto now = monotonic_now();
+        const auto frame_time = feedback.frame_time(0);
+        const auto& last = feedback.last_presented().value();
+        CHECK(frame_time > last.time);
+        CHECK(frame_time > now);
+        CHECK((frame_time - last.time) % refresh == 0ns);
+      }
+    }
+  }
+}
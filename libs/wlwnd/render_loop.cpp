@@ -0,0 +1,256 @@
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <exception>
+#include <optional>
+#include <stop_token>
+#include <utility>
+
+#include <spdlog/spdlog.h>
+
+#include <libs/wlwnd/frame_scheduler.hpp>
+#include <libs/wlwnd/presentation.hpp>
+#include <libs/wlwnd/render_loop.hpp>
+#include <libs/wlwnd/resolution_governor.hpp>
+
+namespace {
+
+uint32_t monotonic_ms() noexcept {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint32_t>(ts.tv_sec * 1000 + ts.tv_nsec / 1'000'000);
+}
+
+// wp_fractional_scale_v1 reports scale multiplied by this denominator
+constexpr uint32_t fractional_scale_denominator = 120;
+
+int32_t scale_length(int32_t len, double scale) noexcept {
+  return std::max<int32_t>(1, static_cast<int32_t>(std::lround(len * scale)));
+}
+
+} // namespace
+
+// Render thread part of the window state
+struct render_loop::window {
+  using clock = frame_scheduler::clock;
+
+  window(
+      std::shared_ptr<animation_window::state> st, event_queue& queue, resolution_governor_options opts
+  )
+      : state{std::move(st)}, feedback{queue.get(), state->presentation}, governor{opts},
+        window_size{state->resize_channel.get_current()} {
+    // Buffers are scaled to the window size by the compositor only with
+    // the viewport which is also required for the fractional scale
+    if (!state->viewporter)
+      return;
+    viewport.reset(wp_viewporter_get_viewport(state->viewporter, &state->surface));
+    if (state->fractional_scale) {
+      auto* manager = static_cast<wp_fractional_scale_manager_v1*>(
+          wl_proxy_create_wrapper(state->fractional_scale)
+      );
+      wl_proxy_set_queue(reinterpret_cast<wl_proxy*>(manager), &queue.get());
+      fractional_scale.reset(wp_fractional_scale_manager_v1_get_fractional_scale(manager, &state->surface));
+      wl_proxy_wrapper_destroy(manager);
+      wp_fractional_scale_v1_add_listener(fractional_scale.get(), &fractional_scale_listener, this);
+    }
+    update_size();
+  }
+
+  window(const window&) = delete;
+  window& operator=(const window&) = delete;
+
+  ~window() noexcept {
+    spdlog::debug("Rendering finished, {} frames missed their deadline", scheduler.missed_deadlines());
+    renderer.reset();
+    frame_cb.reset();
+    fractional_scale.reset();
+    viewport.reset();
+    state->released.count_down();
+  }
+
+  // Renderer failure closes its window only leaving the rest running
+  template <typename F>
+  void guarded(F&& f) noexcept {
+    try {
+      f();
+    } catch (const std::exception& err) {
+      spdlog::error("Window rendering failed: {}", err.what());
+      state->closed = true;
+    }
+  }
+
+  void start(event_queue& queue, render_resources& resources) {
+    guarded([&] {
+      renderer = state->animation(render_target{
+          .display = queue.display(),
+          .surface = state->surface,
+          .queue = queue.get(),
+          .size = buffer_size,
+          .resources = resources,
+          .presented = feedback.last_presented()
+      });
+      pending_size.reset();
+      start_time = clock::now();
+    });
+  }
+
+  void draw() {
+    start_time.reset();
+    // Requests are made once per commit, windows with unchanged content keep
+    // them pending until the next commit
+    if (!frame_cb) {
+      frame_cb.reset(wl_surface_frame(&state->surface));
+      wl_callback_add_listener(frame_cb.get(), &frame_listener, this);
+      feedback.request(state->surface);
+    }
+    const auto presented = feedback.take_presented();
+    guarded([&] {
+      if (pending_size)
+        renderer->resize(std::exchange(pending_size, std::nullopt).value());
+      const auto frame_time = feedback.frame_time(callback_ms);
+      feedback.frame_drawn(frame_time);
+      const auto started = clock::now();
+      scheduler.frame_started(started);
+      idle = !renderer->draw(frame_time);
+      const auto finished = clock::now();
+      scheduler.frame_finished(finished);
+      if (viewport && !idle) {
+        const float scale = governor.scale();
+        const auto refresh = scheduler.refresh_period();
+        governor.frame_finished(finished - started, refresh);
+        // GPU work is not included into the draw time but makes frames late
+        for (const auto& frame : presented) {
+          if (frame.target > scale_frame_time)
+            governor.frame_presented(frame.time - frame.target, refresh);
+        }
+        if (governor.scale() != scale) {
+          scale_frame_time = frame_time;
+          update_size();
+        }
+      }
+    });
+  }
+
+  void resize(size sz) {
+    window_size = sz;
+    update_size();
+  }
+
+  // Buffer size follows the window size scaled by the preferred scale and the
+  // resolution governor. The viewport stretches the buffer back to the window
+  // size, the new destination is applied with the next commit along with the
+  // buffer of the new size.
+  void update_size() {
+    size sz = window_size;
+    if (viewport && window_size.width > 0 && window_size.height > 0) {
+      const double scale = governor.scale() * preferred_scale / fractional_scale_denominator;
+      sz = {
+          .width = scale_length(window_size.width, scale), .height = scale_length(window_size.height, scale)
+      };
+      wp_viewport_set_destination(viewport.get(), window_size.width, window_size.height);
+    }
+    if (sz == buffer_size)
+      return;
+    buffer_size = sz;
+    pending_size = sz;
+    if (std::exchange(idle, false))
+      start_time = clock::now();
+  }
+
+  static void frame_done(void* data, wl_callback*, uint32_t ms) {
+    auto* self = static_cast<window*>(data);
+    self->frame_cb.reset();
+    self->callback_ms = ms;
+    self->start_time = self->scheduler.frame_callback(clock::now(), self->feedback.refresh());
+  }
+
+  static void preferred_scale_changed(void* data, wp_fractional_scale_v1*, uint32_t scale) {
+    auto* self = static_cast<window*>(data);
+    self->preferred_scale = scale;
+    self->update_size();
+  }
+
+  static constexpr wl_callback_listener frame_listener = {.done = &frame_done};
+  static constexpr wp_fractional_scale_v1_listener fractional_scale_listener = {
+      .preferred_scale = &preferred_scale_changed
+  };
+
+  std::shared_ptr<animation_window::state> state;
+  wl::presentation_feedback feedback;
+  frame_scheduler scheduler;
+  resolution_governor governor;
+  wl::unique_ptr<wp_viewport> viewport;
+  wl::unique_ptr<wp_fractional_scale_v1> fractional_scale;
+  uint32_t preferred_scale = fractional_scale_denominator;
+  // Time of the last frame drawn before the governor changed the scale
+  frames_clock::time_point scale_frame_time{};
+  size window_size;
+  size buffer_size = window_size;
+  std::unique_ptr<window_renderer> renderer;
+  wl::unique_ptr<wl_callback> frame_cb;
+  // Set when the next frame is due
+  std::optional<clock::time_point> start_time;
+  std::optional<size> pending_size;
+  uint32_t callback_ms = monotonic_ms();
+  bool idle = false;
+};
+
+render_loop::render_loop(event_loop& eloop, co::pool_executor exec, resolution_governor_options opts)
+    : queue_{eloop.make_queue()}, governor_opts_{opts},
+      render_task_guard_{exec, [this](std::stop_token stop) { run(std::move(stop)); }} {}
+
+render_loop::~render_loop() noexcept = default;
+
+animation_window
+render_loop::add_window(wl::sized_window<wl::shell_window>&& wnd, animation_function animation) {
+  wl_surface& surf = wnd.window.get_surface();
+  wl_proxy_set_queue(reinterpret_cast<wl_proxy*>(&surf), &queue_.get());
+  auto st = std::make_shared<animation_window::state>(queue_, wnd, std::move(animation));
+  animation_window res{std::move(wnd.window), st};
+  {
+    std::lock_guard lock{mutex_};
+    added_.push_back(std::move(st));
+  }
+  queue_.wake();
+  return res;
+}
+
+void render_loop::run(std::stop_token stop) {
+  std::stop_callback wake_queue_on_stop{stop, [this] { queue_.wake(); }};
+  // Renderers may use shared resources so they have to be destroyed first
+  render_resources resources;
+  std::vector<std::unique_ptr<window>> windows;
+  while (!stop.stop_requested()) {
+    {
+      std::lock_guard lock{mutex_};
+      for (auto& st : std::exchange(added_, {}))
+        windows.emplace_back(std::make_unique<window>(std::move(st), queue_, governor_opts_))
+            ->start(queue_, resources);
+    }
+    queue_.dispatch_pending();
+    std::erase_if(windows, [](const auto& wnd) { return wnd->state->detached || wnd->state->closed; });
+
+    const auto now = window::clock::now();
+    window* next = nullptr;
+    for (const auto& wnd : windows) {
+      if (auto sz = wnd->state->resize_channel.get_update())
+        wnd->resize(sz.value());
+      if (wnd->start_time && (!next || wnd->start_time < next->start_time))
+        next = wnd.get();
+    }
+
+    // Events coming while waiting for the next frame start may be frame
+    // callbacks or resizes of other windows due even earlier
+    if (!next)
+      queue_.dispatch();
+    else if (next->start_time > now)
+      queue_.dispatch_until(next->start_time.value());
+    else
+      next->draw();
+  }
+
+  windows.clear();
+  std::lock_guard lock{mutex_};
+  for (const auto& st : std::exchange(added_, {}))
+    st->released.count_down();
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <vector>
+
+#include <libs/corort/executors.hpp>
+#include <libs/sync/task_guard.hpp>
+
+#include <libs/wlwnd/animation_window.hpp>
+#include <libs/wlwnd/event_loop.hpp>
+#include <libs/wlwnd/renderer.hpp>
+#include <libs/wlwnd/resolution_governor.hpp>
+#include <libs/wlwnd/shell_window.hpp>
+
+/// Draws any number of windows on a single thread of the pool.
+///
+/// Every window has its own frame scheduler planning when to start drawing
+/// after the frame callback. The window whose frame is planned to start first
+/// is drawn next, so the number of threads busy with rendering does not grow
+/// with the number of windows. Renderers are created and destroyed on the
+/// render thread and may share GPU contexts and other heavy objects through
+/// `render_target::resources`.
+///
+/// If the compositor supports wp_viewporter windows are drawn at the scale
+/// preferred by the compositor and the resolution is reduced while frames do
+/// not fit into the refresh period. Buffers of any size are stretched to the
+/// window size by the compositor and renderers just get resized. Both the
+/// time spent in `window_renderer::draw` and, with wp_presentation, frames
+/// shown later than they were drawn for are taken into account, so GPU
+/// renderers returning right after submitting their work are scaled down too.
+///
+/// The loop must outlive all the windows added to it.
+class render_loop {
+public:
+  render_loop(event_loop& eloop, co::pool_executor exec) : render_loop(eloop, exec, {}) {}
+  render_loop(event_loop& eloop, co::pool_executor exec, resolution_governor_options opts);
+
+  render_loop(const render_loop&) = delete;
+  render_loop& operator=(const render_loop&) = delete;
+
+  ~render_loop() noexcept;
+
+  /// Starts drawing the window with the renderer made by the `animation`.
+  /// Window events are handled by the thread dispatching the event_loop.
+  animation_window add_window(wl::sized_window<wl::shell_window>&& wnd, animation_function animation);
+
+private:
+  struct window;
+
+  void run(std::stop_token stop);
+
+private:
+  event_queue queue_;
+  resolution_governor_options governor_opts_;
+  std::mutex mutex_;
+  std::vector<std::shared_ptr<animation_window::state>> added_;
+  // Stopped first so that the render thread is done before the rest is gone
+  task_guard render_task_guard_;
+};
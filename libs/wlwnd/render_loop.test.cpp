@@ -0,0 +1,142 @@
+#include "render_loop.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <thread>
+
+#include <asio/static_thread_pool.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <testing/compositor/session.hpp>
+
+#include <libs/wlwnd/framebuf.hpp>
+
+using namespace std::literals;
+
+namespace {
+
+constexpr size window_size{.width = 16, .height = 16};
+
+struct frames_counter {
+  std::atomic<size_t> count = 0;
+  std::atomic<std::thread::id> thread;
+  // Refresh counter of the latest presented frame seen by the renderer
+  std::atomic<uint64_t> presented_sequence = 0;
+  // Time spent on each frame to emulate heavy rendering
+  std::chrono::nanoseconds cost = 0ns;
+};
+
+class counting_renderer final : public window_renderer {
+public:
+  counting_renderer(const render_target& target, wl_shm& shm, frames_counter& counter)
+      : surf_{target.surface}, fb_{shm, target.display, target.size}, presented_{target.presented},
+        counter_{counter} {}
+
+  void resize(size sz) override { fb_.resize(sz); }
+  bool draw(frames_clock::time_point) override {
+    std::ranges::fill(fb_.front(), std::byte{0x33});
+    std::this_thread::sleep_for(counter_.cost);
+    fb_.swap(surf_);
+    counter_.thread = std::this_thread::get_id();
+    if (presented_)
+      counter_.presented_sequence = presented_->sequence;
+    ++counter_.count;
+    return true;
+  }
+
+private:
+  wl_surface& surf_;
+  wl::framebuf fb_;
+  const std::optional<wl::frame_presentation>& presented_;
+  frames_counter& counter_;
+};
+
+animation_window add_counting_window(render_loop& renderer, test_session& session, frames_counter& counter) {
+  wl_shm& shm = *session.shell.get_shm();
+  return renderer.add_window(
+      session.create_window(window_size),
+      [&shm, &counter](const render_target& target) {
+        return std::make_unique<counting_renderer>(target, shm, counter);
+      }
+  );
+}
+
+bool has_commit(const test_compositor& compositor, size buffer, size destination) {
+  return std::ranges::any_of(compositor.commits(), [&](const committed_frame& frame) {
+    return frame.size == buffer && frame.destination == destination;
+  });
+}
+
+} // namespace
+
+SCENARIO("Several windows drawn by a single render thread") {
+  GIVEN("two windows of the same render loop shown by the test compositor") {
+    test_session session{{.refresh_period = 2ms, .record_pixels = false}};
+    asio::static_thread_pool pool{1};
+    render_loop renderer{session.eloop, pool.get_executor()};
+    frames_counter first_frames;
+    frames_counter second_frames;
+    auto first = add_counting_window(renderer, session, first_frames);
+    auto second = add_counting_window(renderer, session, second_frames);
+
+    WHEN("the compositor refreshes the output for a while") {
+      session.dispatch_while([&] { return first_frames.count < 10 || second_frames.count < 10; });
+
+      THEN("frames of both windows are drawn on the same thread") {
+        CHECK(first_frames.thread.load() == second_frames.thread.load());
+        CHECK(session.compositor.commits_count() >= 20);
+      }
+
+      THEN("renderers see presentation of their previous frames") {
+        CHECK(first_frames.presented_sequence > 0);
+        CHECK(second_frames.presented_sequence > 0);
+        CHECK(first_frames.presented_sequence <= session.compositor.refreshes());
+      }
+    }
+
+    WHEN("the compositor asks to close the windows") {
+      session.compositor.close_toplevels();
+      session.dispatch_while([&] { return !first.is_closed() || !second.is_closed(); });
+
+      THEN("both windows are closed") {
+        CHECK(first.is_closed());
+        CHECK(second.is_closed());
+      }
+    }
+  }
+}
+
+SCENARIO("Window resolution scaling") {
+  GIVEN("test compositor with wp_viewporter and fractional scale 1.5") {
+    test_session session{
+        {.refresh_period = 2ms, .record_pixels = false, .viewporter = true, .preferred_scale = 180}
+    };
+    asio::static_thread_pool pool{1};
+    render_loop renderer{session.eloop, pool.get_executor()};
+
+    WHEN("a window renders frames within the refresh period") {
+      frames_counter frames;
+      auto wnd = add_counting_window(renderer, session, frames);
+      const size buffer{.width = 24, .height = 24};
+      session.dispatch_while([&] { return !has_commit(session.compositor, buffer, window_size); });
+
+      THEN("buffers of the preferred scale are stretched to the window size") {
+        CHECK(has_commit(session.compositor, buffer, window_size));
+      }
+    }
+
+    WHEN("a window renders frames longer than the refresh period") {
+      frames_counter frames{.cost = 4ms};
+      auto wnd = add_counting_window(renderer, session, frames);
+      const size buffer{.width = 12, .height = 12};
+      session.dispatch_while([&] { return !has_commit(session.compositor, buffer, window_size); });
+
+      THEN("buffer resolution is lowered down to the minimal scale") {
+        CHECK(has_commit(session.compositor, buffer, window_size));
+      }
+    }
+  }
+}
@@ -1,21 +1,87 @@
 #pragma once
 
+#include <concepts>
 #include <functional>
+#include <memory>
+#include <optional>
+#include <typeindex>
+#include <utility>
+#include <vector>
 
 #include <libs/anime/clock.hpp>
 #include <libs/geom/geom.hpp>
 
+#include <libs/wlwnd/presentation.hpp>
+
 struct wl_display;
+struct wl_event_queue;
 struct wl_surface;
-class vsync_frames;
-template <std::regular T>
-class value_update_channel;
-
-using animation_function =
-    std::move_only_function<void(wl_display&, wl_surface&, vsync_frames&, value_update_channel<size>&)>;
 
 template <typename T>
 concept renderer = requires(T& t, size sz, frames_clock::time_point tp) {
   { t.resize(sz) };
   { t.draw(tp) };
 };
+
+/// Objects shared by all the windows drawn on the same render thread like GPU
+/// contexts. Each type is constructed on the first request and destroyed
+/// after all the window renderers in the reverse order of construction.
+class render_resources {
+public:
+  render_resources() noexcept = default;
+
+  render_resources(const render_resources&) = delete;
+  render_resources& operator=(const render_resources&) = delete;
+
+  ~render_resources() noexcept {
+    while (!items_.empty())
+      items_.pop_back();
+  }
+
+  template <typename T, typename... A>
+    requires std::constructible_from<T, A...>
+  T& get(A&&... a) {
+    for (const auto& [type, item] : items_) {
+      if (type == typeid(T))
+        return *static_cast<T*>(item.get());
+    }
+    auto item = std::make_shared<T>(std::forward<A>(a)...);
+    T& res = *item;
+    items_.emplace_back(typeid(T), std::move(item));
+    return res;
+  }
+
+private:
+  std::vector<std::pair<std::type_index, std::shared_ptr<void>>> items_;
+};
+
+/// Surface and services available to a window renderer. Everything is used
+/// on the render thread only.
+struct render_target {
+  wl_display& display;
+  wl_surface& surface;
+  /// Queue dispatched by the render thread. Proxies created by the renderer
+  /// are to be assigned to it unless the renderer dispatches them itself.
+  wl_event_queue& queue;
+  ::size size;
+  render_resources& resources;
+  /// The latest frame of the window shown on the screen. Empty until the
+  /// first presentation feedback is received or if the compositor does not
+  /// support wp_presentation. Updated between `draw` calls.
+  const std::optional<wl::frame_presentation>& presented;
+};
+
+/// Draws frames of a single window.
+class window_renderer {
+public:
+  virtual ~window_renderer() noexcept = default;
+
+  virtual void resize(size sz) = 0;
+  /// Draws the frame to be shown at `frame_time` and commits it. Returns
+  /// false if the content is unchanged and nothing was committed. Such a
+  /// window is not drawn again until it is resized.
+  virtual bool draw(frames_clock::time_point frame_time) = 0;
+};
+
+/// Creates the renderer of a window on the render thread.
+using animation_function = std::move_only_function<std::unique_ptr<window_renderer>(const render_target&)>;
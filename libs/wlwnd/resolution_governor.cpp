@@ -0,0 +1,67 @@
+#include <algorithm>
+#include <cmath>
+
+#include <libs/wlwnd/resolution_governor.hpp>
+
+namespace {
+
+double moving_average(double average, double sample, double weight, size_t samples) noexcept {
+  return samples == 1 ? sample : average + weight * (sample - average);
+}
+
+} // namespace
+
+float resolution_governor::frame_finished(
+    std::chrono::nanoseconds cost, std::chrono::nanoseconds refresh
+) noexcept {
+  if (refresh <= std::chrono::nanoseconds::zero() || opts_.min_scale >= 1)
+    return scale_;
+  ++since_late_;
+  ++samples_;
+  average_cost_ = moving_average(average_cost_, static_cast<double>(cost.count()), opts_.smoothing, samples_);
+  if (samples_ < min_samples)
+    return scale_;
+
+  const double budget = opts_.budget * static_cast<double>(refresh.count());
+  const double planned = opts_.headroom * budget;
+  if (average_cost_ > budget) {
+    const double target = scale_ * std::sqrt(planned / average_cost_);
+    change_scale(opts_.step * std::floor(static_cast<float>(target) / opts_.step));
+  } else if (samples_ >= grow_samples && scale_ < 1) {
+    const float next = std::min(scale_ + opts_.step, 1.f);
+    const double ratio = static_cast<double>(next) / scale_;
+    const bool late_before = next >= late_scale_ && since_late_ < retry_samples;
+    if (!late_before && average_cost_ * ratio * ratio <= planned)
+      change_scale(next);
+  }
+  return scale_;
+}
+
+float resolution_governor::frame_presented(
+    std::chrono::nanoseconds delay, std::chrono::nanoseconds refresh
+) noexcept {
+  if (refresh <= std::chrono::nanoseconds::zero() || opts_.min_scale >= 1)
+    return scale_;
+  min_delay_ = std::min(min_delay_.value_or(delay), delay);
+  const bool late = delay > min_delay_.value() + refresh / 2;
+  if (late)
+    since_late_ = 0;
+  ++presented_;
+  late_share_ = moving_average(late_share_, late ? 1. : 0., opts_.smoothing, presented_);
+  if (presented_ >= min_samples && late_share_ > opts_.max_late) {
+    late_scale_ = scale_;
+    change_scale(scale_ - opts_.step);
+  }
+  return scale_;
+}
+
+void resolution_governor::change_scale(float scale) noexcept {
+  scale = std::clamp(scale, opts_.min_scale, 1.f);
+  if (scale == scale_)
+    return;
+  scale_ = scale;
+  samples_ = 0;
+  average_cost_ = 0;
+  presented_ = 0;
+  late_share_ = 0;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+
+struct resolution_governor_options {
+  /// Lowest fraction of the window size along each axis frames are drawn at.
+  /// One disables resolution scaling.
+  float min_scale = .5f;
+  /// Share of the refresh period a frame may take before its resolution is
+  /// reduced.
+  float budget = .8f;
+  /// Share of the budget frames are planned to take after a change. Keeps
+  /// the resolution from bouncing between two neighbouring steps.
+  float headroom = .8f;
+  /// Resolution is changed in multiples of this fraction of the window size.
+  float step = 1.f / 16;
+  /// Weight of the latest sample in the moving averages of the frame cost
+  /// and of the share of frames shown late.
+  double smoothing = .125;
+  /// Share of frames shown later than planned which makes the resolution
+  /// reduced even if their draw cost fits into the budget.
+  double max_late = .25;
+};
+
+/// Picks the resolution frames are drawn at so that they fit into the refresh
+/// period. The resolution is reduced as soon as frames get too expensive and
+/// grows back one step at a time once frames are cheap enough. Render cost is
+/// assumed to be proportional to the number of pixels drawn.
+///
+/// Decisions are made on the moving averages of recent frames drawn since the
+/// previous change once there are at least `min_samples` of them. Growth
+/// waits for `grow_samples` frames.
+///
+/// Draw cost only covers the work done on the CPU. GPU renderers return right
+/// after submitting their work, so frames shown on the screen later than they
+/// were drawn for are tracked as well. If too many of them are late the
+/// resolution is reduced by a step and does not grow back to the late scale
+/// until `retry_samples` frames are shown in time.
+class resolution_governor {
+public:
+  static constexpr size_t min_samples = 8;
+  static constexpr size_t grow_samples = 60;
+  static constexpr size_t retry_samples = 600;
+
+  resolution_governor() noexcept : resolution_governor(resolution_governor_options{}) {}
+  explicit resolution_governor(resolution_governor_options opts) noexcept : opts_{opts} {}
+
+  /// Registers the cost of a frame drawn at the current scale and returns
+  /// the scale to draw the following frames at. Zero `refresh` means that
+  /// the refresh period is unknown and the scale is kept as is.
+  float frame_finished(std::chrono::nanoseconds cost, std::chrono::nanoseconds refresh) noexcept;
+
+  /// Registers a frame drawn at the current scale which was shown `delay`
+  /// after the time it was drawn for and returns the scale to draw the
+  /// following frames at. The shortest delay seen is taken as the latency of
+  /// the compositor, frames shown more than half of the `refresh` period
+  /// later than that are late.
+  float frame_presented(std::chrono::nanoseconds delay, std::chrono::nanoseconds refresh) noexcept;
+
+  /// Fraction of the window size along each axis to draw frames at.
+  [[nodiscard]] float scale() const noexcept { return scale_; }
+
+private:
+  void change_scale(float scale) noexcept;
+
+private:
+  resolution_governor_options opts_;
+  float scale_ = 1;
+  size_t samples_ = 0;
+  double average_cost_ = 0;
+  size_t presented_ = 0;
+  double late_share_ = 0;
+  std::optional<std::chrono::nanoseconds> min_delay_;
+  // Scale whose frames were shown late and frames drawn since the last late
+  float late_scale_ = 2;
+  size_t since_late_ = 0;
+};
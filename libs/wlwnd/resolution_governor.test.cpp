@@ -0,0 +1,105 @@
+#include "resolution_governor.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+using namespace std::literals;
+
+namespace {
+
+constexpr auto refresh = 16ms;
+
+// Runs frames whose cost is proportional to the number of pixels drawn and
+// returns the scale of the last one.
+float run_frames(resolution_governor& governor, size_t count, std::chrono::nanoseconds full_cost) {
+  for (size_t i = 0; i < count; ++i) {
+    const float scale = governor.scale();
+    const auto cost = std::chrono::duration_cast<std::chrono::nanoseconds>(full_cost * scale * scale);
+    governor.frame_finished(cost, refresh);
+  }
+  return governor.scale();
+}
+
+// Runs cheap frames each shown `delay` after the time it was drawn for and
+// returns the scale of the last one.
+float run_presented(resolution_governor& governor, size_t count, std::chrono::nanoseconds delay) {
+  for (size_t i = 0; i < count; ++i) {
+    governor.frame_finished(2ms, refresh);
+    governor.frame_presented(delay, refresh);
+  }
+  return governor.scale();
+}
+
+} // namespace
+
+SCENARIO("Resolution scaling") {
+  GIVEN("governor with default options") {
+    resolution_governor governor;
+
+    WHEN("frames fit into the budget") {
+      run_frames(governor, 200, 10ms);
+
+      THEN("full resolution is kept") { CHECK(governor.scale() == 1); }
+    }
+
+    WHEN("frames at full resolution are too expensive") {
+      run_frames(governor, resolution_governor::min_samples, 20ms);
+      const float reduced = governor.scale();
+      const float settled = run_frames(governor, 300, 20ms);
+
+      THEN("resolution is reduced right away") { CHECK(reduced < 1); }
+      THEN("resolution settles where frames fit into the budget") {
+        CHECK(run_frames(governor, 300, 20ms) == settled);
+        CHECK(20ms * settled * settled < .8 * refresh);
+        CHECK(20ms * (settled + 1.f / 16) * (settled + 1.f / 16) > .8 * .8 * refresh);
+      }
+
+      AND_WHEN("frames get cheap again") {
+        run_frames(governor, 2000, 5ms);
+
+        THEN("full resolution is restored") { CHECK(governor.scale() == 1); }
+      }
+    }
+
+    WHEN("frames get expensive after a long period of cheap ones") {
+      run_frames(governor, 5000, 5ms);
+      const float reduced = run_frames(governor, 2 * resolution_governor::min_samples, 20ms);
+
+      THEN("resolution is reduced after a few frames") { CHECK(reduced < 1); }
+    }
+
+    WHEN("frames are always shown with the same compositor latency") {
+      const float scale = run_presented(governor, 300, refresh);
+
+      THEN("full resolution is kept") { CHECK(scale == 1); }
+    }
+
+    WHEN("cheap frames are shown later than planned") {
+      run_presented(governor, 100, 1ms);
+      run_presented(governor, 2 * resolution_governor::min_samples, 1ms + refresh);
+      const float reduced = run_presented(governor, 2 * resolution_governor::min_samples, 1ms);
+
+      THEN("resolution is reduced") { CHECK(reduced < 1); }
+
+      AND_WHEN("frames are shown in time at the reduced resolution") {
+        const float kept = run_presented(governor, resolution_governor::retry_samples / 2, 1ms);
+        const float grown = run_presented(governor, resolution_governor::retry_samples, 1ms);
+
+        THEN("resolution does not grow to the late scale for a while") { CHECK(kept == reduced); }
+        THEN("growth is retried later") { CHECK(grown > reduced); }
+      }
+    }
+
+    WHEN("frames are too expensive at any resolution") {
+      run_frames(governor, 300, 100ms);
+
+      THEN("the lowest resolution is used") { CHECK(governor.scale() == .5f); }
+    }
+
+    WHEN("refresh period is unknown") {
+      for (size_t i = 0; i < 100; ++i)
+        governor.frame_finished(100ms, 0ns);
+
+      THEN("resolution is not changed") { CHECK(governor.scale() == 1); }
+    }
+  }
+}
@@ -6,7 +6,11 @@
 
 #include <libs/geom/geom.hpp>
 
+#include <libs/wlwnd/presentation.hpp>
+
 struct wl_surface;
+struct wp_fractional_scale_manager_v1;
+struct wp_viewporter;
 namespace xdg {
 struct delegate;
 }
@@ -23,6 +27,15 @@ template <window Wnd>
 struct sized_window {
   Wnd window;
   size sz;
+  /// Service to get feedback on frames of the window from. Its presentation
+  /// is null if the compositor does not support wp_presentation.
+  presentation_service presentation = {};
+  /// Lets the window buffer be drawn at a size other than the window size.
+  /// Null if the compositor does not support wp_viewporter.
+  wp_viewporter* viewporter = nullptr;
+  /// Source of the scale preferred for the window buffer. Null if the
+  /// compositor does not support wp_fractional_scale_v1.
+  wp_fractional_scale_manager_v1* fractional_scale = nullptr;
 };
 
 class shell_window {
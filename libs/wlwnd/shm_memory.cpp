@@ -0,0 +1,111 @@
+#include "shm_memory.hpp"
+
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <spdlog/spdlog.h>
+
+namespace wl {
+
+namespace {
+
+// Closes the descriptor unless it is released to the memory allocated
+class unique_fd {
+public:
+  explicit unique_fd(int fd) noexcept : fd_{fd} {}
+
+  unique_fd(const unique_fd&) = delete;
+  unique_fd& operator=(const unique_fd&) = delete;
+
+  ~unique_fd() noexcept {
+    if (fd_ >= 0)
+      ::close(fd_);
+  }
+
+  int get() const noexcept { return fd_; }
+  int release() noexcept { return std::exchange(fd_, -1); }
+
+private:
+  int fd_;
+};
+
+size_t round_up(size_t size, size_t granularity) noexcept {
+  return (size + granularity - 1) / granularity * granularity;
+}
+
+std::byte* map(int fd, size_t size, bool hugetlb) {
+  // Transparent huge pages have to be requested before the memory is faulted
+  // in, so such mappings are prefaulted with madvise instead of MAP_POPULATE
+  const bool thp = !hugetlb && size >= shm_memory::huge_page_size;
+  void* res = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | (thp ? 0 : MAP_POPULATE), fd, 0);
+  if (res == MAP_FAILED)
+    throw std::system_error{errno, std::system_category(), "mmap"};
+  if (thp) {
+    // Both are hints which kernels with THP disabled for shmem or too old to
+    // populate with madvise ignore
+    ::madvise(res, size, MADV_HUGEPAGE);
+#ifdef MADV_POPULATE_WRITE
+    ::madvise(res, size, MADV_POPULATE_WRITE);
+#endif
+  }
+  return static_cast<std::byte*>(res);
+}
+
+} // namespace
+
+shm_memory::shm_memory(size_t size, bool hugetlb) {
+  if (hugetlb) {
+    // Hugetlb pages come from the pool reserved by the administrator which is
+    // usually empty
+    try {
+      allocate(size, true);
+      return;
+    } catch (const std::system_error& err) {
+      spdlog::debug("Falling back to regular pages for shm buffers: {}", err.what());
+    }
+  }
+  allocate(size, false);
+}
+
+shm_memory::~shm_memory() noexcept {
+  if (data_)
+    ::munmap(data_, size_);
+  if (fd_ >= 0)
+    ::close(fd_);
+}
+
+void shm_memory::grow(size_t size) {
+  if (size <= size_)
+    return;
+  size = round_up(size, hugetlb_ ? huge_page_size : 1);
+  if (::ftruncate(fd_, static_cast<off_t>(size)) != 0)
+    throw std::system_error{errno, std::system_category(), "ftruncate"};
+  std::byte* data = map(fd_, size, hugetlb_);
+  ::munmap(data_, size_);
+  data_ = data;
+  size_ = size;
+}
+
+// Members are set only once everything succeeds, so failed allocation leaves
+// the memory empty
+void shm_memory::allocate(size_t size, bool hugetlb) {
+  unique_fd fd{::memfd_create("wl_shm", MFD_CLOEXEC | MFD_ALLOW_SEALING | (hugetlb ? MFD_HUGETLB : 0u))};
+  if (fd.get() < 0)
+    throw std::system_error{errno, std::system_category(), "memfd_create"};
+  size = round_up(size, hugetlb ? huge_page_size : 1);
+  if (::ftruncate(fd.get(), static_cast<off_t>(size)) != 0)
+    throw std::system_error{errno, std::system_category(), "ftruncate"};
+  // Compositor maps the whole pool, so it may only grow
+  if (::fcntl(fd.get(), F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_SEAL) != 0)
+    throw std::system_error{errno, std::system_category(), "fcntl(F_ADD_SEALS)"};
+  data_ = map(fd.get(), size, hugetlb);
+  fd_ = fd.release();
+  size_ = size;
+  hugetlb_ = hugetlb;
+}
+
+} // namespace wl
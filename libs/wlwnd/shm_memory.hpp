@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <utility>
+
+namespace wl {
+
+/// Memory backing wl_shm pools. It is an anonymous memfd sealed against
+/// shrinking so the compositor reading buffers from it never gets SIGBUS
+/// because of a truncated file.
+///
+/// Memory is prefaulted when mapped, so frames drawn into freshly allocated
+/// buffers take no page faults. Large pools are backed with hugetlb pages if
+/// requested and the system has enough of them reserved, and ask for
+/// transparent huge pages otherwise.
+class shm_memory {
+public:
+  static constexpr size_t huge_page_size = 2 * 1024 * 1024;
+
+  shm_memory() noexcept = default;
+  /// Allocates at least `size` bytes. Size is rounded up to the huge page
+  /// size when `hugetlb` pages are used.
+  shm_memory(size_t size, bool hugetlb);
+
+  shm_memory(const shm_memory&) = delete;
+  shm_memory& operator=(const shm_memory&) = delete;
+
+  shm_memory(shm_memory&& rhs) noexcept
+      : fd_{std::exchange(rhs.fd_, -1)}, data_{std::exchange(rhs.data_, nullptr)},
+        size_{std::exchange(rhs.size_, 0)}, hugetlb_{rhs.hugetlb_} {}
+  shm_memory& operator=(shm_memory&& rhs) noexcept {
+    shm_memory tmp{std::move(rhs)};
+    swap(tmp);
+    return *this;
+  }
+
+  ~shm_memory() noexcept;
+
+  /// Grows the memory to hold at least `size` bytes keeping its content. The
+  /// memory is remapped, so spans obtained before are invalidated.
+  void grow(size_t size);
+
+  [[nodiscard]] int native_handle() const noexcept { return fd_; }
+  [[nodiscard]] std::span<std::byte> bytes() const noexcept { return {data_, size_}; }
+  [[nodiscard]] size_t size() const noexcept { return size_; }
+  [[nodiscard]] bool hugetlb() const noexcept { return hugetlb_; }
+
+  void swap(shm_memory& rhs) noexcept {
+    std::swap(fd_, rhs.fd_);
+    std::swap(data_, rhs.data_);
+    std::swap(size_, rhs.size_);
+    std::swap(hugetlb_, rhs.hugetlb_);
+  }
+
+private:
+  void allocate(size_t size, bool hugetlb);
+
+private:
+  int fd_ = -1;
+  std::byte* data_ = nullptr;
+  size_t size_ = 0;
+  bool hugetlb_ = false;
+};
+
+} // namespace wl
@@ -0,0 +1,79 @@
+#include "shm_memory.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+
+bool resident(std::span<std::byte> mem) {
+  const auto page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+  std::vector<unsigned char> pages((mem.size() + page_size - 1) / page_size);
+  if (::mincore(mem.data(), mem.size(), pages.data()) != 0)
+    return false;
+  return std::ranges::all_of(pages, [](unsigned char page) { return (page & 1) != 0; });
+}
+
+} // namespace
+
+SCENARIO("Shared memory for wl_shm pools") {
+  GIVEN("memory of regular pages") {
+    constexpr size_t size = 64 * 1024;
+    wl::shm_memory mem{size, false};
+
+    THEN("it is prefaulted") {
+      CHECK(mem.size() == size);
+      CHECK(resident(mem.bytes()));
+    }
+
+    THEN("it can't be shrunk") {
+      CHECK(::ftruncate(mem.native_handle(), size / 2) != 0);
+      CHECK((::fcntl(mem.native_handle(), F_GET_SEALS) & F_SEAL_SHRINK) != 0);
+    }
+
+    WHEN("it grows") {
+      std::ranges::fill(mem.bytes(), std::byte{0x42});
+      mem.grow(3 * size);
+
+      THEN("the content is kept and the new part is prefaulted too") {
+        REQUIRE(mem.size() == 3 * size);
+        CHECK(std::ranges::all_of(mem.bytes().first(size), [](std::byte b) { return b == std::byte{0x42}; }));
+        CHECK(resident(mem.bytes()));
+      }
+    }
+  }
+
+  GIVEN("memory asked to use hugetlb pages") {
+    constexpr size_t size = 1024;
+    wl::shm_memory mem{size, true};
+
+    THEN("its size depends on the pages it falls back to if none are reserved") {
+      if (mem.hugetlb())
+        CHECK(mem.size() == wl::shm_memory::huge_page_size);
+      else
+        CHECK(mem.size() == size);
+      CHECK(resident(mem.bytes()));
+    }
+
+    WHEN("it is written and grows") {
+      std::ranges::fill(mem.bytes(), std::byte{0x42});
+      const size_t old_size = mem.size();
+      mem.grow(old_size + wl::shm_memory::huge_page_size + 1);
+
+      THEN("the content is kept") {
+        CHECK(mem.size() >= old_size + wl::shm_memory::huge_page_size + 1);
+        if (mem.hugetlb())
+          CHECK(mem.size() % wl::shm_memory::huge_page_size == 0);
+        CHECK(std::ranges::all_of(mem.bytes().first(old_size), [](std::byte b) {
+          return b == std::byte{0x42};
+        }));
+        CHECK(resident(mem.bytes()));
+      }
+    }
+  }
+}
@@ -3,7 +3,10 @@
 #include <memory>
 #include <string_view>
 
+#include <fractional-scale-v1.h>
 #include <ivi-application.h>
+#include <presentation-time.h>
+#include <viewporter.h>
 #include <wayland-client.h>
 #include <xdg-shell.h>
 
@@ -40,6 +43,14 @@ struct deleter {
 
   void operator()(ivi_application* ptr) noexcept { ivi_application_destroy(ptr); }
   void operator()(ivi_surface* ptr) noexcept { ivi_surface_destroy(ptr); }
+  void operator()(wp_presentation* ptr) noexcept { wp_presentation_destroy(ptr); }
+  void operator()(struct wp_presentation_feedback* ptr) noexcept { wp_presentation_feedback_destroy(ptr); }
+  void operator()(wp_viewporter* ptr) noexcept { wp_viewporter_destroy(ptr); }
+  void operator()(wp_viewport* ptr) noexcept { wp_viewport_destroy(ptr); }
+  void operator()(wp_fractional_scale_manager_v1* ptr) noexcept {
+    wp_fractional_scale_manager_v1_destroy(ptr);
+  }
+  void operator()(wp_fractional_scale_v1* ptr) noexcept { wp_fractional_scale_v1_destroy(ptr); }
   void operator()(xdg_wm_base* ptr) noexcept { xdg_wm_base_destroy(ptr); }
   void operator()(xdg_surface* ptr) noexcept { xdg_surface_destroy(ptr); }
   void operator()(xdg_toplevel* ptr) noexcept { xdg_toplevel_destroy(ptr); }
@@ -80,6 +91,24 @@ struct service_trait<ivi_application> {
   static constexpr const wl_interface* iface = &ivi_application_interface;
 };
 
+template <>
+struct service_trait<wp_presentation> {
+  static constexpr auto name = "wp_presentation"sv;
+  static constexpr const wl_interface* iface = &wp_presentation_interface;
+};
+
+template <>
+struct service_trait<wp_viewporter> {
+  static constexpr auto name = "wp_viewporter"sv;
+  static constexpr const wl_interface* iface = &wp_viewporter_interface;
+};
+
+template <>
+struct service_trait<wp_fractional_scale_manager_v1> {
+  static constexpr auto name = "wp_fractional_scale_manager_v1"sv;
+  static constexpr const wl_interface* iface = &wp_fractional_scale_manager_v1_interface;
+};
+
 template <>
 struct service_trait<xdg_wm_base> {
   static constexpr auto name = "xdg_wm_base"sv;
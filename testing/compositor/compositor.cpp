@@ -0,0 +1,702 @@
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <fractional-scale-v1-server.h>
+#include <presentation-time-server.h>
+#include <viewporter-server.h>
+#include <wayland-server.h>
+#include <xdg-shell-server.h>
+
+#include <testing/compositor/compositor.hpp>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+class unique_fd {
+public:
+  explicit unique_fd(int fd) noexcept : fd_{fd} {}
+
+  unique_fd(unique_fd&& rhs) noexcept : fd_{rhs.release()} {}
+  unique_fd& operator=(unique_fd&&) = delete;
+
+  ~unique_fd() noexcept {
+    if (fd_ >= 0)
+      ::close(fd_);
+  }
+
+  explicit operator bool() const noexcept { return fd_ >= 0; }
+  int get() const noexcept { return fd_; }
+  int release() noexcept { return std::exchange(fd_, -1); }
+
+private:
+  int fd_;
+};
+
+struct display_deleter {
+  void operator()(wl_display* display) noexcept { wl_display_destroy(display); }
+};
+
+struct socket_dir {
+  socket_dir() {
+    std::string tmpl = (fs::temp_directory_path() / "wayland-test-XXXXXX").native();
+    if (!::mkdtemp(tmpl.data()))
+      throw std::system_error{errno, std::system_category(), "mkdtemp"};
+    path = std::move(tmpl);
+  }
+
+  socket_dir(const socket_dir&) = delete;
+  socket_dir& operator=(const socket_dir&) = delete;
+
+  ~socket_dir() noexcept {
+    std::error_code ec;
+    fs::remove_all(path, ec);
+  }
+
+  fs::path path;
+};
+
+unique_fd listen_socket(const fs::path& path) {
+  sockaddr_un addr{.sun_family = AF_UNIX, .sun_path = {}};
+  if (path.native().size() >= sizeof(addr.sun_path))
+    throw std::runtime_error{"Socket path is too long: " + path.native()};
+  std::ranges::copy(path.native(), addr.sun_path);
+
+  unique_fd fd{::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+  if (!fd)
+    throw std::system_error{errno, std::system_category(), "socket"};
+  if (::bind(fd.get(), reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0)
+    throw std::system_error{errno, std::system_category(), "bind"};
+  if (::listen(fd.get(), 16) != 0)
+    throw std::system_error{errno, std::system_category(), "listen"};
+  return fd;
+}
+
+template <typename T>
+T& get(wl_resource* res) noexcept {
+  return *static_cast<T*>(wl_resource_get_user_data(res));
+}
+
+void destroy(wl_client*, wl_resource* res) { wl_resource_destroy(res); }
+
+template <typename... A>
+void ignore(wl_client*, wl_resource*, A...) {}
+
+// Resources kept in intrusive lists of the compositor use wl_resource link
+// which must be removed from the list when the client destroys them.
+void unlink_resource(wl_resource* res) { wl_list_remove(wl_resource_get_link(res)); }
+
+void discard_feedbacks(wl_list& feedbacks) {
+  wl_resource *fb, *tmp;
+  wl_resource_for_each_safe(fb, tmp, &feedbacks) {
+    wp_presentation_feedback_send_discarded(fb);
+    wl_resource_destroy(fb);
+  }
+}
+
+struct server;
+
+// Shm buffer kept after commit until the refresh it is released on. Clients
+// may destroy it earlier.
+struct held_buffer {
+  held_buffer(wl_resource* buf, uint64_t release_seq) : buffer{buf}, release_seq{release_seq} {
+    destroy.notify = [](wl_listener* listener, void*) {
+      held_buffer* self = wl_container_of(listener, self, destroy);
+      self->buffer = nullptr;
+    };
+    wl_resource_add_destroy_listener(buffer, &destroy);
+  }
+
+  held_buffer(const held_buffer&) = delete;
+  held_buffer& operator=(const held_buffer&) = delete;
+
+  ~held_buffer() noexcept {
+    if (buffer)
+      wl_list_remove(&destroy.link);
+  }
+
+  void release() noexcept {
+    if (buffer)
+      wl_buffer_send_release(buffer);
+  }
+
+  wl_listener destroy;
+  wl_resource* buffer;
+  uint64_t release_seq;
+};
+
+// Buffer, damage, viewport destination, frame callbacks and presentation
+// feedbacks are double buffered state applied on commit. Nothing else is
+// tracked since the test compositor never draws.
+struct surface {
+  explicit surface(server& srv);
+
+  surface(const surface&) = delete;
+  surface& operator=(const surface&) = delete;
+
+  ~surface() noexcept;
+
+  void attach(wl_resource* buf) noexcept {
+    if (buffer)
+      wl_list_remove(&buffer_destroy.link);
+    buffer = buf;
+    attached = true;
+    if (buffer)
+      wl_resource_add_destroy_listener(buffer, &buffer_destroy);
+  }
+
+  wl_listener buffer_destroy;
+  server* srv;
+  wl_resource* buffer = nullptr;
+  bool attached = false;
+  std::vector<rect> damage;
+  std::optional<::size> pending_destination;
+  ::size destination;
+  wl_list frames;
+  wl_list feedbacks;
+  // Feedbacks of the committed frame to be shown on the next refresh
+  wl_list presenting;
+};
+
+struct server {
+  explicit server(test_compositor_options opts);
+
+  server(const server&) = delete;
+  server& operator=(const server&) = delete;
+
+  ~server() noexcept {
+    thread.request_stop();
+    wake();
+    thread.join();
+    // Client resources unlink themselves from the lists of the server
+    wl_display_destroy_clients(display.get());
+  }
+
+  void run(std::stop_token stop) {
+    while (!stop.stop_requested()) {
+      wl_display_flush_clients(display.get());
+      wl_event_loop_dispatch(wl_display_get_event_loop(display.get()), -1);
+    }
+  }
+
+  void wake() noexcept {
+    const uint64_t inc = 1;
+    [[maybe_unused]] const auto written = ::write(wake_fd.get(), &inc, sizeof(inc));
+  }
+
+  void post(std::function<void()> task) {
+    {
+      std::lock_guard lock{mutex};
+      tasks.push_back(std::move(task));
+    }
+    wake();
+  }
+
+  void commit(surface& surf);
+  void present(std::chrono::steady_clock::time_point vblank, uint64_t seq);
+  static int refresh(int fd, uint32_t mask, void* data);
+  static int run_tasks(int fd, uint32_t mask, void* data);
+
+  const test_compositor_options opts;
+  socket_dir dir;
+  std::string socket_path = (dir.path / "wayland-0").native();
+  std::unique_ptr<wl_display, display_deleter> display{wl_display_create()};
+  unique_fd wake_fd{::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)};
+  // Callbacks of committed frames waiting for the next refresh
+  wl_list ready_frames;
+  std::list<held_buffer> held_buffers;
+  wl_list toplevels;
+  std::vector<surface*> surfaces;
+  std::chrono::steady_clock::time_point start;
+  std::atomic<uint64_t> refreshes = 0;
+
+  mutable std::mutex mutex;
+  mutable std::condition_variable commits_cv;
+  std::vector<committed_frame> commits;
+  std::vector<std::function<void()>> tasks;
+
+  std::jthread thread;
+};
+
+surface::surface(server& srv) : srv{&srv} {
+  buffer_destroy.notify = [](wl_listener* listener, void*) {
+    surface* self = wl_container_of(listener, self, buffer_destroy);
+    self->buffer = nullptr;
+  };
+  wl_list_init(&frames);
+  wl_list_init(&feedbacks);
+  wl_list_init(&presenting);
+  srv.surfaces.push_back(this);
+}
+
+surface::~surface() noexcept {
+  std::erase(srv->surfaces, this);
+  attach(nullptr);
+  wl_resource *cb, *tmp;
+  wl_resource_for_each_safe(cb, tmp, &frames) wl_resource_destroy(cb);
+  discard_feedbacks(feedbacks);
+  discard_feedbacks(presenting);
+}
+
+void server::commit(surface& surf) {
+  if (surf.pending_destination)
+    surf.destination = std::exchange(surf.pending_destination, std::nullopt).value();
+  committed_frame frame{
+      .time = std::chrono::steady_clock::now(),
+      .damage = std::exchange(surf.damage, {}),
+      .destination = surf.destination
+  };
+  if (std::exchange(surf.attached, false) && surf.buffer) {
+    wl_resource* buffer = surf.buffer;
+    surf.attach(nullptr);
+    surf.attached = false;
+    if (wl_shm_buffer* shm = wl_shm_buffer_get(buffer)) {
+      frame.size = {.width = wl_shm_buffer_get_width(shm), .height = wl_shm_buffer_get_height(shm)};
+      frame.stride = wl_shm_buffer_get_stride(shm);
+      frame.format = wl_shm_buffer_get_format(shm);
+      if (opts.record_pixels) {
+        wl_shm_buffer_begin_access(shm);
+        const auto* data = static_cast<const std::byte*>(wl_shm_buffer_get_data(shm));
+        frame.pixels.assign(data, data + static_cast<size_t>(frame.stride) * frame.size.height);
+        wl_shm_buffer_end_access(shm);
+      }
+    }
+    frame.held_buffer_attached = std::ranges::contains(held_buffers, buffer, &held_buffer::buffer);
+    if (opts.hold_refreshes == 0)
+      wl_buffer_send_release(buffer);
+    else
+      held_buffers.emplace_back(buffer, refreshes.load() + opts.hold_refreshes);
+  }
+  wl_list_insert_list(ready_frames.prev, &surf.frames);
+  wl_list_init(&surf.frames);
+  // Previous frame is replaced before it is shown
+  discard_feedbacks(surf.presenting);
+  wl_list_insert_list(&surf.presenting, &surf.feedbacks);
+  wl_list_init(&surf.feedbacks);
+
+  {
+    std::lock_guard lock{mutex};
+    commits.push_back(std::move(frame));
+  }
+  commits_cv.notify_all();
+}
+
+int server::refresh(int fd, uint32_t, void* data) {
+  auto& self = *static_cast<server*>(data);
+  uint64_t expirations = 0;
+  if (::read(fd, &expirations, sizeof(expirations)) != sizeof(expirations))
+    return 0;
+  const uint64_t seq = self.refreshes += expirations;
+  // Refreshes happen exactly on the virtual retrace grid
+  const auto vblank = self.start + static_cast<int64_t>(seq) * self.opts.refresh_period;
+  self.present(vblank, seq);
+  std::erase_if(self.held_buffers, [seq](held_buffer& buf) {
+    if (buf.release_seq > seq)
+      return false;
+    buf.release();
+    return true;
+  });
+
+  using namespace std::chrono;
+  const auto ts = static_cast<uint32_t>(duration_cast<milliseconds>(vblank.time_since_epoch()).count());
+  wl_resource *cb, *tmp;
+  wl_resource_for_each_safe(cb, tmp, &self.ready_frames) {
+    wl_callback_send_done(cb, ts);
+    wl_resource_destroy(cb);
+  }
+  return 0;
+}
+
+void server::present(std::chrono::steady_clock::time_point vblank, uint64_t seq) {
+  using namespace std::chrono;
+  const auto ts = vblank.time_since_epoch();
+  const auto sec = static_cast<uint64_t>(duration_cast<seconds>(ts).count());
+  const auto nsec = static_cast<uint32_t>((ts - seconds{sec}).count());
+  const auto refresh = static_cast<uint32_t>(opts.refresh_period.count());
+  for (surface* surf : surfaces) {
+    wl_resource *fb, *tmp;
+    wl_resource_for_each_safe(fb, tmp, &surf->presenting) {
+      wp_presentation_feedback_send_presented(
+          fb, static_cast<uint32_t>(sec >> 32), static_cast<uint32_t>(sec), nsec, refresh,
+          static_cast<uint32_t>(seq >> 32), static_cast<uint32_t>(seq), WP_PRESENTATION_FEEDBACK_KIND_VSYNC
+      );
+      wl_resource_destroy(fb);
+    }
+  }
+}
+
+int server::run_tasks(int fd, uint32_t, void* data) {
+  auto& self = *static_cast<server*>(data);
+  uint64_t count = 0;
+  [[maybe_unused]] const auto rd = ::read(fd, &count, sizeof(count));
+
+  std::vector<std::function<void()>> tasks;
+  {
+    std::lock_guard lock{self.mutex};
+    tasks.swap(self.tasks);
+  }
+  for (auto& task : tasks)
+    task();
+  return 0;
+}
+
+// wl_region
+
+const struct wl_region_interface region_impl = {
+    .destroy = &destroy,
+    .add = &ignore<int32_t, int32_t, int32_t, int32_t>,
+    .subtract = &ignore<int32_t, int32_t, int32_t, int32_t>,
+};
+
+// wl_surface
+
+void surface_attach(wl_client*, wl_resource* res, wl_resource* buffer, int32_t, int32_t) {
+  get<surface>(res).attach(buffer);
+}
+
+void surface_damage(wl_client*, wl_resource* res, int32_t x, int32_t y, int32_t width, int32_t height) {
+  get<surface>(res).damage.push_back({.x = x, .y = y, .width = width, .height = height});
+}
+
+void surface_frame(wl_client* client, wl_resource* res, uint32_t id) {
+  wl_resource* cb = wl_resource_create(client, &wl_callback_interface, 1, id);
+  if (!cb) {
+    wl_resource_post_no_memory(res);
+    return;
+  }
+  wl_resource_set_implementation(cb, nullptr, nullptr, &unlink_resource);
+  wl_list_insert(get<surface>(res).frames.prev, wl_resource_get_link(cb));
+}
+
+void surface_commit(wl_client*, wl_resource* res) {
+  auto& surf = get<surface>(res);
+  surf.srv->commit(surf);
+}
+
+const struct wl_surface_interface surface_impl = {
+    .destroy = &destroy,
+    .attach = &surface_attach,
+    .damage = &surface_damage,
+    .frame = &surface_frame,
+    .set_opaque_region = &ignore<wl_resource*>,
+    .set_input_region = &ignore<wl_resource*>,
+    .commit = &surface_commit,
+    .set_buffer_transform = &ignore<int32_t>,
+    .set_buffer_scale = &ignore<int32_t>,
+    .damage_buffer = &surface_damage,
+};
+
+// wl_compositor
+
+void create_surface(wl_client* client, wl_resource* res, uint32_t id) {
+  wl_resource* surf = wl_resource_create(client, &wl_surface_interface, wl_resource_get_version(res), id);
+  if (!surf) {
+    wl_resource_post_no_memory(res);
+    return;
+  }
+  wl_resource_set_implementation(surf, &surface_impl, new surface{get<server>(res)}, [](wl_resource* surf) {
+    delete &get<surface>(surf);
+  });
+}
+
+void create_region(wl_client* client, wl_resource* res, uint32_t id) {
+  wl_resource* region = wl_resource_create(client, &wl_region_interface, 1, id);
+  if (!region) {
+    wl_resource_post_no_memory(res);
+    return;
+  }
+  wl_resource_set_implementation(region, &region_impl, nullptr, nullptr);
+}
+
+const struct wl_compositor_interface compositor_impl = {
+    .create_surface = &create_surface,
+    .create_region = &create_region,
+};
+
+// xdg_positioner
+
+const struct xdg_positioner_interface positioner_impl = {
+    .destroy = &destroy,
+    .set_size = &ignore<int32_t, int32_t>,
+    .set_anchor_rect = &ignore<int32_t, int32_t, int32_t, int32_t>,
+    .set_anchor = &ignore<uint32_t>,
+    .set_gravity = &ignore<uint32_t>,
+    .set_constraint_adjustment = &ignore<uint32_t>,
+    .set_offset = &ignore<int32_t, int32_t>,
+};
+
+// xdg_toplevel
+
+const struct xdg_toplevel_interface toplevel_impl = {
+    .destroy = &destroy,
+    .set_parent = &ignore<wl_resource*>,
+    .set_title = &ignore<const char*>,
+    .set_app_id = &ignore<const char*>,
+    .show_window_menu = &ignore<wl_resource*, uint32_t, int32_t, int32_t>,
+    .move = &ignore<wl_resource*, uint32_t>,
+    .resize = &ignore<wl_resource*, uint32_t, uint32_t>,
+    .set_max_size = &ignore<int32_t, int32_t>,
+    .set_min_size = &ignore<int32_t, int32_t>,
+    .set_maximized = &ignore<>,
+    .unset_maximized = &ignore<>,
+    .set_fullscreen = &ignore<wl_resource*>,
+    .unset_fullscreen = &ignore<>,
+    .set_minimized = &ignore<>,
+};
+
+// xdg_surface
+
+void get_toplevel(wl_client* client, wl_resource* res, uint32_t id) {
+  auto& srv = get<server>(res);
+  wl_resource* toplevel =
+      wl_resource_create(client, &xdg_toplevel_interface, wl_resource_get_version(res), id);
+  if (!toplevel) {
+    wl_resource_post_no_memory(res);
+    return;
+  }
+  wl_resource_set_implementation(toplevel, &toplevel_impl, &srv, &unlink_resource);
+  wl_list_insert(srv.toplevels.prev, wl_resource_get_link(toplevel));
+
+  wl_array states;
+  wl_array_init(&states);
+  xdg_toplevel_send_configure(toplevel, srv.opts.window_size.width, srv.opts.window_size.height, &states);
+  wl_array_release(&states);
+  xdg_surface_send_configure(res, wl_display_next_serial(srv.display.get()));
+}
+
+void get_popup(wl_client* client, wl_resource*, uint32_t, wl_resource*, wl_resource*) {
+  wl_client_post_implementation_error(client, "xdg_popup is not supported by the test compositor");
+}
+
+const struct xdg_surface_interface xdg_surface_impl = {
+    .destroy = &destroy,
+    .get_toplevel = &get_toplevel,
+    .get_popup = &get_popup,
+    .set_window_geometry = &ignore<int32_t, int32_t, int32_t, int32_t>,
+    .ack_configure = &ignore<uint32_t>,
+};
+
+// xdg_wm_base
+
+void create_positioner(wl_client* client, wl_resource* res, uint32_t id) {
+  wl_resource* positioner =
+      wl_resource_create(client, &xdg_positioner_interface, wl_resource_get_version(res), id);
+  if (!positioner) {
+    wl_resource_post_no_memory(res);
+    return;
+  }
+  wl_resource_set_implementation(positioner, &positioner_impl, nullptr, nullptr);
+}
+
+void get_xdg_surface(wl_client* client, wl_resource* res, uint32_t id, wl_resource*) {
+  wl_resource* surf = wl_resource_create(client, &xdg_surface_interface, wl_resource_get_version(res), id);
+  if (!surf) {
+    wl_resource_post_no_memory(res);
+    return;
+  }
+  wl_resource_set_implementation(surf, &xdg_surface_impl, &get<server>(res), nullptr);
+}
+
+const struct xdg_wm_base_interface wm_base_impl = {
+    .destroy = &destroy,
+    .create_positioner = &create_positioner,
+    .get_xdg_surface = &get_xdg_surface,
+    .pong = &ignore<uint32_t>,
+};
+
+// wp_presentation
+
+void presentation_feedback(wl_client* client, wl_resource* res, wl_resource* surf, uint32_t id) {
+  wl_resource* fb = wl_resource_create(client, &wp_presentation_feedback_interface, 1, id);
+  if (!fb) {
+    wl_resource_post_no_memory(res);
+    return;
+  }
+  wl_resource_set_implementation(fb, nullptr, nullptr, &unlink_resource);
+  wl_list_insert(get<surface>(surf).feedbacks.prev, wl_resource_get_link(fb));
+}
+
+const struct wp_presentation_interface presentation_impl = {
+    .destroy = &destroy,
+    .feedback = &presentation_feedback,
+};
+
+void bind_presentation(wl_client* client, void* data, uint32_t ver, uint32_t id) {
+  wl_resource* res = wl_resource_create(client, &wp_presentation_interface, static_cast<int>(ver), id);
+  if (!res) {
+    wl_client_post_no_memory(client);
+    return;
+  }
+  wl_resource_set_implementation(res, &presentation_impl, data, nullptr);
+  // std::chrono::steady_clock is CLOCK_MONOTONIC
+  wp_presentation_send_clock_id(res, CLOCK_MONOTONIC);
+}
+
+// wp_viewporter
+
+void viewport_set_destination(wl_client*, wl_resource* res, int32_t width, int32_t height) {
+  // Destination is unset with -1
+  get<surface>(res).pending_destination = width > 0 ? ::size{.width = width, .height = height} : ::size{};
+}
+
+const struct wp_viewport_interface viewport_impl = {
+    .destroy = &destroy,
+    .set_source = &ignore<wl_fixed_t, wl_fixed_t, wl_fixed_t, wl_fixed_t>,
+    .set_destination = &viewport_set_destination,
+};
+
+void get_viewport(wl_client* client, wl_resource* res, uint32_t id, wl_resource* surf) {
+  wl_resource* viewport = wl_resource_create(client, &wp_viewport_interface, 1, id);
+  if (!viewport) {
+    wl_resource_post_no_memory(res);
+    return;
+  }
+  wl_resource_set_implementation(viewport, &viewport_impl, &get<surface>(surf), nullptr);
+}
+
+const struct wp_viewporter_interface viewporter_impl = {
+    .destroy = &destroy,
+    .get_viewport = &get_viewport,
+};
+
+// wp_fractional_scale_manager_v1
+
+const struct wp_fractional_scale_v1_interface fractional_scale_impl = {
+    .destroy = &destroy,
+};
+
+void get_fractional_scale(wl_client* client, wl_resource* res, uint32_t id, wl_resource*) {
+  wl_resource* scale = wl_resource_create(client, &wp_fractional_scale_v1_interface, 1, id);
+  if (!scale) {
+    wl_resource_post_no_memory(res);
+    return;
+  }
+  wl_resource_set_implementation(scale, &fractional_scale_impl, nullptr, nullptr);
+  wp_fractional_scale_v1_send_preferred_scale(scale, get<server>(res).opts.preferred_scale);
+}
+
+const struct wp_fractional_scale_manager_v1_interface fractional_scale_manager_impl = {
+    .destroy = &destroy,
+    .get_fractional_scale = &get_fractional_scale,
+};
+
+// globals
+
+template <const wl_interface* Iface, auto Impl>
+void bind_global(wl_client* client, void* data, uint32_t ver, uint32_t id) {
+  wl_resource* res = wl_resource_create(client, Iface, static_cast<int>(ver), id);
+  if (!res) {
+    wl_client_post_no_memory(client);
+    return;
+  }
+  wl_resource_set_implementation(res, Impl, data, nullptr);
+}
+
+server::server(test_compositor_options opts) : opts{opts} {
+  if (!display)
+    throw std::runtime_error{"Failed to create test wayland display"};
+  if (!wake_fd)
+    throw std::system_error{errno, std::system_category(), "eventfd"};
+  wl_list_init(&ready_frames);
+  wl_list_init(&toplevels);
+
+  auto sock = listen_socket(socket_path);
+  if (wl_display_add_socket_fd(display.get(), sock.get()) != 0)
+    throw std::runtime_error{"Failed to listen for wayland clients on " + socket_path};
+  sock.release();
+
+  // wl_surface.damage_buffer is available since version 4
+  wl_global_create(
+      display.get(), &wl_compositor_interface, 4, this,
+      &bind_global<&wl_compositor_interface, &compositor_impl>
+  );
+  wl_global_create(
+      display.get(), &xdg_wm_base_interface, 1, this, &bind_global<&xdg_wm_base_interface, &wm_base_impl>
+  );
+  wl_global_create(display.get(), &wp_presentation_interface, 1, this, &bind_presentation);
+  if (opts.viewporter) {
+    wl_global_create(
+        display.get(), &wp_viewporter_interface, 1, this,
+        &bind_global<&wp_viewporter_interface, &viewporter_impl>
+    );
+  }
+  if (opts.viewporter && opts.preferred_scale != 0) {
+    wl_global_create(
+        display.get(), &wp_fractional_scale_manager_v1_interface, 1, this,
+        &bind_global<&wp_fractional_scale_manager_v1_interface, &fractional_scale_manager_impl>
+    );
+  }
+  if (wl_display_init_shm(display.get()) != 0)
+    throw std::runtime_error{"Failed to create wl_shm global"};
+
+  unique_fd timer{::timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK)};
+  if (!timer)
+    throw std::system_error{errno, std::system_category(), "timerfd_create"};
+  const auto secs = std::chrono::duration_cast<std::chrono::seconds>(opts.refresh_period);
+  const timespec period{.tv_sec = secs.count(), .tv_nsec = (opts.refresh_period - secs).count()};
+  const itimerspec spec{.it_interval = period, .it_value = period};
+  start = std::chrono::steady_clock::now();
+  if (::timerfd_settime(timer.get(), 0, &spec, nullptr) != 0)
+    throw std::system_error{errno, std::system_category(), "timerfd_settime"};
+
+  // Event loop keeps its own duplicates of the descriptors
+  wl_event_loop* loop = wl_display_get_event_loop(display.get());
+  if (!wl_event_loop_add_fd(loop, timer.get(), WL_EVENT_READABLE, &server::refresh, this) ||
+      !wl_event_loop_add_fd(loop, wake_fd.get(), WL_EVENT_READABLE, &server::run_tasks, this))
+    throw std::runtime_error{"Failed to add test compositor event sources"};
+
+  thread = std::jthread{[this](std::stop_token stop) { run(stop); }};
+}
+
+} // namespace
+
+struct test_compositor::impl : server {
+  using server::server;
+};
+
+test_compositor::test_compositor(test_compositor_options opts) : impl_{std::make_unique<impl>(opts)} {}
+
+test_compositor::~test_compositor() noexcept = default;
+
+const char* test_compositor::display() const noexcept { return impl_->socket_path.c_str(); }
+
+std::vector<committed_frame> test_compositor::commits() const {
+  std::lock_guard lock{impl_->mutex};
+  return impl_->commits;
+}
+
+size_t test_compositor::commits_count() const {
+  std::lock_guard lock{impl_->mutex};
+  return impl_->commits.size();
+}
+
+bool test_compositor::wait_commits(size_t count, std::chrono::milliseconds timeout) const {
+  std::unique_lock lock{impl_->mutex};
+  return impl_->commits_cv.wait_for(lock, timeout, [&] { return impl_->commits.size() >= count; });
+}
+
+uint64_t test_compositor::refreshes() const noexcept { return impl_->refreshes.load(); }
+
+void test_compositor::close_toplevels() {
+  impl_->post([srv = impl_.get()] {
+    wl_resource* toplevel;
+    wl_resource_for_each(toplevel, &srv->toplevels) xdg_toplevel_send_close(toplevel);
+  });
+}
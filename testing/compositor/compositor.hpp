@@ -0,0 +1,91 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <libs/geom/geom.hpp>
+
+/// Surface state recorded by the test compositor on each wl_surface.commit.
+struct committed_frame {
+  std::chrono::steady_clock::time_point time;
+  /// Zero if the commit has no new buffer attached.
+  ::size size;
+  int32_t stride = 0;
+  uint32_t format = 0;
+  /// Copy of the attached shm buffer made before it is released. Empty if
+  /// pixels recording is disabled.
+  std::vector<std::byte> pixels;
+  /// Damage reported since the previous commit either with wl_surface.damage
+  /// or wl_surface.damage_buffer. Buffer scale is always 1 so both are in the
+  /// same coordinates.
+  std::vector<rect> damage;
+  /// Size the buffer is stretched to by the wp_viewport of the surface. Zero
+  /// if no destination is set.
+  ::size destination;
+  /// The buffer was attached while the compositor still held it after an
+  /// earlier commit.
+  bool held_buffer_attached = false;
+};
+
+struct test_compositor_options {
+  /// Period of the virtual output refresh. Frame callbacks requested by
+  /// commits are fired on the closest refresh after them.
+  std::chrono::nanoseconds refresh_period = std::chrono::nanoseconds{std::chrono::seconds{1}} / 60;
+  /// Size sent with the initial xdg_toplevel.configure. Zero size lets the
+  /// client choose.
+  ::size window_size = {};
+  bool record_pixels = true;
+  /// Number of refreshes shm buffers are held for after the commit. Zero
+  /// releases them right on commit.
+  unsigned hold_refreshes = 0;
+  /// Announces wp_viewporter global.
+  bool viewporter = false;
+  /// Scale sent to wp_fractional_scale_v1 objects multiplied by 120. The
+  /// wp_fractional_scale_manager_v1 global is announced only if it is not
+  /// zero and the viewporter is enabled.
+  uint32_t preferred_scale = 0;
+};
+
+/// Minimal wayland compositor running in a background thread of the current
+/// process. It provides wl_compositor, wl_shm, xdg_wm_base and wp_presentation
+/// globals which are enough to run windows of the wlwnd library without a
+/// real display. wp_viewporter and wp_fractional_scale_manager_v1 are
+/// optional. Shm buffers are copied on commit and released right away like
+/// compositors uploading them to the GPU do or held for `hold_refreshes`
+/// like those scanning them out. Committed frames are presented on the next
+/// virtual refresh unless replaced by another commit before it.
+class test_compositor {
+public:
+  test_compositor() : test_compositor(test_compositor_options{}) {}
+  explicit test_compositor(test_compositor_options opts);
+
+  test_compositor(const test_compositor&) = delete;
+  test_compositor& operator=(const test_compositor&) = delete;
+  test_compositor(test_compositor&&) = delete;
+  test_compositor& operator=(test_compositor&&) = delete;
+
+  ~test_compositor() noexcept;
+
+  /// Absolute path of the listening socket to be passed to wl_display_connect.
+  [[nodiscard]] const char* display() const noexcept;
+
+  [[nodiscard]] std::vector<committed_frame> commits() const;
+  [[nodiscard]] size_t commits_count() const;
+  /// Waits until at least `count` commits are recorded. Returns false on
+  /// timeout.
+  bool wait_commits(size_t count, std::chrono::milliseconds timeout) const;
+  /// Number of virtual refreshes since start.
+  [[nodiscard]] uint64_t refreshes() const noexcept;
+
+  /// Asks all toplevel windows to close.
+  void close_toplevels();
+
+private:
+  struct impl;
+
+private:
+  std::unique_ptr<impl> impl_;
+};
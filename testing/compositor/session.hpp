@@ -0,0 +1,43 @@
+#pragma once
+
+#include <concepts>
+#include <utility>
+
+#include <asio/co_spawn.hpp>
+#include <asio/detached.hpp>
+#include <asio/io_context.hpp>
+
+#include <libs/geom/geom.hpp>
+#include <libs/wlwnd/event_loop.hpp>
+#include <libs/wlwnd/gui_shell.hpp>
+
+#include <testing/compositor/compositor.hpp>
+
+/// Test compositor along with a client connected to it and the shell globals
+/// bound. Members are destroyed in the reverse order, so the compositor
+/// outlives the connection and the io_context outlives the event loop
+/// registered with it.
+struct test_session {
+  test_session() : test_session(test_compositor_options{}) {}
+  explicit test_session(test_compositor_options opts)
+      : compositor{opts}, eloop{compositor.display()}, shell{eloop} {}
+
+  wl::sized_window<wl::shell_window> create_window(size sz) { return shell.create_window(eloop, sz); }
+
+  /// Dispatches events of the default queue while `pred` returns true.
+  template <std::predicate Pred>
+  void dispatch_while(Pred&& pred) {
+    asio::co_spawn(io, eloop.dispatch_while(io.get_executor(), std::forward<Pred>(pred)), asio::detached);
+    io.run();
+    io.restart();
+  }
+
+  /// Waits until the compositor handles all the requests sent so far and
+  /// dispatches events of the `queue` received meanwhile.
+  void roundtrip(event_queue& queue) { wl_display_roundtrip_queue(&eloop.get_display(), &queue.get()); }
+
+  test_compositor compositor;
+  asio::io_context io;
+  event_loop eloop;
+  wl::gui_shell shell;
+};
@@ -0,0 +1,54 @@
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <system_error>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include <thinsys/io/io.hpp>
+
+#include <libs/cli/struct_args.hpp>
+#include <libs/img/load.hpp>
+#include <libs/img/qoi.hpp>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct opts {
+  fs::path input = args::option<fs::path>("-i", "--input", "input PNG image");
+  fs::path output = args::option<fs::path>("-o", "--output", "output QOI image");
+};
+
+std::ofstream ofopen(const fs::path& path) {
+  std::ofstream out{path, std::ios::binary};
+  if (!out)
+    throw std::system_error{errno, std::system_category(), fmt::format("std::ofstream{{{}}}", path.string())};
+  return out;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  std::span<char*> args{argv, static_cast<size_t>(argc)};
+  if (get_flag(args, "-h")) {
+    args::usage<opts>(args.front(), std::cout);
+    args::args_help<opts>(std::cout);
+    return 0;
+  }
+  const auto opts = args::parse<::opts>(args);
+
+  auto in = thinsys::io::open(opts.input, thinsys::io::mode::read_only);
+  auto reader = img::load_reader(in);
+  std::vector<std::byte> pixels(reader.pixels_size());
+  reader.read_pixels(pixels);
+
+  const auto encoded = img::qoi::encode(pixels, reader.size(), reader.format());
+  auto out = ofopen(opts.output);
+  out.write(reinterpret_cast<const char*>(encoded.data()), encoded.size());
+  if (!out.flush())
+    throw std::system_error{errno, std::system_category(), fmt::format("write {}", opts.output.string())};
+
+  return 0;
+}